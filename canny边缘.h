@@ -0,0 +1,274 @@
+/**
+ * Canny Ե Sobel ݶȣint16  gxgy ƽ棩Ǽֵƺ˫ֵͺ
+ *
+ * 1. Ǽֵƣ CANNY_TILE x CANNY_TILE ֿ鲢УÿһȦߣhaloķֵƽ
+ *    ݶȷΪ 0/45/90/135 ȣtan 22.5tan 67.5  15 λȽϣǶȣ
+ *    ݶȷھӣذֵΪǿ>=high>=lowࡣڲѭ޷֧
+ * 2. ͺӣǿ 8 ڽӵرǿֱٱ仯ֿͬ飺
+ *    - ÿԿڵǿΪɢݹ飩ֻдأ鲢л
+ *    - ֻ֣ؼ߽һȦϵأڿﰤǿصļΪһ
+ *    ֱû㣻ĳԵ༸ּɣÿֻһΡ
+ * ͼһȦΪ 0 sobelEdgeDetect ͬ
+ * ÷
+ *   cannyEdges(gx, gy, width, height, low, high, edge);   // edge  0/255
+ */
+#ifndef CANNY_EDGE_H
+#define CANNY_EDGE_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CANNY_TILE 128
+#define CANNY_TAN22 13573  // tan(22.5) * 32768
+#define CANNY_TAN67 79109  // tan(67.5) * 32768
+#define CANNY_MAX_THRESHOLD 1443  // 8 λҶ Sobel ݶȷֵ sqrt(2)*4*255  1442.5ֵƽ int
+
+enum {
+    CANNY_NONE = 0,
+    CANNY_WEAK = 1,
+    CANNY_STRONG = 2
+};
+
+static inline int cannyTiles(int size) {
+    return (size + CANNY_TILE - 1) / CANNY_TILE;
+}
+
+/**
+ * һķǼֵ
+ * @param mag(CANNY_TILE+2)^2  int Ĺ
+ * @param low2high2ֵƽ
+ */
+static inline void cannyNmsTile(const short* gx, const short* gy, int width, int height, int tx, int ty, int low2, int high2, int* mag, unsigned char* edge) {
+    int x0 = tx * CANNY_TILE;
+    int y0 = ty * CANNY_TILE;
+    int x1 = x0 + CANNY_TILE < width ? x0 + CANNY_TILE : width;
+    int y1 = y0 + CANNY_TILE < height ? y0 + CANNY_TILE : height;
+    int mw = x1 - x0 + 2;
+
+    // 1. ֵƽһȦߣͼΪ 0
+    for (int y = y0 - 1; y <= y1; y++) {
+        int* m = mag + (size_t)(y - y0 + 1) * mw;
+        if (y < 0 || y >= height) {
+            memset(m, 0, sizeof(int) * mw);
+            continue;
+        }
+        const short* rx = gx + (size_t)y * width;
+        const short* ry = gy + (size_t)y * width;
+        m[0] = x0 > 0 ? rx[x0 - 1] * rx[x0 - 1] + ry[x0 - 1] * ry[x0 - 1] : 0;
+        m[mw - 1] = x1 < width ? rx[x1] * rx[x1] + ry[x1] * ry[x1] : 0;
+        #pragma omp simd
+        for (int x = x0; x < x1; x++) {
+            m[x - x0 + 1] = rx[x] * rx[x] + ry[x] * ry[x];
+        }
+    }
+
+    // 2. ݶȷȽھ
+    for (int y = y0; y < y1; y++) {
+        unsigned char* out = edge + (size_t)y * width;
+        if (y == 0 || y == height - 1) {
+            memset(out + x0, CANNY_NONE, x1 - x0);
+            continue;
+        }
+        const short* rx = gx + (size_t)y * width;
+        const short* ry = gy + (size_t)y * width;
+        const int* up = mag + (size_t)(y - y0) * mw + 1 - x0;
+        const int* mid = up + mw;
+        const int* down = mid + mw;
+        #pragma omp simd
+        for (int x = x0; x < x1; x++) {
+            int ax = rx[x] < 0 ? -rx[x] : rx[x];
+            int ay = ry[x] < 0 ? -ry[x] : ry[x];
+            int horizontal = ay * 32768 < ax * CANNY_TAN22;
+            int vertical = ay * 32768 > ax * CANNY_TAN67;
+            int same_sign = (rx[x] ^ ry[x]) >= 0;  // ݶ (1,1) 򣬷 (1,-1)
+            int before = horizontal ? mid[x - 1] : vertical ? up[x] : same_sign ? up[x - 1] : down[x - 1];
+            int after = horizontal ? mid[x + 1] : vertical ? down[x] : same_sign ? down[x + 1] : up[x + 1];
+            int m = mid[x];
+            int keep = m > before && m >= after;
+            out[x] = (unsigned char)(!keep ? CANNY_NONE : m >= high2 ? CANNY_STRONG : m >= low2 ? CANNY_WEAK : CANNY_NONE);
+        }
+        if (x0 == 0) {
+            out[0] = CANNY_NONE;
+        }
+        if (x1 == width) {
+            out[width - 1] = CANNY_NONE;
+        }
+    }
+}
+
+/**
+ * һڵɢȰĸĳǿӣٴǿس 8 ڽӵظĳǿ
+ * @param seedsĿƫ (y-y0)*CANNY_TILE + (x-x0)Ϊ NULL ʱԿǿΪ㣩
+ * @param queueCANNY_TILE^2  int ĹƫƣÿֻһΣȫͼ±꣬ 2^31 Ҳ
+ */
+static inline void cannyGrowTile(unsigned char* edge, int width, int height, int tx, int ty, const int* seeds, int seed_count, int* queue) {
+    int x0 = tx * CANNY_TILE;
+    int y0 = ty * CANNY_TILE;
+    int x1 = x0 + CANNY_TILE < width ? x0 + CANNY_TILE : width;
+    int y1 = y0 + CANNY_TILE < height ? y0 + CANNY_TILE : height;
+    int tail = 0;
+    if (seeds == NULL) {
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                if (edge[(size_t)y * width + x] == CANNY_STRONG) {
+                    queue[tail++] = (y - y0) * CANNY_TILE + (x - x0);
+                }
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < seed_count; i++) {
+            unsigned char* p = edge + (size_t)(y0 + seeds[i] / CANNY_TILE) * width + x0 + seeds[i] % CANNY_TILE;
+            if (*p == CANNY_WEAK) {
+                *p = CANNY_STRONG;
+                queue[tail++] = seeds[i];
+            }
+        }
+    }
+    for (int head = 0; head < tail; head++) {
+        int x = x0 + queue[head] % CANNY_TILE;
+        int y = y0 + queue[head] / CANNY_TILE;
+        for (int dy = -1; dy <= 1; dy++) {
+            int yy = y + dy;
+            if (yy < y0 || yy >= y1) {
+                continue;
+            }
+            for (int dx = -1; dx <= 1; dx++) {
+                int xx = x + dx;
+                if (xx < x0 || xx >= x1 || edge[(size_t)yy * width + xx] != CANNY_WEAK) {
+                    continue;
+                }
+                edge[(size_t)yy * width + xx] = CANNY_STRONG;
+                queue[tail++] = (yy - y0) * CANNY_TILE + (xx - x0);
+            }
+        }
+    }
+}
+
+/**
+ * (x, y) ǿ 8 ڽ
+ */
+static inline int cannyLinked(const unsigned char* edge, int width, int height, int x, int y, int x0, int y0, int x1, int y1) {
+    if (edge[(size_t)y * width + x] != CANNY_WEAK) {
+        return 0;
+    }
+    for (int yy = y - 1; yy <= y + 1; yy++) {
+        for (int xx = x - 1; xx <= x + 1; xx++) {
+            int outside = xx < x0 || xx >= x1 || yy < y0 || yy >= y1;
+            if (outside && xx >= 0 && xx < width && yy >= 0 && yy < height &&
+                edge[(size_t)yy * width + xx] == CANNY_STRONG) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * ҳһ߽һȦڿǿ 8 ڽӵأֻ
+ * @param seeds 4*CANNY_TILE  intƫ (y-y0)*CANNY_TILE + (x-x0)
+ * @return 
+ */
+static inline int cannySeedTile(const unsigned char* edge, int width, int height, int tx, int ty, int* seeds) {
+    int x0 = tx * CANNY_TILE;
+    int y0 = ty * CANNY_TILE;
+    int x1 = x0 + CANNY_TILE < width ? x0 + CANNY_TILE : width;
+    int y1 = y0 + CANNY_TILE < height ? y0 + CANNY_TILE : height;
+    int count = 0;
+    for (int y = y0; y < y1; y++) {
+        if (y == y0 || y == y1 - 1) {
+            for (int x = x0; x < x1; x++) {
+                if (cannyLinked(edge, width, height, x, y, x0, y0, x1, y1)) {
+                    seeds[count++] = (y - y0) * CANNY_TILE + (x - x0);
+                }
+            }
+            continue;
+        }
+        if (cannyLinked(edge, width, height, x0, y, x0, y0, x1, y1)) {
+            seeds[count++] = (y - y0) * CANNY_TILE;
+        }
+        if (x1 - 1 > x0 && cannyLinked(edge, width, height, x1 - 1, y, x0, y0, x1, y1)) {
+            seeds[count++] = (y - y0) * CANNY_TILE + (x1 - 1 - x0);
+        }
+    }
+    return count;
+}
+
+/**
+ * Canny Ե
+ * @param gxgySobel ݶȣwidth*height
+ * @param lowhighݶȷֵĵֵ͡ sobelEdgeDetect ֵͬλ0 <= low <= high <= CANNY_MAX_THRESHOLD
+ * @param edge width*heightԵΪ 255Ϊ 0
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int cannyEdges(const short* gx, const short* gy, int width, int height, int low, int high, unsigned char* edge) {
+    if (width < 3 || height < 3 || low < 0 || high < low || high > CANNY_MAX_THRESHOLD) {
+        return -1;
+    }
+    int tiles_x = cannyTiles(width);
+    int tile_count = tiles_x * cannyTiles(height);
+    int low2 = low * low;
+    int high2 = high * high;
+    int failed = 0;
+
+    // 1. Ǽֵ
+    #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+    for (int t = 0; t < tile_count; t++) {
+        int* mag = (int*)malloc(sizeof(int) * (CANNY_TILE + 2) * (CANNY_TILE + 2));
+        if (mag == NULL) {
+            failed = 1;
+            continue;
+        }
+        cannyNmsTile(gx, gy, width, height, t % tiles_x, t / tiles_x, low2, high2, mag, edge);
+        free(mag);
+    }
+
+    // 2. ͺӣڴ鲹ֽ
+    int* seeds = (int*)malloc(sizeof(int) * 4 * CANNY_TILE * tile_count);
+    int* seed_count = (int*)calloc(tile_count, sizeof(int));
+    if (seeds == NULL || seed_count == NULL) {
+        failed = 1;
+    }
+    int first = 1;
+    int pending = 1;
+    while (pending && !failed) {
+        #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+        for (int t = 0; t < tile_count; t++) {
+            if (!first && seed_count[t] == 0) {
+                continue;
+            }
+            int* queue = (int*)malloc(sizeof(int) * CANNY_TILE * CANNY_TILE);
+            if (queue == NULL) {
+                failed = 1;
+                continue;
+            }
+            cannyGrowTile(edge, width, height, t % tiles_x, t / tiles_x,
+                          first ? NULL : seeds + (size_t)t * 4 * CANNY_TILE, seed_count[t], queue);
+            free(queue);
+        }
+        first = 0;
+        pending = 0;
+        #pragma omp parallel for schedule(dynamic, 1) reduction(|:pending)
+        for (int t = 0; t < tile_count; t++) {
+            seed_count[t] = cannySeedTile(edge, width, height, t % tiles_x, t / tiles_x, seeds + (size_t)t * 4 * CANNY_TILE);
+            pending |= seed_count[t] > 0;
+        }
+    }
+    free(seeds);
+    free(seed_count);
+    if (failed) {
+        return -1;
+    }
+
+    // 3. ǿΪԵ
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        unsigned char* row = edge + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            row[x] = row[x] == CANNY_STRONG ? 255 : 0;
+        }
+    }
+    return 0;
+}
+
+#endif
\ No newline at end of file
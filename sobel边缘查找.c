@@ -1,8 +1,21 @@
 #define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include "ͳ.h"
+#include ".h"
+#include "д.h"
+#include "ɫת.h"
+#include ".h"
+#include "ͼ.h"
+#include "̬ѧ.h"
+#include "ͨ.h"
+#include "cannyԵ.h"
+#include "ֱͼ.h"
 
 // ؽṹ壨RGBͨ
 typedef struct {
@@ -27,7 +40,9 @@ typedef enum {
     ERR_ILLEGAL_SIZE,
     ERR_MEMORY_ALLOC,
     ERR_FILE_BROKEN,
-    ERR_WRITE_FAILED
+    ERR_WRITE_FAILED,
+    ERR_BAD_MORPH,
+    ERR_BAD_CANNY
 } ErrorCode;
 
 // ȫִϢӳ
@@ -38,7 +53,9 @@ const char* error_messages[] = {
     "ͼߴֵϷ",
     "ڴʧ",
     "ļ",
-    "дļʧ"
+    "дļʧ",
+    "̬ѧϷ--morph erode|dilate|open|close 뾶",
+    "Canny ֵϷ--canny ֵ ֵ0 <=  <=  <= 1443"
 };
 
 /**
@@ -46,6 +63,7 @@ const char* error_messages[] = {
  */
 void freePPM(PPM* ppm) {
     if (ppm != NULL && ppm->data != NULL) {
+        STATS_FREE(sizeof(Pixel) * ppm->width * ppm->height);
         free(ppm->data);
         ppm->data = NULL;
     }
@@ -102,6 +120,7 @@ ErrorCode readPPM(const char* filename, PPM* ppm) {
         fclose(file);
         return ERR_MEMORY_ALLOC;
     }
+    STATS_ALLOC(sizeof(Pixel) * ppm->width * ppm->height);
 
     // ȡ
     for (int i = 0; i < ppm->width * ppm->height; i++) {
@@ -112,6 +131,7 @@ ErrorCode readPPM(const char* filename, PPM* ppm) {
         }
     }
 
+    STATS_BYTES_READ(ftell(file));
     fclose(file);
     return SUCCESS;
 }
@@ -126,13 +146,65 @@ void rgbToGray(const PPM* in, unsigned char* gray) {
         return;
     }
 
-    for (int i = 0; i < in->width * in->height; i++) {
-        // ȨҶȹʽȸ֪
-        double r = in->data[i].r;
-        double g = in->data[i].g;
-        double b = in->data[i].b;
-        gray[i] = (unsigned char)(0.299 * r + 0.587 * g + 0.114 * b);
+    // ȨҶȹʽBT.601ȸ֪㣬 ɫת.h
+    colorToGray((const int*)in->data, gray, (size_t)in->width * in->height, LUMA_BT601);
+}
+
+// SobelˣGxˮƽԵGyֱԵ
+static const int SOBEL_GX[9] = { -1, 0, 1, -2, 0, 2, -1, 0, 1 };
+static const int SOBEL_GY[9] = { -1, -2, -1, 0, 0, 0, 1, 2, 1 };
+
+/**
+ * Ҷƽϵ Sobel  .hҶֻһΣ˹ãɶ߳ͬʱ
+ * @param gxҶȣ Gx
+ * @param gy Gy
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelConvolve(int* gx, int* gy, int width, int height) {
+    PaddedPlane plane;
+    if (padPlane(&plane, gx, width, height, 1) != 0) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ConvKernel kx, ky;
+    convKernelInit(&kx, 3, SOBEL_GX, 1);
+    convKernelInit(&ky, 3, SOBEL_GY, 1);
+    int failed = convPadded(&plane, gx, &kx) != 0 || convPadded(&plane, gy, &ky) != 0;
+    freePadded(&plane);
+    return failed ? ERR_MEMORY_ALLOC : SUCCESS;
+}
+
+/**
+ * Ҷݶ GxGy
+ * ߽һȦͼΪ 0 㣬÷ʹ
+ * @param gxgyݶ飨width*heightǰڴ棩
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelGradients(const PPM* in, int* gx, int* gy) {
+    int width = in->width;
+    int height = in->height;
+    unsigned char* gray = (unsigned char*)malloc((size_t)width * height);
+    if (gray == NULL) {
+        return ERR_MEMORY_ALLOC;
     }
+    STATS_ALLOC((size_t)width * height);
+
+    STATS_BEGIN(gray_span, "rgbToGray");
+    rgbToGray(in, gray);
+    STATS_END(gray_span, width * height);
+
+    // ҶȷŽ gx ת intٿ߻壻gx 󱻾
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        gx[i] = gray[i];
+    }
+    STATS_FREE((size_t)width * height);
+    free(gray);
+
+    STATS_ALLOC(sizeof(int) * (width + 2) * (height + 2));  // ߻
+    STATS_BEGIN(conv_span, "sobelConv");
+    ErrorCode ret = sobelConvolve(gx, gy, width, height);
+    STATS_END(conv_span, width * height);
+    STATS_FREE(sizeof(int) * (width + 2) * (height + 2));
+    return ret;
 }
 
 /**
@@ -159,71 +231,165 @@ ErrorCode sobelEdgeDetect(const PPM* in, PPM* out, unsigned char threshold) {
     if (out->data == NULL) {
         return ERR_MEMORY_ALLOC;
     }
+    STATS_ALLOC(sizeof(Pixel) * out->width * out->height);
 
-    // Ҷڴ
-    unsigned char* gray = (unsigned char*)malloc(sizeof(unsigned char) * in->width * in->height);
-    if (gray == NULL) {
+    // ݶ
+    int* gx = (int*)malloc(sizeof(int) * in->width * in->height);
+    int* gy = (int*)malloc(sizeof(int) * in->width * in->height);
+    if (gx == NULL || gy == NULL) {
+        free(gx);
+        free(gy);
         freePPM(out);
         return ERR_MEMORY_ALLOC;
     }
+    STATS_ALLOC(2 * sizeof(int) * in->width * in->height);
 
-    // RGBתҶ
-    rgbToGray(in, gray);
-
-    // SobelˣGxˮƽԵGyֱԵ
-    int Gx[3][3] = { {-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1} };
-    int Gy[3][3] = { {-1, -2, -1}, {0, 0, 0}, {1, 2, 1} };
+    // RGBתҶ + Sobel
+    ErrorCode ret = sobelGradients(in, gx, gy);
+    if (ret != SUCCESS) {
+        STATS_FREE(2 * sizeof(int) * in->width * in->height);
+        free(gx);
+        free(gy);
+        freePPM(out);
+        return ret;
+    }
 
-    // ľ㣨߽أ
+    // ݶȷֵ + ֵ߽أ
+    STATS_BEGIN(sobel_span, "sobel");
     for (int y = 1; y < in->height - 1; y++) {  // 0кһУ
         for (int x = 1; x < in->width - 1; x++) {  // 0кһУ
-            int gx = 0, gy = 0;
-
-            // 33
-            for (int ky = -1; ky <= 1; ky++) {  // ƫ
-                for (int kx = -1; kx <= 1; kx++) {  // ƫ
-                    // ڻҶе
-                    int gray_idx = (x + kx) + (y + ky) * in->width;
-                    // ۼӾ
-                    gx += gray[gray_idx] * Gx[ky + 1][kx + 1];  // ky+1-10
-                    gy += gray[gray_idx] * Gy[ky + 1][kx + 1];
-                }
-            }
+            int idx = x + y * in->width;
 
-            // ݶȷֵȷ棺sqrt(Gx? + Gy?)
-            double magnitude = sqrt((double)(gx * gx + gy * gy));
-            // 򻯰棨Чʸߣ滻һУint magnitude = abs(gx) + abs(gy);
+            // ݶȷֵȷ棺sqrt(Gx^2 + Gy^2)
+            double magnitude = sqrt((double)(gx[idx] * gx[idx] + gy[idx] * gy[idx]));
+            // 򻯰棨Чʸߣ滻һУint magnitude = abs(gx[idx]) + abs(gy[idx]);
 
             // ֵֵֵΪԵɫΪɫ
             unsigned char edge = (magnitude >= threshold) ? 255 : 0;
 
             // ԵͼPPMRGBͨͬΪҶͼ
-            int out_idx = x + y * out->width;
-            out->data[out_idx].r = edge;
-            out->data[out_idx].g = edge;
-            out->data[out_idx].b = edge;
+            out->data[idx].r = edge;
+            out->data[idx].g = edge;
+            out->data[idx].b = edge;
         }
     }
 
-    // ߽Ϊɫ޾
-    for (int y = 0; y < out->height; y++) {
-        for (int x = 0; x < out->width; x++) {
-            if (x == 0 || x == out->width - 1 || y == 0 || y == out->height - 1) {
-                int out_idx = x + y * out->width;
-                out->data[out_idx].r = 0;
-                out->data[out_idx].g = 0;
-                out->data[out_idx].b = 0;
-            }
+    // ߽Ϊɫ޾ֻдβкÿβأɨͼ
+    Pixel black = { 0, 0, 0 };
+    for (int x = 0; x < out->width; x++) {
+        out->data[x] = black;
+        out->data[x + (out->height - 1) * out->width] = black;
+    }
+    for (int y = 1; y < out->height - 1; y++) {
+        out->data[y * out->width] = black;
+        out->data[out->width - 1 + y * out->width] = black;
+    }
+
+    STATS_END(sobel_span, out->width * out->height);
+
+    // ͷݶ
+    STATS_FREE(2 * sizeof(int) * in->width * in->height);
+    free(gx);
+    free(gy);
+    return SUCCESS;
+}
+
+//========== ߶ȱԵͼ ==========
+
+/**
+ * һϵ Sobelֵж sobelEdgeDetect ߽ͬһȦΪ 0ɶ߳ͬʱ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelLevel(const Pyramid* gauss, Pyramid* edges, int level, unsigned char threshold) {
+    int width = gauss->width[level];
+    int height = gauss->height[level];
+    int* gx = (int*)malloc(sizeof(int) * width * height);
+    int* gy = (int*)malloc(sizeof(int) * width * height);
+    ErrorCode ret = (gx == NULL || gy == NULL) ? ERR_MEMORY_ALLOC : SUCCESS;
+    if (ret == SUCCESS) {
+        memcpy(gx, pyramidLevel(gauss, level), sizeof(int) * width * height);
+        ret = sobelConvolve(gx, gy, width, height);
+    }
+    if (ret != SUCCESS) {
+        free(gx);
+        free(gy);
+        return ret;
+    }
+    int* edge = pyramidLevel(edges, level);
+    memset(edge, 0, sizeof(int) * width);
+    memset(edge + (size_t)(height - 1) * width, 0, sizeof(int) * width);
+    for (int y = 1; y < height - 1; y++) {
+        edge[y * width] = 0;
+        edge[y * width + width - 1] = 0;
+        for (int x = 1; x < width - 1; x++) {
+            int idx = x + y * width;
+            double magnitude = sqrt((double)(gx[idx] * gx[idx] + gy[idx] * gy[idx]));
+            edge[idx] = (magnitude >= threshold) ? 255 : 0;
         }
     }
+    free(gx);
+    free(gy);
+    return SUCCESS;
+}
 
-    // ͷʱҶ
+/**
+ * ߶ SobelһɻҶȸ˹ٶԸ㲢 Sobel
+ * @param inɫPPMͼ
+ * @param gaussҶȸ˹BT.601 rgbToGray ͬ
+ * @param edgesԵͼ0/255 gauss ͬߴ磬һη䣩 0  sobelEdgeDetect Ľͬ
+ * @param levelsͼ񲻹ʱԶ٣ʵʲ edges->levels
+ * @param thresholdԵֵ0~255ͬ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelPyramidEdges(const PPM* in, Pyramid* gauss, Pyramid* edges, int levels, unsigned char threshold) {
+    if (in == NULL || gauss == NULL || edges == NULL || in->data == NULL) {
+        return ERR_FILE_BROKEN;
+    }
+    if (in->width < 3 || in->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int width = in->width;
+    unsigned char* gray = (unsigned char*)malloc(width);
+    int failed = gray == NULL;
+    failed |= pyramidInit(gauss, width, in->height, levels) != 0;
+    failed |= pyramidInit(edges, width, in->height, levels) != 0;
+    if (failed) {
+        free(gray);
+        pyramidFree(gauss);
+        pyramidFree(edges);
+        return ERR_MEMORY_ALLOC;
+    }
+
+    // 1. תҶд 0 㣬ߵĲ֮
+    STATS_BEGIN(pyramid_span, "pyramid");
+    for (int y = 0; y < in->height; y++) {
+        int* row = pyramidLevel(gauss, 0) + (size_t)y * width;
+        colorToGray((const int*)(in->data + (size_t)y * width), gray, width, LUMA_BT601);
+        for (int x = 0; x < width; x++) {
+            row[x] = gray[x];
+        }
+        pyramidRowsReady(gauss, y + 1);
+    }
+    STATS_END(pyramid_span, width * in->height);
     free(gray);
+
+    // 2. 㲢 Sobelڲ 4 ̬ôȿʼ
+    STATS_BEGIN(sobel_span, "sobelLevels");
+    #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+    for (int l = 0; l < gauss->levels; l++) {
+        failed |= sobelLevel(gauss, edges, l, threshold) != SUCCESS;
+    }
+    STATS_END(sobel_span, width * in->height);
+    if (failed) {
+        pyramidFree(gauss);
+        pyramidFree(edges);
+        return ERR_MEMORY_ALLOC;
+    }
     return SUCCESS;
 }
 
 /**
- * PPM P3ʽͼ
+ * PPM P3ʽͼ񣨸диʽԤļƫд룬 д.h
  * @param filenameļ·
  * @param ppmPPMͼ
  * @return 루SUCCESS=ɹ
@@ -233,43 +399,743 @@ ErrorCode writePPM(const char* filename, const PPM* ppm) {
         return ERR_WRITE_FAILED;
     }
 
-    // ļıģʽд룩
-    FILE* file = fopen(filename, "w");
-    if (file == NULL) {
+    long long written = parallelWritePPM(filename, (const int*)ppm->data, ppm->width, ppm->height, ppm->max_val, 0);
+    if (written < 0) {
         return ERR_WRITE_FAILED;
     }
+    STATS_BYTES_WRITTEN(written);
+    return SUCCESS;
+}
+
+//========== ֵԵͼλPBM P4 ==========
+
+// λĶֵͼÿ stride ֽڣλβ 8 λ 0
+// 1=Ե0= PBM Լһ£ͼʾΪ׵׺ڱߣ
+typedef struct {
+    int width;
+    int height;
+    int stride;           // ÿֽ (width+7)/8
+    unsigned char* bits;  // height*stride ֽ
+} BitMask;
+
+/**
+ * ͷŶֵͼĶ̬ڴ
+ */
+void freeMask(BitMask* mask) {
+    if (mask != NULL && mask->bits != NULL) {
+        STATS_FREE((size_t)mask->stride * mask->height);
+        free(mask->bits);
+        mask->bits = NULL;
+    }
+}
+
+/**
+ * ȫ 0 Ķֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode allocMask(BitMask* mask, int width, int height) {
+    mask->width = width;
+    mask->height = height;
+    mask->stride = (width + 7) / 8;
+    mask->bits = (unsigned char*)calloc((size_t)mask->stride * height, 1);
+    if (mask->bits == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC((size_t)mask->stride * height);
+    return SUCCESS;
+}
+
+/**
+ * ȡ (x, y) λ
+ */
+int maskGet(const BitMask* mask, int x, int y) {
+    return (mask->bits[(size_t)y * mask->stride + (x >> 3)] >> (7 - (x & 7))) & 1;
+}
+
+/**
+ * SobelԵ⣬ֱдɰλĶֵͼж sobelEdgeDetect ȫͬ
+ * @param inɫPPMͼ
+ * @param maskֵͼǰ
+ * @param thresholdԵֵ0~255
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelEdgeMask(const PPM* in, BitMask* mask, unsigned char threshold) {
+    if (in == NULL || mask == NULL || in->data == NULL) {
+        return ERR_FILE_BROKEN;
+    }
+    if (in->width < 3 || in->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int width = in->width;
+    int height = in->height;
+    ErrorCode ret = allocMask(mask, width, height);  // ߽бΪ 0
+    if (ret != SUCCESS) {
+        return ret;
+    }
+
+    int* gx = (int*)malloc(sizeof(int) * width * height);
+    int* gy = (int*)malloc(sizeof(int) * width * height);
+    if (gx == NULL || gy == NULL) {
+        free(gx);
+        free(gy);
+        freeMask(mask);
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC(2 * sizeof(int) * width * height);
+    ret = sobelGradients(in, gx, gy);
+    if (ret != SUCCESS) {
+        STATS_FREE(2 * sizeof(int) * width * height);
+        free(gx);
+        free(gy);
+        freeMask(mask);
+        return ret;
+    }
 
-    // дļͷ
-    if (fprintf(file, "P3\n") < 0 ||
-        fprintf(file, "%d %d\n", ppm->width, ppm->height) < 0 ||
-        fprintf(file, "%d\n", ppm->max_val) < 0) {
+    // sqrt(m) >= t ȼ m >= t*tʡ
+    int t2 = threshold * threshold;
+    STATS_BEGIN(sobel_span, "sobelMask");
+    #pragma omp parallel for schedule(static)
+    for (int y = 1; y < height - 1; y++) {
+        const int* rx = gx + (size_t)y * width;
+        const int* ry = gy + (size_t)y * width;
+        unsigned char* row = mask->bits + (size_t)y * mask->stride;
+        for (int x = 1; x < width - 1; x++) {
+            if (rx[x] * rx[x] + ry[x] * ry[x] >= t2) {
+                row[x >> 3] |= (unsigned char)(0x80 >> (x & 7));
+            }
+        }
+    }
+    STATS_END(sobel_span, width * height);
+
+    STATS_FREE(2 * sizeof(int) * width * height);
+    free(gx);
+    free(gy);
+    return SUCCESS;
+}
+
+/**
+ * ֵͼΪ PBM P4ÿ 1 λ
+ * @param filenameļ·
+ * @param maskֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writePBM(const char* filename, const BitMask* mask) {
+    if (filename == NULL || mask == NULL || mask->bits == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    size_t size = (size_t)mask->stride * mask->height;
+    if (fprintf(file, "P4\n%d %d\n", mask->width, mask->height) < 0 ||
+        fwrite(mask->bits, 1, size, file) != size) {
         fclose(file);
         return ERR_WRITE_FAILED;
     }
+    STATS_BYTES_WRITTEN(ftell(file));
+    if (fclose(file) != 0) {
+        return ERR_WRITE_FAILED;
+    }
+    return SUCCESS;
+}
 
-    // дݣÿ3أʽգ
-    for (int i = 0; i < ppm->width * ppm->height; i++) {
-        if (fprintf(file, "%d %d %d ", ppm->data[i].r, ppm->data[i].g, ppm->data[i].b) < 0) {
+/**
+ * ȡ PBM P4 ΪλĶֵͼԭ룬չ
+ * @param filenameļ·
+ * @param maskֵͼǰ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readPBM(const char* filename, BitMask* mask) {
+    mask->width = 0;
+    mask->height = 0;
+    mask->stride = 0;
+    mask->bits = NULL;
+
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    if (fgetc(file) != 'P' || fgetc(file) != '4') {
+        fclose(file);
+        return ERR_WRONG_FORMAT;
+    }
+
+    // ȡߣɼ # עͣ
+    int values[2];
+    for (int i = 0; i < 2; i++) {
+        int ch = fgetc(file);
+        while (ch == '#' || ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+            if (ch == '#') {
+                while (ch != '\n' && ch != EOF) {
+                    ch = fgetc(file);
+                }
+            }
+            ch = fgetc(file);
+        }
+        if (ch < '0' || ch > '9') {
             fclose(file);
-            return ERR_WRITE_FAILED;
+            return ERR_FILE_BROKEN;
         }
-        if ((i + 1) % 3 == 0) {  // ÿ3ػ
-            fprintf(file, "\n");
+        long long v = 0;
+        while (ch >= '0' && ch <= '9') {
+            v = v * 10 + (ch - '0');
+            if (v > 1000000000) {
+                fclose(file);
+                return ERR_ILLEGAL_SIZE;
+            }
+            ch = fgetc(file);
         }
+        values[i] = (int)v;
+        if (i == 1 && ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n') {
+            fclose(file);
+            return ERR_FILE_BROKEN;  // ߶Ⱥǡһհַ֮Ϊλͼ
+        }
+    }
+    if (values[0] <= 0 || values[1] <= 0) {
+        fclose(file);
+        return ERR_ILLEGAL_SIZE;
     }
 
+    ErrorCode ret = allocMask(mask, values[0], values[1]);
+    if (ret != SUCCESS) {
+        fclose(file);
+        return ret;
+    }
+    size_t size = (size_t)mask->stride * mask->height;
+    if (fread(mask->bits, 1, size, file) != size) {
+        freeMask(mask);
+        fclose(file);
+        return ERR_FILE_BROKEN;
+    }
+    // βλݲ涨 0 Աֽڴ
+    if (mask->width % 8 != 0) {
+        unsigned char keep = (unsigned char)(0xFF << (8 - mask->width % 8));
+        for (int y = 0; y < mask->height; y++) {
+            mask->bits[(size_t)y * mask->stride + mask->stride - 1] &= keep;
+        }
+    }
+    STATS_BYTES_READ(ftell(file));
     fclose(file);
     return SUCCESS;
 }
 
+//========== Canny Ե ==========
+
+/**
+ * Canny Ե⣺ݶ sobelEdgeDetect Ϊͬһ飨sobelGradientsխ int16 ƽ
+ * ֿǼֵƺͺӣ cannyԵ.h
+ * @param inɫPPMͼ
+ * @param edge width*height  0/255 Եǰڴ棩
+ * @param lowhighݶȷֵĵֵ͡0 <= low <= high <= CANNY_MAX_THRESHOLD
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelCanny(const PPM* in, unsigned char* edge, int low, int high) {
+    if (in == NULL || edge == NULL || in->data == NULL) {
+        return ERR_FILE_BROKEN;
+    }
+    if (low < 0 || high < low || high > CANNY_MAX_THRESHOLD) {
+        return ERR_BAD_CANNY;
+    }
+    if (in->width < 3 || in->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    size_t count = (size_t)in->width * in->height;
+    int* gx = (int*)malloc(sizeof(int) * count);
+    int* gy = (int*)malloc(sizeof(int) * count);
+    if (gx == NULL || gy == NULL) {
+        free(gx);
+        free(gy);
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC(2 * sizeof(int) * count);
+    ErrorCode ret = sobelGradients(in, gx, gy);
+
+    // 8 λҶϵ Sobel ݶȲ 4*255int16 㹻ݼ
+    short* gx16 = NULL;
+    short* gy16 = NULL;
+    if (ret == SUCCESS) {
+        gx16 = (short*)malloc(sizeof(short) * count);
+        gy16 = (short*)malloc(sizeof(short) * count);
+        ret = (gx16 == NULL || gy16 == NULL) ? ERR_MEMORY_ALLOC : SUCCESS;
+    }
+    if (ret == SUCCESS) {
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < (long long)count; i++) {
+            gx16[i] = (short)gx[i];
+            gy16[i] = (short)gy[i];
+        }
+    }
+    STATS_FREE(2 * sizeof(int) * count);
+    free(gx);
+    free(gy);
+    if (ret == SUCCESS) {
+        STATS_BEGIN(canny_span, "canny");
+        ret = cannyEdges(gx16, gy16, in->width, in->height, low, high, edge) == 0 ? SUCCESS : ERR_MEMORY_ALLOC;
+        STATS_END(canny_span, in->width * in->height);
+    }
+    free(gx16);
+    free(gy16);
+    return ret;
+}
+
+/**
+ * 0/255 Եƽת sobelEdgeDetect ͬʽ PPMRGB ͨͬ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode edgeToPPM(const unsigned char* edge, int width, int height, PPM* out) {
+    size_t count = (size_t)width * height;
+    out->width = width;
+    out->height = height;
+    out->max_val = 255;
+    out->data = (Pixel*)malloc(sizeof(Pixel) * count);
+    if (out->data == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC(sizeof(Pixel) * count);
+    for (size_t i = 0; i < count; i++) {
+        out->data[i].r = edge[i];
+        out->data[i].g = edge[i];
+        out->data[i].b = edge[i];
+    }
+    return SUCCESS;
+}
+
+/**
+ * 0/255 ԵƽתɰλĶֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode edgeToMask(const unsigned char* edge, int width, int height, BitMask* mask) {
+    ErrorCode ret = allocMask(mask, width, height);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        const unsigned char* src = edge + (size_t)y * width;
+        unsigned char* row = mask->bits + (size_t)y * mask->stride;
+        for (int x = 0; x < width; x++) {
+            if (src[x]) {
+                row[x >> 3] |= (unsigned char)(0x80 >> (x & 7));
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Canny Եͼʽ sobelEdgeDetect ͬRGB ͨͬ 0/255
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode cannyEdgeDetect(const PPM* in, PPM* out, int low, int high) {
+    unsigned char* edge = (unsigned char*)malloc((size_t)in->width * in->height);
+    if (edge == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = sobelCanny(in, edge, low, high);
+    if (ret == SUCCESS) {
+        ret = edgeToPPM(edge, in->width, in->height, out);
+    }
+    free(edge);
+    return ret;
+}
+
+/**
+ * Canny ԵֱдɰλĶֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode cannyEdgeMask(const PPM* in, BitMask* mask, int low, int high) {
+    unsigned char* edge = (unsigned char*)malloc((size_t)in->width * in->height);
+    if (edge == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = sobelCanny(in, edge, low, high);
+    if (ret == SUCCESS) {
+        ret = edgeToMask(edge, in->width, in->height, mask);
+    }
+    free(edge);
+    return ret;
+}
+
+//========== Otsu Զֵ ==========
+
+#define MAGNITUDE_BINS CANNY_MAX_THRESHOLD  // 8 λҶ Sobel ݶȷֵȡΪ 0~1442 cannyԵ.h
+
+/**
+ * Otsu Զֵ Sobel Եݶȷֱֵͼͬһ߳ۼԼֱͼϲ ֱͼ.h
+ * ֱͼ Otsu ֵһֵж sobelEdgeDetect ֵͬ >= ֵ
+ * @param inɫPPMͼ
+ * @param edge width*height  0/255 Եǰڴ棩
+ * @param thresholdõֵ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode sobelOtsu(const PPM* in, unsigned char* edge, int* threshold) {
+    if (in == NULL || edge == NULL || in->data == NULL) {
+        return ERR_FILE_BROKEN;
+    }
+    if (in->width < 3 || in->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int width = in->width;
+    int height = in->height;
+    size_t count = (size_t)width * height;
+    int* gx = (int*)malloc(sizeof(int) * count);
+    int* gy = (int*)malloc(sizeof(int) * count);
+    int slots;
+    long long* priv = histPrivateAlloc(MAGNITUDE_BINS, &slots);
+    if (gx == NULL || gy == NULL || priv == NULL) {
+        free(gx);
+        free(gy);
+        free(priv);
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC(2 * sizeof(int) * count);
+    ErrorCode ret = sobelGradients(in, gx, gy);
+
+    if (ret == SUCCESS) {
+        // 1. ֵȡд gxͬʱ뱾̵ֱ߳ͼ߽һȦͳ
+        STATS_BEGIN(hist_span, "magnitudeHist");
+        #pragma omp parallel for schedule(static)
+        for (int y = 1; y < height - 1; y++) {
+            long long* hist = histSlot(priv, MAGNITUDE_BINS);
+            int* rx = gx + (size_t)y * width;
+            const int* ry = gy + (size_t)y * width;
+            for (int x = 1; x < width - 1; x++) {
+                int m = (int)sqrt((double)(rx[x] * rx[x] + ry[x] * ry[x]));
+                m = m < MAGNITUDE_BINS ? m : MAGNITUDE_BINS - 1;
+                rx[x] = m;
+                hist[m]++;
+            }
+        }
+        long long hist[MAGNITUDE_BINS];
+        histMerge(priv, slots, MAGNITUDE_BINS, hist);
+        *threshold = histOtsu(hist, MAGNITUDE_BINS);
+        STATS_END(hist_span, width * height);
+
+        // 2. ֵȡķֵ >= t  sqrt(m) >= t ȼۣ
+        int t = *threshold;
+        STATS_BEGIN(sobel_span, "sobel");
+        memset(edge, 0, count);
+        #pragma omp parallel for schedule(static)
+        for (int y = 1; y < height - 1; y++) {
+            const int* row = gx + (size_t)y * width;
+            unsigned char* dst = edge + (size_t)y * width;
+            for (int x = 1; x < width - 1; x++) {
+                dst[x] = row[x] >= t ? 255 : 0;
+            }
+        }
+        STATS_END(sobel_span, width * height);
+    }
+
+    STATS_FREE(2 * sizeof(int) * count);
+    free(gx);
+    free(gy);
+    free(priv);
+    return ret;
+}
+
+/**
+ * Otsu ԶֵıԵͼʽ sobelEdgeDetect ͬ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode otsuEdgeDetect(const PPM* in, PPM* out, int* threshold) {
+    unsigned char* edge = (unsigned char*)malloc((size_t)in->width * in->height);
+    if (edge == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = sobelOtsu(in, edge, threshold);
+    if (ret == SUCCESS) {
+        ret = edgeToPPM(edge, in->width, in->height, out);
+    }
+    free(edge);
+    return ret;
+}
+
+/**
+ * Otsu ԶֵıԵֱдɰλĶֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode otsuEdgeMask(const PPM* in, BitMask* mask, int* threshold) {
+    unsigned char* edge = (unsigned char*)malloc((size_t)in->width * in->height);
+    if (edge == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = sobelOtsu(in, edge, threshold);
+    if (ret == SUCCESS) {
+        ret = edgeToMask(edge, in->width, in->height, mask);
+    }
+    free(edge);
+    return ret;
+}
+
+//========== Եͼ̬ѧ ==========
+
+/**
+ *  0/255 Եƽ̬ѧ㣨 ̬ѧ.h close ϶ϿıԵopen ȥ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode morphEdges(int* edge, int width, int height, int op, int radius) {
+    STATS_BEGIN(morph_span, "morph");
+    int failed = morphPlane(edge, width, height, radius, radius, (MorphOp)op) != 0;
+    STATS_END(morph_span, width * height);
+    return failed ? ERR_MEMORY_ALLOC : SUCCESS;
+}
+
+/**
+ *  PPM ԵͼRGB ̬ͨͬѧ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode morphEdgePPM(PPM* edge, int op, int radius) {
+    size_t count = (size_t)edge->width * edge->height;
+    int* plane = (int*)malloc(sizeof(int) * count);
+    if (plane == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    for (size_t i = 0; i < count; i++) {
+        plane[i] = edge->data[i].r;
+    }
+    ErrorCode ret = morphEdges(plane, edge->width, edge->height, op, radius);
+    for (size_t i = 0; i < count && ret == SUCCESS; i++) {
+        edge->data[i].r = plane[i];
+        edge->data[i].g = plane[i];
+        edge->data[i].b = plane[i];
+    }
+    free(plane);
+    return ret;
+}
+
+/**
+ * ԰λıԵͼ̬ѧ㣬һδ 64 
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode morphEdgeMask(BitMask* mask, int op, int radius) {
+    STATS_BEGIN(morph_span, "morph");
+    int failed = morphMaskBits(mask->bits, mask->stride, mask->width, mask->height, radius, radius, (MorphOp)op) != 0;
+    STATS_END(morph_span, mask->width * mask->height);
+    return failed ? ERR_MEMORY_ALLOC : SUCCESS;
+}
+
+//========== ͨͳ ==========
+
+#define COMPONENTS_SHOWN 5  // ̨гļͨ
+
+/**
+ * дͨͼPPM = R*65536 + G*256 + BΪ 0ͳƱıÿͨһУ
+ * @param ccѱǵͨ򣨼 ͨ.h
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writeComponents(const Components* cc, const char* label_path, const char* table_path) {
+    size_t count = (size_t)cc->width * cc->height;
+    if (cc->count > 0xFFFFFF) {
+        return ERR_ILLEGAL_SIZE;  // ų 24 λ
+    }
+    PPM labels;
+    labels.width = cc->width;
+    labels.height = cc->height;
+    labels.max_val = 255;
+    labels.data = (Pixel*)malloc(sizeof(Pixel) * count);
+    int* plane = (int*)malloc(sizeof(int) * count);
+    if (labels.data == NULL || plane == NULL) {
+        free(labels.data);
+        free(plane);
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC(sizeof(Pixel) * count);
+    ccLabelImage(cc, plane);
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < (long long)count; i++) {
+        labels.data[i].r = (plane[i] >> 16) & 0xFF;
+        labels.data[i].g = (plane[i] >> 8) & 0xFF;
+        labels.data[i].b = plane[i] & 0xFF;
+    }
+    free(plane);
+    ErrorCode ret = writePPM(label_path, &labels);
+    freePPM(&labels);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+
+    FILE* file = fopen(table_path, "w");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    int failed = fprintf(file, "#   x0 y0 x1 y1 x y\n") < 0;
+    for (int i = 0; i < cc->count && !failed; i++) {
+        const CCStats* s = &cc->stats[i];
+        failed = fprintf(file, "%d %lld %d %d %d %d %.2f %.2f\n", i + 1, s->area, s->x0, s->y0, s->x1, s->y1,
+                         (double)s->sum_x / s->area, (double)s->sum_y / s->area) < 0;
+    }
+    STATS_BYTES_WRITTEN(ftell(file));
+    if (fclose(file) != 0 || failed) {
+        return ERR_WRITE_FAILED;
+    }
+    return SUCCESS;
+}
+
+/**
+ * ӡͨļ
+ */
+void printComponents(const Components* cc) {
+    printf("ͨ%d 8 ͨ\n", cc->count);
+    int shown[COMPONENTS_SHOWN];
+    for (int k = 0; k < COMPONENTS_SHOWN && k < cc->count; k++) {
+        int best = -1;
+        for (int i = 0; i < cc->count; i++) {
+            int used = 0;
+            for (int j = 0; j < k; j++) {
+                used |= shown[j] == i;
+            }
+            if (!used && (best < 0 || cc->stats[i].area > cc->stats[best].area)) {
+                best = i;
+            }
+        }
+        shown[k] = best;
+        const CCStats* s = &cc->stats[best];
+        printf("  #%d  %lldӾ (%d,%d)-(%d,%d) (%.1f,%.1f)\n", best + 1, s->area, s->x0, s->y0, s->x1, s->y1,
+               (double)s->sum_x / s->area, (double)s->sum_y / s->area);
+    }
+}
+
+/**
+ * ֵԵͼĺ裺̬ѧѡ-> ͨ򣨿ѡ-> д PBM P4
+ * @param morph_op-1=̬ѧ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode finishMask(BitMask* mask, int morph_op, int morph_radius, int components,
+    const char* label_path, const char* table_path, const char* output_path) {
+    ErrorCode ret = SUCCESS;
+    if (morph_op >= 0) {
+        ret = morphEdgeMask(mask, morph_op, morph_radius);
+    }
+    if (ret == SUCCESS && components) {
+        Components cc;
+        STATS_BEGIN(cc_span, "components");
+        ret = ccLabelBits(&cc, mask->bits, mask->stride, mask->width, mask->height, 8) == 0 ? SUCCESS : ERR_MEMORY_ALLOC;
+        STATS_END(cc_span, mask->width * mask->height);
+        if (ret == SUCCESS) {
+            printComponents(&cc);
+            ret = writeComponents(&cc, label_path, table_path);
+            ccFree(&cc);
+        }
+    }
+    if (ret == SUCCESS) {
+        printf("ڱԵͼ%s...\n", output_path);
+        STATS_BEGIN(pbm_span, "write");
+        ret = writePBM(output_path, mask);
+        STATS_END(pbm_span, mask->width * mask->height);
+    }
+    return ret;
+}
+
 /**
  * ̿
  */
-int main() {
+int main(int argc, char* argv[]) {
+    STATS_INIT(argc, argv);
+    RESULT_CACHE_INIT(argc, argv);
+
     // 1. ò
     const char* input_path = "C:\\code\\001 ͼѧϰ\\man.ppm";    // ɫPPM·
     const char* output_path = "C:\\code\\001 ͼѧϰ\\(Ե)man.ppm";  // Եͼ·
     unsigned char sobel_threshold = 50;      // Եֵ0~255ɵ
+    const char* pyramid_pattern = "C:\\code\\001 ͼѧϰ\\(Ե)man.L%d.ppm";  // ߶ʱÿ·
+    int pbm_output = 0;      // --pbmλ PBM P4
+    int pyramid_levels = 0;  // --pyramid N N ˹ϸһ Sobelÿдһļ
+    int morph_op = -1;       // --morph  RԵͼһ (2R+1)x(2R+1) ĸʴ///
+    int morph_radius = 0;
+    int canny_low = -1;      // --canny  ߣ CannyǼֵ + ͺӣõһֵ
+    int canny_high = -1;
+    int otsu = 0;            // --otsuֵݶȷֱֵͼ Otsu Զ
+    int components = 0;      // --componentsдԵͨͼͳƱ
+    const char* mask_path = NULL;  // --mask ļֱӶе PBM P4 Եͼϴ --pbm Ե
+    const char* label_path = "C:\\code\\001 ͼѧϰ\\(Ե)man.labels.ppm";       // ͨͼ
+    const char* table_path = "C:\\code\\001 ͼѧϰ\\(Ե)man.components.txt";   // ͨͳƱ
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pbm") == 0) {
+            pbm_output = 1;
+        }
+        else if (strcmp(argv[i], "--pyramid") == 0 && i + 1 < argc) {
+            pyramid_levels = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--canny") == 0 && i + 2 < argc) {
+            canny_low = atoi(argv[++i]);
+            canny_high = atoi(argv[++i]);
+            if (canny_low < 0 || canny_high < canny_low || canny_high > CANNY_MAX_THRESHOLD) {
+                printf("%s\n", error_messages[ERR_BAD_CANNY]);
+                STATS_FINISH();
+                return ERR_BAD_CANNY;
+            }
+        }
+        else if (strcmp(argv[i], "--otsu") == 0) {
+            otsu = 1;
+        }
+        else if (strcmp(argv[i], "--mask") == 0 && i + 1 < argc) {
+            mask_path = argv[++i];
+            pbm_output = 1;
+        }
+        else if (strcmp(argv[i], "--components") == 0) {
+            components = 1;
+        }
+        else if (strcmp(argv[i], "--morph") == 0 && i + 2 < argc) {
+            morph_op = morphOpByName(argv[++i]);
+            morph_radius = atoi(argv[++i]);
+            if (morph_op < 0 || morph_radius < 1) {
+                printf("%s\n", error_messages[ERR_BAD_MORPH]);
+                STATS_FINISH();
+                return ERR_BAD_MORPH;
+            }
+        }
+    }
+    if (pbm_output) {
+        output_path = "C:\\code\\001 ͼѧϰ\\(Ե)man.pbm";
+    }
+
+    // ֵûʱֱȡĽ --cache DIR 
+    ResultKey cache_key;
+    resultKeyInit(&cache_key, "sobel");
+    resultKeyAddFile(&cache_key, mask_path != NULL ? mask_path : input_path);
+    resultKeyAddInt(&cache_key, "mask_input", mask_path != NULL);
+    resultKeyAddInt(&cache_key, "threshold", sobel_threshold);
+    resultKeyAddInt(&cache_key, "pbm", pbm_output);
+    if (canny_high >= 0) {
+        resultKeyAddInt(&cache_key, "canny_low", canny_low);
+        resultKeyAddInt(&cache_key, "canny_high", canny_high);
+    }
+    else if (otsu) {
+        resultKeyAddInt(&cache_key, "otsu", otsu);
+    }
+    if (morph_op >= 0) {
+        resultKeyAddInt(&cache_key, "morph", morph_op);
+        resultKeyAddInt(&cache_key, "morph_radius", morph_radius);
+    }
+    if (pyramid_levels <= 0 && !components && resultCacheFetch(&cache_key, output_path)) {
+        printf("Ѵӽд%s\n", output_path);
+        STATS_FINISH();
+        return SUCCESS;
+    }
+
+    // 2~5. ֵͼ룺 P4 ԭλ̬ѧͨ򣩣չ
+    if (mask_path != NULL) {
+        BitMask mask;
+        printf("ڶȡֵͼ%s...\n", mask_path);
+        STATS_BEGIN(mask_read_span, "read");
+        ErrorCode mask_ret = readPBM(mask_path, &mask);
+        STATS_END(mask_read_span, mask.width * mask.height);
+        if (mask_ret == SUCCESS) {
+            printf("ȡɹ%dx%d \n", mask.width, mask.height);
+            mask_ret = finishMask(&mask, morph_op, morph_radius, components, label_path, table_path, output_path);
+            freeMask(&mask);
+        }
+        if (mask_ret != SUCCESS) {
+            printf("%s\n", error_messages[mask_ret]);
+            STATS_FINISH();
+            return mask_ret;
+        }
+        printf("ɹ\n");
+        resultCacheStore(&cache_key, output_path);
+        STATS_FINISH();
+        return SUCCESS;
+    }
 
     // 2. PPMṹ
     PPM in_ppm, out_ppm;
@@ -278,38 +1144,166 @@ int main() {
 
     // 3. ȡͼ
     printf("ڶȡͼ%s...\n", input_path);
+    STATS_BEGIN(read_span, "read");
     ErrorCode read_ret = readPPM(input_path, &in_ppm);
+    STATS_END(read_span, in_ppm.width * in_ppm.height);
     if (read_ret != SUCCESS) {
         printf("%s\n", error_messages[read_ret]);
+        STATS_FINISH();
         return read_ret;
     }
     printf("ȡɹ%dx%d أֵ%d\n", in_ppm.width, in_ppm.height, in_ppm.max_val);
 
+    // 4/5. ߶ģʽԵͼת PPM ֱдļ߽棩
+    if (pyramid_levels > 0) {
+        Pyramid gauss, edges;
+        memset(&gauss, 0, sizeof(Pyramid));
+        memset(&edges, 0, sizeof(Pyramid));
+        printf("ڽж߶SobelԵ⣨%d 㣬ֵ%d...\n", pyramid_levels, sobel_threshold);
+        STATS_BEGIN(pyramid_span, "handle");
+        ErrorCode pyramid_ret = sobelPyramidEdges(&in_ppm, &gauss, &edges, pyramid_levels, sobel_threshold);
+        STATS_END(pyramid_span, in_ppm.width * in_ppm.height);
+        freePPM(&in_ppm);
+        for (int l = 0; l < edges.levels && pyramid_ret == SUCCESS && morph_op >= 0; l++) {
+            pyramid_ret = morphEdges(pyramidLevel(&edges, l), edges.width[l], edges.height[l], morph_op, morph_radius);
+        }
+        for (int l = 0; l < edges.levels && pyramid_ret == SUCCESS; l++) {
+            char level_path[512];
+            snprintf(level_path, sizeof(level_path), pyramid_pattern, l);
+            out_ppm.width = edges.width[l];
+            out_ppm.height = edges.height[l];
+            out_ppm.max_val = 255;
+            out_ppm.data = (Pixel*)malloc(sizeof(Pixel) * out_ppm.width * out_ppm.height);
+            if (out_ppm.data == NULL) {
+                pyramid_ret = ERR_MEMORY_ALLOC;
+                break;
+            }
+            STATS_ALLOC(sizeof(Pixel) * out_ppm.width * out_ppm.height);
+            const int* edge = pyramidLevel(&edges, l);
+            for (int i = 0; i < out_ppm.width * out_ppm.height; i++) {
+                out_ppm.data[i].r = edge[i];
+                out_ppm.data[i].g = edge[i];
+                out_ppm.data[i].b = edge[i];
+            }
+            printf("ڱ %d Եͼ%dx%d%s...\n", l, out_ppm.width, out_ppm.height, level_path);
+            STATS_BEGIN(level_span, "write");
+            pyramid_ret = writePPM(level_path, &out_ppm);
+            STATS_END(level_span, out_ppm.width * out_ppm.height);
+            freePPM(&out_ppm);
+        }
+        pyramidFree(&gauss);
+        pyramidFree(&edges);
+        if (pyramid_ret != SUCCESS) {
+            printf("%s\n", error_messages[pyramid_ret]);
+            STATS_FINISH();
+            return pyramid_ret;
+        }
+        printf("ɹ\n");
+        STATS_FINISH();
+        return SUCCESS;
+    }
+
+    // 4/5. PBM ģʽԵͼֻ԰λʽڣֱд P4
+    if (pbm_output) {
+        BitMask mask;
+        memset(&mask, 0, sizeof(BitMask));
+        ErrorCode mask_ret;
+        STATS_BEGIN(mask_span, "handle");
+        if (canny_high >= 0) {
+            printf("ڽCannyԵ⣨ֵ%dֵ%dPBM...\n", canny_low, canny_high);
+            mask_ret = cannyEdgeMask(&in_ppm, &mask, canny_low, canny_high);
+        }
+        else if (otsu) {
+            int otsu_threshold = 0;
+            printf("ڽSobelԵ⣨Otsu ԶֵPBM...\n");
+            mask_ret = otsuEdgeMask(&in_ppm, &mask, &otsu_threshold);
+            if (mask_ret == SUCCESS) {
+                printf("Otsu ֵ%d\n", otsu_threshold);
+            }
+        }
+        else {
+            printf("ڽSobelԵ⣨ֵ%dPBM...\n", sobel_threshold);
+            mask_ret = sobelEdgeMask(&in_ppm, &mask, sobel_threshold);
+        }
+        STATS_END(mask_span, in_ppm.width * in_ppm.height);
+        if (mask_ret == SUCCESS) {
+            mask_ret = finishMask(&mask, morph_op, morph_radius, components, label_path, table_path, output_path);
+        }
+        freeMask(&mask);
+        freePPM(&in_ppm);
+        if (mask_ret != SUCCESS) {
+            printf("%s\n", error_messages[mask_ret]);
+            STATS_FINISH();
+            return mask_ret;
+        }
+        printf("ɹ\n");
+        resultCacheStore(&cache_key, output_path);
+        STATS_FINISH();
+        return SUCCESS;
+    }
+
     // 4. SobelԵ
-    printf("ڽSobelԵ⣨ֵ%d...\n", sobel_threshold);
-    ErrorCode sobel_ret = sobelEdgeDetect(&in_ppm, &out_ppm, sobel_threshold);
+    ErrorCode sobel_ret;
+    STATS_BEGIN(handle_span, "handle");
+    if (canny_high >= 0) {
+        printf("ڽCannyԵ⣨ֵ%dֵ%d...\n", canny_low, canny_high);
+        sobel_ret = cannyEdgeDetect(&in_ppm, &out_ppm, canny_low, canny_high);
+    }
+    else if (otsu) {
+        int otsu_threshold = 0;
+        printf("ڽSobelԵ⣨Otsu Զֵ...\n");
+        sobel_ret = otsuEdgeDetect(&in_ppm, &out_ppm, &otsu_threshold);
+        if (sobel_ret == SUCCESS) {
+            printf("Otsu ֵ%d\n", otsu_threshold);
+        }
+    }
+    else {
+        printf("ڽSobelԵ⣨ֵ%d...\n", sobel_threshold);
+        sobel_ret = sobelEdgeDetect(&in_ppm, &out_ppm, sobel_threshold);
+    }
+    STATS_END(handle_span, in_ppm.width * in_ppm.height);
+    if (sobel_ret == SUCCESS && morph_op >= 0) {
+        sobel_ret = morphEdgePPM(&out_ppm, morph_op, morph_radius);
+    }
+    if (sobel_ret == SUCCESS && components) {
+        Components cc;
+        STATS_BEGIN(cc_span, "components");
+        sobel_ret = ccLabelPlane(&cc, (const int*)out_ppm.data, out_ppm.width, out_ppm.height, 3, 8) == 0 ? SUCCESS : ERR_MEMORY_ALLOC;
+        STATS_END(cc_span, out_ppm.width * out_ppm.height);
+        if (sobel_ret == SUCCESS) {
+            printComponents(&cc);
+            sobel_ret = writeComponents(&cc, label_path, table_path);
+            ccFree(&cc);
+        }
+    }
     if (sobel_ret != SUCCESS) {
         printf("%s\n", error_messages[sobel_ret]);
         freePPM(&in_ppm);
         freePPM(&out_ppm);
+        STATS_FINISH();
         return sobel_ret;
     }
     printf("Ե\n");
 
     // 5. 
     printf("ڱԵͼ%s...\n", output_path);
+    STATS_BEGIN(write_span, "write");
     ErrorCode write_ret = writePPM(output_path, &out_ppm);
+    STATS_END(write_span, out_ppm.width * out_ppm.height);
     if (write_ret != SUCCESS) {
         printf("%s\n", error_messages[write_ret]);
         freePPM(&in_ppm);
         freePPM(&out_ppm);
+        STATS_FINISH();
         return write_ret;
     }
     printf("ɹ\n");
+    resultCacheStore(&cache_key, output_path);
 
     // 6. ͷڴ
     freePPM(&in_ppm);
     freePPM(&out_ppm);
 
+    STATS_FINISH();
     return SUCCESS;
 }
\ No newline at end of file
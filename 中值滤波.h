@@ -0,0 +1,154 @@
+/**
+ * ֵ˲PerreaultCHbert ʱ㷨8 λ0~255ÿغʱ뾶޹
+ *
+ * ÿάһֱͼԵǰΪĵ 2r+1 УʱÿֻȥƳһСһС
+ * ֱͼ 2r+1 ֱͼӵõƶһʱֻұСȥƳУ
+ * ֱͼӼ 256  16 λӼ SIMD չAVX2 ÿָ 16 
+ * ֱͼִ֣16 ÿ 16 ֵϸ256 ֵʱڴֱͼ϶λٲ 16 ϸ
+ * ͼⰴƱԵȡֵΪ (2r+1)^2
+ * ̣߳-fopenmpʱдУÿдԴдһгʼֱͼ
+ * ÷
+ *   medianFilterPlane(src, dst, width, height, radius);   // srcdst ͬһƽ
+ */
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MEDIAN_MAX_RADIUS 127  // (2r+1)^2  16 λ
+
+typedef struct {
+    unsigned short fine[256];   // ÿֵĸ
+    unsigned short coarse[16];  // ÿ 16 ֵĸ֮
+} MedianHist;
+
+static inline void medianHistAdd(MedianHist* k, const MedianHist* h) {
+    #pragma omp simd
+    for (int i = 0; i < 256; i++) {
+        k->fine[i] += h->fine[i];
+    }
+    #pragma omp simd
+    for (int i = 0; i < 16; i++) {
+        k->coarse[i] += h->coarse[i];
+    }
+}
+
+static inline void medianHistSub(MedianHist* k, const MedianHist* h) {
+    #pragma omp simd
+    for (int i = 0; i < 256; i++) {
+        k->fine[i] -= h->fine[i];
+    }
+    #pragma omp simd
+    for (int i = 0; i < 16; i++) {
+        k->coarse[i] -= h->coarse[i];
+    }
+}
+
+/**
+ *  rank Сֵrank  0 ʼ
+ */
+static inline int medianHistFind(const MedianHist* k, int rank) {
+    int below = 0;
+    int c = 0;
+    while (below + k->coarse[c] <= rank) {
+        below += k->coarse[c];
+        c++;
+    }
+    int v = c * 16;
+    while (below + k->fine[v] <= rank) {
+        below += k->fine[v];
+        v++;
+    }
+    return v;
+}
+
+static inline int medianClamp(int i, int n) {
+    return i < 0 ? 0 : (i < n ? i : n - 1);
+}
+
+/**
+ *  [y0, y1) 
+ * @param colswidth ֱͼĹ
+ */
+static inline void medianBand(const int* src, int* dst, int width, int height, int radius, int y0, int y1, MedianHist* cols) {
+    int rank = (2 * radius + 1) * (2 * radius + 1) / 2;
+    MedianHist k;
+
+    // 1. ֱͼʼΪ y0 еĴ
+    memset(cols, 0, sizeof(MedianHist) * width);
+    for (int i = y0 - radius; i <= y0 + radius; i++) {
+        const int* row = src + (size_t)medianClamp(i, height) * width;
+        for (int x = 0; x < width; x++) {
+            cols[x].fine[row[x]]++;
+            cols[x].coarse[row[x] >> 4]++;
+        }
+    }
+
+    for (int y = y0; y < y1; y++) {
+        // 2. УÿмȥƳһСһ
+        if (y > y0) {
+            const int* out_row = src + (size_t)medianClamp(y - radius - 1, height) * width;
+            const int* in_row = src + (size_t)medianClamp(y + radius, height) * width;
+            for (int x = 0; x < width; x++) {
+                cols[x].fine[out_row[x]]--;
+                cols[x].coarse[out_row[x] >> 4]--;
+                cols[x].fine[in_row[x]]++;
+                cols[x].coarse[in_row[x] >> 4]++;
+            }
+        }
+
+        // 3. лֱͼ
+        memset(&k, 0, sizeof(MedianHist));
+        for (int j = -radius; j <= radius; j++) {
+            medianHistAdd(&k, &cols[medianClamp(j, width)]);
+        }
+        int* out = dst + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            out[x] = medianHistFind(&k, rank);
+            int left = medianClamp(x - radius, width);
+            int right = medianClamp(x + radius + 1, width);
+            if (x + 1 < width && left != right) {
+                medianHistAdd(&k, &cols[right]);
+                medianHistSub(&k, &cols[left]);
+            }
+        }
+    }
+}
+
+/**
+ * ֵ˲һƽ
+ * @param srcwidth*height  0~255 
+ * @param dst src ͬ
+ * @param radiusΪ (2*radius+1)^21~MEDIAN_MAX_RADIUS
+ * @return 0=ɹ-1=뾶Ϸڴ治
+ */
+static inline int medianFilterPlane(const int* src, int* dst, int width, int height, int radius) {
+    if (radius < 1 || radius > MEDIAN_MAX_RADIUS || src == dst) {
+        return -1;
+    }
+    int bands = 1;
+#ifdef _OPENMP
+    bands = omp_get_max_threads();
+#endif
+    bands = bands < height ? bands : height;
+    int failed = 0;
+    #pragma omp parallel for schedule(static) reduction(|:failed)
+    for (int b = 0; b < bands; b++) {
+        MedianHist* cols = (MedianHist*)malloc(sizeof(MedianHist) * width);
+        if (cols == NULL) {
+            failed = 1;
+            continue;
+        }
+        int y0 = (int)((long long)height * b / bands);
+        int y1 = (int)((long long)height * (b + 1) / bands);
+        medianBand(src, dst, width, height, radius, y0, y1, cols);
+        free(cols);
+    }
+    return failed ? -1 : 0;
+}
+
+#endif
\ No newline at end of file
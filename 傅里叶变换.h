@@ -0,0 +1,212 @@
+/**
+ * ٸҶ任 2  FFT ʵ FFTΪ 2 ݣⲿ
+ *
+ *  FFT Ϊԭصʵ֣תλת± fftInit ʱá
+ * ʵ FFT  n ʵƴ n/2 һΰ볤 FFT ٲ n/2+1 Ƶʷ
+ * ֮Գƣ棩ԼΪͬȸ FFT һ롣
+ * 任һ x 任ٷ任õ n * x
+ * ÷
+ *   RealFft plan;
+ *   realFftInit(&plan, 256);
+ *   realFftForward(&plan, x, X);   // x256 ʵX129 
+ *   realFftInverse(&plan, X, x);   // x Ϊԭ 256 
+ *   realFftFree(&plan);
+ */
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdlib.h>
+#include <math.h>
+
+typedef struct {
+    double re;
+    double im;
+} Complex;
+
+// n 㸴 FFT
+typedef struct {
+    int n;
+    Complex* twiddle;  // e^(-2*pi*i*k/n)k < n/2
+    int* reverse;      // λת±
+} Fft;
+
+static inline void fftFree(Fft* f) {
+    free(f->twiddle);
+    free(f->reverse);
+    f->twiddle = NULL;
+    f->reverse = NULL;
+}
+
+/**
+ * @param nȣ2 
+ * @return 0=ɹ-1=ȲϷڴ治
+ */
+static inline int fftInit(Fft* f, int n) {
+    f->n = n;
+    f->twiddle = NULL;
+    f->reverse = NULL;
+    if (n < 1 || (n & (n - 1)) != 0) {
+        return -1;
+    }
+    f->twiddle = (Complex*)malloc(sizeof(Complex) * (n / 2 + 1));
+    f->reverse = (int*)malloc(sizeof(int) * n);
+    if (f->twiddle == NULL || f->reverse == NULL) {
+        fftFree(f);
+        return -1;
+    }
+    const double pi = 3.14159265358979323846;
+    for (int k = 0; k < n / 2; k++) {
+        f->twiddle[k].re = cos(2 * pi * k / n);
+        f->twiddle[k].im = -sin(2 * pi * k / n);
+    }
+    int bits = 0;
+    while ((1 << bits) < n) {
+        bits++;
+    }
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        f->reverse[i] = r;
+    }
+    return 0;
+}
+
+/**
+ * ԭظ FFT
+ * @param inverse1=任תȡ n
+ */
+static inline void fftRun(const Fft* f, Complex* a, int inverse) {
+    int n = f->n;
+    for (int i = 0; i < n; i++) {
+        int j = f->reverse[i];
+        if (i < j) {
+            Complex t = a[i];
+            a[i] = a[j];
+            a[j] = t;
+        }
+    }
+    double sign = inverse ? -1.0 : 1.0;
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len / 2;
+        int step = n / len;
+        for (int i = 0; i < n; i += len) {
+            Complex* p = a + i;
+            Complex* q = a + i + half;
+            for (int k = 0; k < half; k++) {
+                double wr = f->twiddle[k * step].re;
+                double wi = sign * f->twiddle[k * step].im;
+                double vr = q[k].re * wr - q[k].im * wi;
+                double vi = q[k].re * wi + q[k].im * wr;
+                q[k].re = p[k].re - vr;
+                q[k].im = p[k].im - vi;
+                p[k].re += vr;
+                p[k].im += vi;
+            }
+        }
+    }
+}
+
+// n ʵ FFT n/2 㸴 FFT
+typedef struct {
+    int n;
+    Fft half;          // n/2 㸴 FFT
+    Complex* twiddle;  // e^(-2*pi*i*k/n)k < n/2ڲż
+    Complex* work;     // n/2 Ĺ
+} RealFft;
+
+static inline void realFftFree(RealFft* f) {
+    fftFree(&f->half);
+    free(f->twiddle);
+    free(f->work);
+    f->twiddle = NULL;
+    f->work = NULL;
+}
+
+/**
+ * @param nȣ2 ҲС 2
+ * @return 0=ɹ-1=ȲϷڴ治
+ */
+static inline int realFftInit(RealFft* f, int n) {
+    f->n = n;
+    f->twiddle = NULL;
+    f->work = NULL;
+    if (n < 2 || fftInit(&f->half, n / 2) != 0) {
+        f->half.twiddle = NULL;
+        f->half.reverse = NULL;
+        return -1;
+    }
+    f->twiddle = (Complex*)malloc(sizeof(Complex) * (n / 2));
+    f->work = (Complex*)malloc(sizeof(Complex) * (n / 2));
+    if (f->twiddle == NULL || f->work == NULL) {
+        realFftFree(f);
+        return -1;
+    }
+    const double pi = 3.14159265358979323846;
+    for (int k = 0; k < n / 2; k++) {
+        f->twiddle[k].re = cos(2 * pi * k / n);
+        f->twiddle[k].im = -sin(2 * pi * k / n);
+    }
+    return 0;
+}
+
+/**
+ * ʵ任
+ * @param xn ʵ
+ * @param X n/2+1  0  n/2 Ƶʷ
+ */
+static inline void realFftForward(RealFft* f, const double* x, Complex* X) {
+    int m = f->n / 2;
+    Complex* z = f->work;
+    for (int k = 0; k < m; k++) {
+        z[k].re = x[2 * k];
+        z[k].im = x[2 * k + 1];
+    }
+    fftRun(&f->half, z, 0);
+    // żλƵ E = (Z[k] + conj(Z[m-k])) / 2λ O = (Z[k] - conj(Z[m-k])) / 2iX[k] = E + W^k * O
+    for (int k = 0; k <= m; k++) {
+        Complex a = z[k % m];
+        Complex b = z[(m - k) % m];
+        double even_re = (a.re + b.re) / 2;
+        double even_im = (a.im - b.im) / 2;
+        double odd_re = (a.im + b.im) / 2;
+        double odd_im = (b.re - a.re) / 2;
+        double wr = k < m ? f->twiddle[k].re : -1.0;
+        double wi = k < m ? f->twiddle[k].im : 0.0;
+        X[k].re = even_re + wr * odd_re - wi * odd_im;
+        X[k].im = even_im + wr * odd_im + wi * odd_re;
+    }
+}
+
+/**
+ * ʵ任 n
+ * @param Xn/2+1 
+ * @param x n ʵ
+ */
+static inline void realFftInverse(RealFft* f, const Complex* X, double* x) {
+    int m = f->n / 2;
+    Complex* z = f->work;
+    //  X ԭ EOʡ 1/2 2ôճ n ƴ Z = E + i*O
+    for (int k = 0; k < m; k++) {
+        Complex a = X[k];
+        Complex b = X[m - k];
+        double even_re = a.re + b.re;
+        double even_im = a.im - b.im;
+        double dr = a.re - b.re;
+        double di = a.im + b.im;
+        double wr = f->twiddle[k].re;
+        double wi = -f->twiddle[k].im;  // W^-k
+        double odd_re = dr * wr - di * wi;
+        double odd_im = dr * wi + di * wr;
+        z[k].re = even_re - odd_im;
+        z[k].im = even_im + odd_re;
+    }
+    fftRun(&f->half, z, 1);
+    for (int k = 0; k < m; k++) {
+        x[2 * k] = z[k].re;
+        x[2 * k + 1] = z[k].im;
+    }
+}
+
+#endif
\ No newline at end of file
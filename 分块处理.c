@@ -0,0 +1,913 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ɫת.h"
+
+// 64 λļƫƣ 2GB Ƭļ
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#else
+#define fseek64 fseeko
+#endif
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_CROP_OUT_OF_BOUNDS,
+    ERR_BAD_ARGUMENT
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PPM P3/P6ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "󣺲ü򳬳ͼ߽",
+    "вϷ"
+};
+
+#define MAX_IMAGES 4  // һҽӵͼ
+
+struct TileCache;
+
+// ֿͼذ tile x tile ƬڴļУÿ 3 ֽڣRGB
+typedef struct {
+    int id;                   // ڻеı
+    long long width;          // ͼȣ64 λ֧ 100k x 100k
+    long long height;         // ͼ߶
+    int max_val;              // ֵ<=255
+    long long tiles_x;        // Ƭ
+    long long tiles_y;        // Ƭ
+    FILE* file;               // Ƭļ
+    char path[512];           // ļ·ʱɾ
+    struct TileCache* cache;  // Ƭ
+} TiledImage;
+
+// 
+typedef struct {
+    int image;            // ͼţ-1 ʾղۣ
+    long long index;      // Ƭ tx + ty * tiles_x
+    int dirty;            // ǷҪд
+    int prev;             // LRU ʹ
+    int next;             // LRU δ
+    int hash_next;        // ϣͰ
+    unsigned char* data;  // Ƭ
+} CacheSlot;
+
+// LRU Ƭ棺λڴ޾ڴ水
+typedef struct TileCache {
+    int tile;             // Ƭ߳
+    size_t tile_bytes;    // ÿƬֽ
+    CacheSlot* slots;
+    int slot_count;       // λ
+    int used;             // ѷĲλ
+    int* buckets;
+    int bucket_count;     // 2 
+    int lru_head;         // ʹ
+    int lru_tail;         // δ
+    TiledImage* images[MAX_IMAGES];
+    long long hits;
+    long long misses;
+    long long writebacks;
+} TileCache;
+
+//========== Ƭ ==========
+
+/**
+ * ʼƬ
+ * @param tileƬ߳
+ * @param cap_bytesڴޣܷ 1 Ƭ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode initCache(TileCache* cache, int tile, size_t cap_bytes) {
+    memset(cache, 0, sizeof(TileCache));
+    cache->tile = tile;
+    cache->tile_bytes = (size_t)tile * tile * 3;
+    cache->slot_count = (int)(cap_bytes / cache->tile_bytes);
+    if (cache->slot_count < 1) {
+        cache->slot_count = 1;
+    }
+    cache->bucket_count = 1;
+    while (cache->bucket_count < cache->slot_count * 2) {
+        cache->bucket_count <<= 1;
+    }
+    cache->slots = (CacheSlot*)calloc(cache->slot_count, sizeof(CacheSlot));
+    cache->buckets = (int*)malloc(sizeof(int) * cache->bucket_count);
+    if (cache->slots == NULL || cache->buckets == NULL) {
+        free(cache->slots);
+        free(cache->buckets);
+        return ERR_MEMORY_ALLOC;
+    }
+    for (int i = 0; i < cache->bucket_count; i++) {
+        cache->buckets[i] = -1;
+    }
+    cache->lru_head = -1;
+    cache->lru_tail = -1;
+    return SUCCESS;
+}
+
+unsigned int hashTile(int image, long long index, int bucket_count) {
+    unsigned long long h = (unsigned long long)index * 0x9E3779B97F4A7C15ULL + (unsigned long long)image;
+    return (unsigned int)(h >> 32) & (unsigned int)(bucket_count - 1);
+}
+
+void lruUnlink(TileCache* cache, int s) {
+    CacheSlot* slot = &cache->slots[s];
+    if (slot->prev >= 0) {
+        cache->slots[slot->prev].next = slot->next;
+    }
+    else {
+        cache->lru_head = slot->next;
+    }
+    if (slot->next >= 0) {
+        cache->slots[slot->next].prev = slot->prev;
+    }
+    else {
+        cache->lru_tail = slot->prev;
+    }
+}
+
+void lruPushFront(TileCache* cache, int s) {
+    CacheSlot* slot = &cache->slots[s];
+    slot->prev = -1;
+    slot->next = cache->lru_head;
+    if (cache->lru_head >= 0) {
+        cache->slots[cache->lru_head].prev = s;
+    }
+    cache->lru_head = s;
+    if (cache->lru_tail < 0) {
+        cache->lru_tail = s;
+    }
+}
+
+void hashRemove(TileCache* cache, int s) {
+    CacheSlot* slot = &cache->slots[s];
+    unsigned int h = hashTile(slot->image, slot->index, cache->bucket_count);
+    int* link = &cache->buckets[h];
+    while (*link >= 0) {
+        if (*link == s) {
+            *link = slot->hash_next;
+            return;
+        }
+        link = &cache->slots[*link].hash_next;
+    }
+}
+
+/**
+ * Ƭдغļ
+ */
+ErrorCode writeBack(TileCache* cache, int s) {
+    CacheSlot* slot = &cache->slots[s];
+    TiledImage* img = cache->images[slot->image];
+    if (fseek64(img->file, (long long)slot->index * (long long)cache->tile_bytes, SEEK_SET) != 0 ||
+        fwrite(slot->data, 1, cache->tile_bytes, img->file) != cache->tile_bytes) {
+        return ERR_WRITE_FAILED;
+    }
+    slot->dirty = 0;
+    cache->writebacks++;
+    return SUCCESS;
+}
+
+/**
+ * ȡƬָ루δʱӺļ룬Ҫʱ̭δõƬ
+ * صָֻһ getTile ֮ǰЧ
+ * @param for_write÷޸Ƭ
+ * @param tileƬָ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode getTile(TiledImage* img, long long tx, long long ty, int for_write, unsigned char** tile) {
+    TileCache* cache = img->cache;
+    long long index = tx + ty * img->tiles_x;
+    unsigned int h = hashTile(img->id, index, cache->bucket_count);
+
+    for (int s = cache->buckets[h]; s >= 0; s = cache->slots[s].hash_next) {
+        if (cache->slots[s].image == img->id && cache->slots[s].index == index) {
+            cache->hits++;
+            lruUnlink(cache, s);
+            lruPushFront(cache, s);
+            cache->slots[s].dirty |= for_write;
+            *tile = cache->slots[s].data;
+            return SUCCESS;
+        }
+    }
+
+    // δУпղÿղۣ̭β
+    cache->misses++;
+    int s;
+    if (cache->used < cache->slot_count) {
+        s = cache->used;
+        cache->slots[s].data = (unsigned char*)malloc(cache->tile_bytes);
+        if (cache->slots[s].data == NULL) {
+            return ERR_MEMORY_ALLOC;
+        }
+        cache->used++;
+    }
+    else {
+        s = cache->lru_tail;
+        if (cache->slots[s].dirty) {
+            ErrorCode ret = writeBack(cache, s);
+            if (ret != SUCCESS) {
+                return ret;
+            }
+        }
+        hashRemove(cache, s);
+        lruUnlink(cache, s);
+    }
+
+    CacheSlot* slot = &cache->slots[s];
+    slot->image = img->id;
+    slot->index = index;
+    slot->dirty = for_write;
+    // δдƬļ 0
+    size_t got = 0;
+    if (fseek64(img->file, index * (long long)cache->tile_bytes, SEEK_SET) == 0) {
+        got = fread(slot->data, 1, cache->tile_bytes, img->file);
+    }
+    if (got < cache->tile_bytes) {
+        memset(slot->data + got, 0, cache->tile_bytes - got);
+    }
+    slot->hash_next = cache->buckets[h];
+    cache->buckets[h] = s;
+    lruPushFront(cache, s);
+    *tile = slot->data;
+    return SUCCESS;
+}
+
+/**
+ * ѻĳͼƬȫд
+ */
+ErrorCode flushImage(TiledImage* img) {
+    TileCache* cache = img->cache;
+    for (int s = 0; s < cache->used; s++) {
+        if (cache->slots[s].image == img->id && cache->slots[s].dirty) {
+            ErrorCode ret = writeBack(cache, s);
+            if (ret != SUCCESS) {
+                return ret;
+            }
+        }
+    }
+    return fflush(img->file) == 0 ? SUCCESS : ERR_WRITE_FAILED;
+}
+
+void freeCache(TileCache* cache) {
+    for (int s = 0; s < cache->used; s++) {
+        free(cache->slots[s].data);
+    }
+    free(cache->slots);
+    free(cache->buckets);
+    cache->slots = NULL;
+    cache->buckets = NULL;
+}
+
+//========== ֿͼ ==========
+
+/**
+ * ֿͼļ
+ * @param pathļ·
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode createTiled(TiledImage* img, TileCache* cache, const char* path,
+    long long width, long long height, int max_val) {
+    memset(img, 0, sizeof(TiledImage));
+    if (width <= 0 || height <= 0 || max_val <= 0 || max_val > 255) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int id = -1;
+    for (int i = 0; i < MAX_IMAGES; i++) {
+        if (cache->images[i] == NULL) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0) {
+        return ERR_MEMORY_ALLOC;
+    }
+    img->id = id;
+    img->width = width;
+    img->height = height;
+    img->max_val = max_val;
+    img->tiles_x = (width + cache->tile - 1) / cache->tile;
+    img->tiles_y = (height + cache->tile - 1) / cache->tile;
+    img->cache = cache;
+    strncpy(img->path, path, sizeof(img->path) - 1);
+    img->file = fopen(path, "w+b");
+    if (img->file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    cache->images[id] = img;
+    return SUCCESS;
+}
+
+/**
+ * رշֿͼ񣺶еƬɾļ
+ */
+void closeTiled(TiledImage* img) {
+    if (img->file == NULL) {
+        return;
+    }
+    TileCache* cache = img->cache;
+    for (int s = 0; s < cache->used; s++) {
+        if (cache->slots[s].image == img->id) {
+            hashRemove(cache, s);
+            cache->slots[s].image = -1;
+            cache->slots[s].index = -1;
+            cache->slots[s].dirty = 0;
+        }
+    }
+    cache->images[img->id] = NULL;
+    fclose(img->file);
+    img->file = NULL;
+    remove(img->path);
+}
+
+/**
+ * ȡÿ 3 ֽڣͼĲ 0ɫ getPixel  BLACK һ£
+ * @param x0/y0ϽǣΪ
+ * @param w/hߴ
+ * @param bufw*h*3 ֽ
+ */
+ErrorCode readRegion(TiledImage* img, long long x0, long long y0, int w, int h, unsigned char* buf) {
+    int tile = img->cache->tile;
+    memset(buf, 0, (size_t)w * h * 3);
+    long long xa = x0 < 0 ? 0 : x0;
+    long long ya = y0 < 0 ? 0 : y0;
+    long long xb = (x0 + w < img->width) ? x0 + w : img->width;   // 
+    long long yb = (y0 + h < img->height) ? y0 + h : img->height; // 
+    if (xa >= xb || ya >= yb) {
+        return SUCCESS;
+    }
+    for (long long ty = ya / tile; ty <= (yb - 1) / tile; ty++) {
+        for (long long tx = xa / tile; tx <= (xb - 1) / tile; tx++) {
+            unsigned char* data;
+            ErrorCode ret = getTile(img, tx, ty, 0, &data);
+            if (ret != SUCCESS) {
+                return ret;
+            }
+            long long sx0 = tx * tile > xa ? tx * tile : xa;
+            long long sx1 = (tx + 1) * tile < xb ? (tx + 1) * tile : xb;
+            long long sy0 = ty * tile > ya ? ty * tile : ya;
+            long long sy1 = (ty + 1) * tile < yb ? (ty + 1) * tile : yb;
+            for (long long y = sy0; y < sy1; y++) {
+                memcpy(buf + ((size_t)(y - y0) * w + (size_t)(sx0 - x0)) * 3,
+                    data + ((size_t)(y - ty * tile) * tile + (size_t)(sx0 - tx * tile)) * 3,
+                    (size_t)(sx1 - sx0) * 3);
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ȡƬЧߴ磨ҡ±ԵƬ
+ */
+void tileExtent(const TiledImage* img, long long tx, long long ty, int* w, int* h) {
+    int tile = img->cache->tile;
+    long long rw = img->width - tx * tile;
+    long long rh = img->height - ty * tile;
+    *w = rw < tile ? (int)rw : tile;
+    *h = rh < tile ? (int)rh : tile;
+}
+
+//========== PPM ʽ뵼 ==========
+
+/**
+ * հ # ע
+ */
+int skipSpace(FILE* file) {
+    int ch = fgetc(file);
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = fgetc(file);
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = fgetc(file);
+    }
+    return ch;
+}
+
+/**
+ * ȡһǸASCII
+ * @return 0=ɹ-1=ʧ
+ */
+int readNumber(FILE* file, long long* value) {
+    int ch = skipSpace(file);
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    long long v = 0;
+    while (ch >= '0' && ch <= '9') {
+        v = v * 10 + (ch - '0');
+        ch = fgetc(file);
+    }
+    if (ch != EOF) {
+        ungetc(ch, file);
+    }
+    *value = v;
+    return 0;
+}
+
+/**
+ * ʽȡPPMP3P6ֿͼڴֻռһл
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode importPPM(const char* filename, TileCache* cache, const char* swap_path, TiledImage* img) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    char magic[3] = { 0 };
+    if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '3' && magic[1] != '6')) {
+        fclose(file);
+        return ERR_WRONG_FORMAT;
+    }
+    int binary = magic[1] == '6';
+    long long width, height, max_val;
+    if (readNumber(file, &width) != 0 || readNumber(file, &height) != 0 || readNumber(file, &max_val) != 0) {
+        fclose(file);
+        return ERR_FILE_BROKEN;
+    }
+    if (binary) {
+        fgetc(file);  // ͷĵհ
+    }
+    ErrorCode ret = createTiled(img, cache, swap_path, width, height, (int)max_val);
+    if (ret != SUCCESS) {
+        fclose(file);
+        return ret;
+    }
+
+    unsigned char* row = (unsigned char*)malloc((size_t)width * 3);
+    if (row == NULL) {
+        fclose(file);
+        return ERR_MEMORY_ALLOC;
+    }
+    int tile = cache->tile;
+    for (long long y = 0; y < height && ret == SUCCESS; y++) {
+        if (binary) {
+            if (fread(row, 1, (size_t)width * 3, file) != (size_t)width * 3) {
+                ret = ERR_FILE_BROKEN;
+                break;
+            }
+        }
+        else {
+            for (long long i = 0; i < width * 3; i++) {
+                long long v;
+                if (readNumber(file, &v) != 0 || v > max_val) {
+                    ret = ERR_FILE_BROKEN;
+                    break;
+                }
+                row[i] = (unsigned char)v;
+            }
+        }
+        // һзַƬеĸƬ
+        long long ty = y / tile;
+        for (long long tx = 0; tx < img->tiles_x && ret == SUCCESS; tx++) {
+            unsigned char* data;
+            ret = getTile(img, tx, ty, 1, &data);
+            if (ret == SUCCESS) {
+                int w, h;
+                tileExtent(img, tx, ty, &w, &h);
+                memcpy(data + (size_t)(y - ty * tile) * tile * 3, row + (size_t)tx * tile * 3, (size_t)w * 3);
+            }
+        }
+    }
+    free(row);
+    fclose(file);
+    return ret;
+}
+
+/**
+ * ʽдֿͼΪPPMP3P6дƬƴ
+ * @param binary1=P60=P3
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode exportPPM(const char* filename, TiledImage* img, int binary) {
+    FILE* file = fopen(filename, binary ? "wb" : "w");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    if (fprintf(file, "%s\n%lld %lld\n%d\n", binary ? "P6" : "P3", img->width, img->height, img->max_val) < 0) {
+        fclose(file);
+        return ERR_WRITE_FAILED;
+    }
+    unsigned char* row = (unsigned char*)malloc((size_t)img->width * 3);
+    if (row == NULL) {
+        fclose(file);
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = SUCCESS;
+    for (long long y = 0; y < img->height && ret == SUCCESS; y++) {
+        ret = readRegion(img, 0, y, (int)img->width, 1, row);
+        if (ret != SUCCESS) {
+            break;
+        }
+        if (binary) {
+            if (fwrite(row, 1, (size_t)img->width * 3, file) != (size_t)img->width * 3) {
+                ret = ERR_WRITE_FAILED;
+            }
+        }
+        else {
+            for (long long x = 0; x < img->width; x++) {
+                const unsigned char* p = row + x * 3;
+                if (fprintf(file, "%d %d %d ", p[0], p[1], p[2]) < 0) {
+                    ret = ERR_WRITE_FAILED;
+                    break;
+                }
+            }
+            if (ret == SUCCESS && fprintf(file, "\n") < 0) {
+                ret = ERR_WRITE_FAILED;
+            }
+        }
+    }
+    free(row);
+    if (fclose(file) != 0 && ret == SUCCESS) {
+        ret = ERR_WRITE_FAILED;
+    }
+    return ret;
+}
+
+//========== Ƭ halo 룬дӦƬ ==========
+
+double weight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+/**
+ * ˹ģͬ ˹ģ.csigma=5Խذɫƣ㰴 int ضۼӣ
+ * @param x1/y1/x2/y2ģ򣨺˵㣩ԭ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode tiledBlur(TiledImage* in, TiledImage* out, int radius,
+    long long x1, long long y1, long long x2, long long y2) {
+    int tile = in->cache->tile;
+    int side = 2 * radius + 1;
+    int halo_w = tile + 2 * radius;
+    double* table = (double*)malloc(sizeof(double) * side * side);
+    unsigned char* halo = (unsigned char*)malloc((size_t)halo_w * halo_w * 3);
+    if (table == NULL || halo == NULL) {
+        free(table);
+        free(halo);
+        return ERR_MEMORY_ALLOC;
+    }
+    double sum_weight = 0.0;
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dy = -radius; dy <= radius; dy++) {
+            table[(dx + radius) * side + (dy + radius)] = weight(5.0, dx, dy, &sum_weight);
+        }
+    }
+
+    ErrorCode ret = SUCCESS;
+    for (long long ty = 0; ty < out->tiles_y && ret == SUCCESS; ty++) {
+        for (long long tx = 0; tx < out->tiles_x && ret == SUCCESS; tx++) {
+            int w, h;
+            tileExtent(out, tx, ty, &w, &h);
+            long long ox = tx * tile;
+            long long oy = ty * tile;
+            ret = readRegion(in, ox - radius, oy - radius, w + 2 * radius, h + 2 * radius, halo);
+            if (ret != SUCCESS) {
+                break;
+            }
+            unsigned char* dst;
+            ret = getTile(out, tx, ty, 1, &dst);
+            if (ret != SUCCESS) {
+                break;
+            }
+            int stride = w + 2 * radius;
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    const unsigned char* center = halo + ((size_t)(y + radius) * stride + (x + radius)) * 3;
+                    unsigned char* d = dst + ((size_t)y * tile + x) * 3;
+                    long long gx = ox + x;
+                    long long gy = oy + y;
+                    if (gx < x1 || gx > x2 || gy < y1 || gy > y2) {
+                        d[0] = center[0];
+                        d[1] = center[1];
+                        d[2] = center[2];
+                        continue;
+                    }
+                    int r = 0, g = 0, b = 0;
+                    const double* wt = table;
+                    for (int dx = -radius; dx <= radius; dx++) {
+                        for (int dy = -radius; dy <= radius; dy++, wt++) {
+                            const unsigned char* s = center + ((long)dy * stride + dx) * 3;
+                            r += *wt * s[0];
+                            g += *wt * s[1];
+                            b += *wt * s[2];
+                        }
+                    }
+                    d[0] = (unsigned char)(r / sum_weight);
+                    d[1] = (unsigned char)(g / sum_weight);
+                    d[2] = (unsigned char)(b / sum_weight);
+                }
+            }
+        }
+    }
+    free(table);
+    free(halo);
+    return ret;
+}
+
+/**
+ * SobelԵ⣨ͬ sobelԵ.cBT.601 Ҷȣͼúڣ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode tiledSobel(TiledImage* in, TiledImage* out, int threshold) {
+    if (in->width < 3 || in->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int tile = in->cache->tile;
+    int halo_w = tile + 2;
+    unsigned char* halo = (unsigned char*)malloc((size_t)halo_w * halo_w * 3);
+    unsigned char* gray = (unsigned char*)malloc((size_t)halo_w * halo_w);
+    if (halo == NULL || gray == NULL) {
+        free(halo);
+        free(gray);
+        return ERR_MEMORY_ALLOC;
+    }
+    int t2 = threshold * threshold;
+    ErrorCode ret = SUCCESS;
+    for (long long ty = 0; ty < out->tiles_y && ret == SUCCESS; ty++) {
+        for (long long tx = 0; tx < out->tiles_x && ret == SUCCESS; tx++) {
+            int w, h;
+            tileExtent(out, tx, ty, &w, &h);
+            long long ox = tx * tile;
+            long long oy = ty * tile;
+            int stride = w + 2;
+            ret = readRegion(in, ox - 1, oy - 1, stride, h + 2, halo);
+            if (ret != SUCCESS) {
+                break;
+            }
+            colorBytesToGray(halo, gray, (size_t)stride * (h + 2), LUMA_BT601);  //  sobelԵ.c ͬĶ BT.601
+            unsigned char* dst;
+            ret = getTile(out, tx, ty, 1, &dst);
+            if (ret != SUCCESS) {
+                break;
+            }
+            for (int y = 0; y < h; y++) {
+                long long gy = oy + y;
+                const unsigned char* u = gray + (size_t)y * stride + 1;
+                const unsigned char* m = u + stride;
+                const unsigned char* dn = m + stride;
+                unsigned char* d = dst + (size_t)y * tile * 3;
+                for (int x = 0; x < w; x++) {
+                    long long gx = ox + x;
+                    int edge = 0;
+                    if (gx > 0 && gx < in->width - 1 && gy > 0 && gy < in->height - 1) {
+                        int sx = (u[x + 1] - u[x - 1]) + 2 * (m[x + 1] - m[x - 1]) + (dn[x + 1] - dn[x - 1]);
+                        int sy = (dn[x - 1] + 2 * dn[x] + dn[x + 1]) - (u[x - 1] + 2 * u[x] + u[x + 1]);
+                        edge = (sx * sx + sy * sy >= t2) ? 255 : 0;
+                    }
+                    d[x * 3] = d[x * 3 + 1] = d[x * 3 + 2] = (unsigned char)edge;
+                }
+            }
+        }
+    }
+    free(halo);
+    free(gray);
+    return ret;
+}
+
+/**
+ * üÿƬֻԴͼжӦĴ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode tiledCrop(TiledImage* in, TiledImage* out, long long x0, long long y0) {
+    int tile = in->cache->tile;
+    unsigned char* buf = (unsigned char*)malloc((size_t)tile * tile * 3);
+    if (buf == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = SUCCESS;
+    for (long long ty = 0; ty < out->tiles_y && ret == SUCCESS; ty++) {
+        for (long long tx = 0; tx < out->tiles_x && ret == SUCCESS; tx++) {
+            int w, h;
+            tileExtent(out, tx, ty, &w, &h);
+            ret = readRegion(in, x0 + tx * tile, y0 + ty * tile, w, h, buf);
+            unsigned char* dst;
+            if (ret == SUCCESS) {
+                ret = getTile(out, tx, ty, 1, &dst);
+            }
+            if (ret == SUCCESS) {
+                for (int y = 0; y < h; y++) {
+                    memcpy(dst + (size_t)y * tile * 3, buf + (size_t)y * w * 3, (size_t)w * 3);
+                }
+            }
+        }
+    }
+    free(buf);
+    return ret;
+}
+
+/**
+ * תãƬ (tx,ty) ԴͼƬ (ty,tx) ת
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode tiledTranspose(TiledImage* in, TiledImage* out) {
+    int tile = in->cache->tile;
+    unsigned char* buf = (unsigned char*)malloc((size_t)tile * tile * 3);
+    if (buf == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = SUCCESS;
+    for (long long ty = 0; ty < out->tiles_y && ret == SUCCESS; ty++) {
+        for (long long tx = 0; tx < out->tiles_x && ret == SUCCESS; tx++) {
+            int w, h;
+            tileExtent(out, tx, ty, &w, &h);
+            // Դx Ӧ yy Ӧ x
+            ret = readRegion(in, ty * tile, tx * tile, h, w, buf);
+            unsigned char* dst;
+            if (ret == SUCCESS) {
+                ret = getTile(out, tx, ty, 1, &dst);
+            }
+            if (ret == SUCCESS) {
+                for (int y = 0; y < h; y++) {
+                    for (int x = 0; x < w; x++) {
+                        const unsigned char* s = buf + ((size_t)x * h + y) * 3;
+                        unsigned char* d = dst + ((size_t)y * tile + x) * 3;
+                        d[0] = s[0];
+                        d[1] = s[1];
+                        d[2] = s[2];
+                    }
+                }
+            }
+        }
+    }
+    free(buf);
+    return ret;
+}
+
+//==========  ==========
+
+void printUsage(const char* prog) {
+    printf("÷%s <> <.ppm> <.ppm> [] [ѡ]\n", prog);
+    printf("  blur R [x1 y1 x2 y2]   ˹ģ뾶 Rֻģ\n");
+    printf("  sobel T                SobelԵ⣬ֵ T\n");
+    printf("  crop X Y W H           ü\n");
+    printf("  transpose              ת\n");
+    printf("ѡ\n");
+    printf("  --cache MB             ƬޣĬ 2560 ʾֻһƬ\n");
+    printf("  --tile N               Ƭ߳Ĭ 256\n");
+    printf("  --p3                    P3Ĭ P6ͼ P3 ı\n");
+}
+
+/**
+ * ʽгƬ -> Ƭ -> ʽд
+ * ֵڴ =  + һ halo  + һ I/O 壬ͼС޹
+ */
+int main(int argc, char* argv[]) {
+    // 1. 
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    const char* op = argv[1];
+    const char* input_path = argv[2];
+    const char* output_path = argv[3];
+    long long params[5] = { 0, 0, 0, 0, 0 };
+    int param_count = 0;
+    long long cache_mb = 256;
+    int tile = 256;
+    int binary = 1;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_mb = atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            tile = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--p3") == 0) {
+            binary = 0;
+        }
+        else if (param_count < 5) {
+            params[param_count++] = atoll(argv[i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+    }
+    int valid = tile >= 8 && tile <= 4096 && cache_mb >= 0;
+    if (strcmp(op, "blur") == 0) {
+        valid = valid && (param_count == 1 || param_count == 5) && params[0] >= 0 && params[0] <= 64;
+    }
+    else if (strcmp(op, "sobel") == 0) {
+        valid = valid && param_count == 1 && params[0] >= 0 && params[0] <= 255;
+    }
+    else if (strcmp(op, "crop") == 0) {
+        valid = valid && param_count == 4;
+    }
+    else if (strcmp(op, "transpose") == 0) {
+        valid = valid && param_count == 0;
+    }
+    else {
+        valid = 0;
+    }
+    if (!valid) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+
+    // 2. ʼ棬ļļԱ
+    TileCache cache;
+    ErrorCode ret = initCache(&cache, tile, (size_t)cache_mb * 1024 * 1024);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        return ret;
+    }
+    char in_swap[512], out_swap[512];
+    snprintf(in_swap, sizeof(in_swap), "%s.in.tiles", output_path);
+    snprintf(out_swap, sizeof(out_swap), "%s.out.tiles", output_path);
+
+    // 3. 
+    TiledImage in, out;
+    memset(&in, 0, sizeof(TiledImage));
+    memset(&out, 0, sizeof(TiledImage));
+    printf("зͼ%sƬ %d %lld MB...\n", input_path, tile, cache_mb);
+    ret = importPPM(input_path, &cache, in_swap, &in);
+    if (ret == SUCCESS) {
+        printf("зɣ%lld x %lld%lld x %lld Ƭ\n", in.width, in.height, in.tiles_x, in.tiles_y);
+    }
+
+    // 4. 
+    if (ret == SUCCESS) {
+        if (strcmp(op, "blur") == 0) {
+            long long x1 = 0, y1 = 0, x2 = in.width - 1, y2 = in.height - 1;
+            if (param_count == 5) {
+                x1 = params[1];
+                y1 = params[2];
+                x2 = params[3];
+                y2 = params[4];
+            }
+            ret = createTiled(&out, &cache, out_swap, in.width, in.height, in.max_val);
+            if (ret == SUCCESS) {
+                ret = tiledBlur(&in, &out, (int)params[0], x1, y1, x2, y2);
+            }
+        }
+        else if (strcmp(op, "sobel") == 0) {
+            ret = createTiled(&out, &cache, out_swap, in.width, in.height, 255);
+            if (ret == SUCCESS) {
+                ret = tiledSobel(&in, &out, (int)params[0]);
+            }
+        }
+        else if (strcmp(op, "crop") == 0) {
+            if (params[0] < 0 || params[1] < 0 || params[2] <= 0 || params[3] <= 0 ||
+                params[0] + params[2] > in.width || params[1] + params[3] > in.height) {
+                ret = ERR_CROP_OUT_OF_BOUNDS;
+            }
+            else {
+                ret = createTiled(&out, &cache, out_swap, params[2], params[3], in.max_val);
+                if (ret == SUCCESS) {
+                    ret = tiledCrop(&in, &out, params[0], params[1]);
+                }
+            }
+        }
+        else {
+            ret = createTiled(&out, &cache, out_swap, in.height, in.width, in.max_val);
+            if (ret == SUCCESS) {
+                ret = tiledTranspose(&in, &out);
+            }
+        }
+    }
+
+    // 5. д
+    if (ret == SUCCESS) {
+        printf("ڱ棺%s...\n", output_path);
+        ret = exportPPM(output_path, &out, binary);
+    }
+
+    long long peak = (long long)cache.used * (long long)cache.tile_bytes;
+    printf("棺 %lldδ %lldд %lldƬڴֵ %.1f MB\n",
+        cache.hits, cache.misses, cache.writebacks, peak / (1024.0 * 1024.0));
+
+    // 6. 
+    closeTiled(&in);
+    closeTiled(&out);
+    freeCache(&cache);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        return ret;
+    }
+    printf("ɹ\n");
+    return SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,712 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 64 λļƫ
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+/*
+ * ֿļʽ.ptlС򣩣
+ *   ļͷ 40 ֽڣ
+ *     "PTL1"  width(u64)  height(u64)  max_val(u32)  tile(u32)  compression(u32)  (u32)
+ *   Ƭtiles_x * tiles_y ȣÿ 16 ֽڣ
+ *     offset(u64)  size(u32)  flags(u321=LZ ѹ)
+ *   ƬݣÿƬΪЧ򣨱ԵƬ RGB ֽڣÿ 3 ֽ
+ * ȡʱֻཻ֮ƬʱͼС޹
+ */
+#define PTL_HEADER_SIZE 40
+#define PTL_ENTRY_SIZE 16
+#define PTL_FLAG_LZ 1
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_CROP_OUT_OF_BOUNDS,
+    ERR_BAD_ARGUMENT
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "ļʽȷ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "󣺲ü򳬳ͼ߽",
+    "вϷ"
+};
+
+// Ѵ򿪵ķֿļ
+typedef struct {
+    FILE* file;
+    long long width;
+    long long height;
+    int max_val;
+    int tile;               // Ƭ߳
+    int compression;        // дʱǷѹ
+    long long tiles_x;
+    long long tiles_y;
+    unsigned char* packed;  // ѹݻ
+    long long tiles_read;   // ѶƬͳã
+} TiledFile;
+
+//========== С˶д ==========
+
+void putU32(unsigned char* p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+void putU64(unsigned char* p, unsigned long long v) {
+    putU32(p, (unsigned int)v);
+    putU32(p + 4, (unsigned int)(v >> 32));
+}
+
+unsigned int getU32(const unsigned char* p) {
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+unsigned long long getU64(const unsigned char* p) {
+    return (unsigned long long)getU32(p) | ((unsigned long long)getU32(p + 4) << 32);
+}
+
+//========== LZ ѹLZ4 Ŀʽtoken +  + 2 ֽƫ + ƥ䳤ȣ ==========
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+
+unsigned int read32(const unsigned char* p) {
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/**
+ * д볤ȵչֽڣ 15 Ĳְ 255 ֶΣ
+ * @return дλãռ䲻㷵 -1
+ */
+int putLength(unsigned char* dst, int op, int cap, int extra) {
+    while (extra >= 255) {
+        if (op >= cap) {
+            return -1;
+        }
+        dst[op++] = 255;
+        extra -= 255;
+    }
+    if (op >= cap) {
+        return -1;
+    }
+    dst[op++] = (unsigned char)extra;
+    return op;
+}
+
+/**
+ * дһУ [anchor, anchor+lit_len) (offset, match_len) ƥ䣻match_len=0 ʾβ
+ * @return дλãռ䲻㷵 -1
+ */
+int putSequence(unsigned char* dst, int op, int cap, const unsigned char* lit, int lit_len, int offset, int match_len) {
+    if (op >= cap) {
+        return -1;
+    }
+    int token_pos = op++;
+    int lit_code = lit_len < 15 ? lit_len : 15;
+    int match_code = 0;
+    if (match_len > 0) {
+        match_code = (match_len - LZ_MIN_MATCH) < 15 ? match_len - LZ_MIN_MATCH : 15;
+    }
+    dst[token_pos] = (unsigned char)((lit_code << 4) | match_code);
+    if (lit_code == 15 && (op = putLength(dst, op, cap, lit_len - 15)) < 0) {
+        return -1;
+    }
+    if (op + lit_len > cap) {
+        return -1;
+    }
+    memcpy(dst + op, lit, lit_len);
+    op += lit_len;
+    if (match_len == 0) {
+        return op;
+    }
+    if (op + 2 > cap) {
+        return -1;
+    }
+    dst[op++] = (unsigned char)offset;
+    dst[op++] = (unsigned char)(offset >> 8);
+    if (match_code == 15 && (op = putLength(dst, op, cap, match_len - LZ_MIN_MATCH - 15)) < 0) {
+        return -1;
+    }
+    return op;
+}
+
+/**
+ * ̰ LZ ѹ
+ * @param table1 << LZ_HASH_BITS  int Ĺϣ
+ * @return ѹֽԭСʱ -1÷ԭ洢
+ */
+int lzCompress(const unsigned char* src, int n, unsigned char* dst, int* table) {
+    int cap = n - 1;
+    int ip = 0, anchor = 0, op = 0;
+    for (int i = 0; i < (1 << LZ_HASH_BITS); i++) {
+        table[i] = -1;
+    }
+    while (ip + LZ_MIN_MATCH <= n) {
+        unsigned int v = read32(src + ip);
+        unsigned int h = (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+        int ref = table[h];
+        table[h] = ip;
+        if (ref < 0 || ip - ref > 65535 || read32(src + ref) != v) {
+            ip++;
+            continue;
+        }
+        int len = LZ_MIN_MATCH;
+        while (ip + len < n && src[ref + len] == src[ip + len]) {
+            len++;
+        }
+        op = putSequence(dst, op, cap, src + anchor, ip - anchor, ip - ref, len);
+        if (op < 0) {
+            return -1;
+        }
+        ip += len;
+        anchor = ip;
+    }
+    op = putSequence(dst, op, cap, src + anchor, n - anchor, 0, 0);
+    return op;
+}
+
+/**
+ * ѹжд߽飬ݲԽ
+ * @return ѹֽ𻵷 -1
+ */
+int lzDecompress(const unsigned char* src, int n, unsigned char* dst, int cap) {
+    int ip = 0, op = 0;
+    while (ip < n) {
+        int token = src[ip++];
+        int lit_len = token >> 4;
+        if (lit_len == 15) {
+            int b;
+            do {
+                if (ip >= n) {
+                    return -1;
+                }
+                b = src[ip++];
+                lit_len += b;
+            } while (b == 255);
+        }
+        if (ip + lit_len > n || op + lit_len > cap) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == n) {
+            break;  // һֻ
+        }
+        if (ip + 2 > n) {
+            return -1;
+        }
+        int offset = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        int match_len = (token & 15) + LZ_MIN_MATCH;
+        if ((token & 15) == 15) {
+            int b;
+            do {
+                if (ip >= n) {
+                    return -1;
+                }
+                b = src[ip++];
+                match_len += b;
+            } while (b == 255);
+        }
+        if (offset == 0 || offset > op || op + match_len > cap) {
+            return -1;
+        }
+        // ֽڸƣصoffset < match_len ʱظǰݣ
+        for (int i = 0; i < match_len; i++) {
+            dst[op + i] = dst[op - offset + i];
+        }
+        op += match_len;
+    }
+    return op;
+}
+
+//========== PPM ʽд ==========
+
+/**
+ * հ # ע
+ */
+int skipSpace(FILE* file) {
+    int ch = fgetc(file);
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = fgetc(file);
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = fgetc(file);
+    }
+    return ch;
+}
+
+/**
+ * ȡһǸASCII
+ * @return 0=ɹ-1=ʧ
+ */
+int readNumber(FILE* file, long long* value) {
+    int ch = skipSpace(file);
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    long long v = 0;
+    while (ch >= '0' && ch <= '9') {
+        v = v * 10 + (ch - '0');
+        ch = fgetc(file);
+    }
+    if (ch != EOF) {
+        ungetc(ch, file);
+    }
+    *value = v;
+    return 0;
+}
+
+/**
+ * PPMļͷP3P6
+ * @param binary 1=P60=P3
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readPPMHeader(FILE* file, long long* width, long long* height, int* max_val, int* binary) {
+    char magic[2];
+    if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '3' && magic[1] != '6')) {
+        return ERR_WRONG_FORMAT;
+    }
+    *binary = magic[1] == '6';
+    long long mv;
+    if (readNumber(file, width) != 0 || readNumber(file, height) != 0 || readNumber(file, &mv) != 0) {
+        return ERR_FILE_BROKEN;
+    }
+    if (*width <= 0 || *height <= 0 || mv <= 0 || mv > 255) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    *max_val = (int)mv;
+    if (*binary) {
+        fgetc(file);  // ͷĵհ
+    }
+    return SUCCESS;
+}
+
+/**
+ * һ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readPPMRow(FILE* file, int binary, long long width, int max_val, unsigned char* row) {
+    if (binary) {
+        return fread(row, 1, (size_t)width * 3, file) == (size_t)width * 3 ? SUCCESS : ERR_FILE_BROKEN;
+    }
+    for (long long i = 0; i < width * 3; i++) {
+        long long v;
+        if (readNumber(file, &v) != 0 || v > max_val) {
+            return ERR_FILE_BROKEN;
+        }
+        row[i] = (unsigned char)v;
+    }
+    return SUCCESS;
+}
+
+/**
+ * дһ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writePPMRow(FILE* file, int binary, long long width, const unsigned char* row) {
+    if (binary) {
+        return fwrite(row, 1, (size_t)width * 3, file) == (size_t)width * 3 ? SUCCESS : ERR_WRITE_FAILED;
+    }
+    for (long long x = 0; x < width; x++) {
+        if (fprintf(file, "%d %d %d ", row[x * 3], row[x * 3 + 1], row[x * 3 + 2]) < 0) {
+            return ERR_WRITE_FAILED;
+        }
+    }
+    return fprintf(file, "\n") < 0 ? ERR_WRITE_FAILED : SUCCESS;
+}
+
+//========== ֿļ ==========
+
+/**
+ * PPMתΪֿļƬʽڴֻռһ tile иߵ
+ * @param tileƬ߳
+ * @param compression1=ÿƬ LZ ѹѹСʱԭ棩
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode packTiled(const char* ppm_path, const char* tiled_path, int tile, int compression) {
+    FILE* in = fopen(ppm_path, "rb");
+    if (in == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    long long width, height;
+    int max_val, binary;
+    ErrorCode ret = readPPMHeader(in, &width, &height, &max_val, &binary);
+    if (ret != SUCCESS) {
+        fclose(in);
+        return ret;
+    }
+    FILE* out = fopen(tiled_path, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return ERR_WRITE_FAILED;
+    }
+
+    long long tiles_x = (width + tile - 1) / tile;
+    long long tiles_y = (height + tile - 1) / tile;
+    size_t tile_bytes = (size_t)tile * tile * 3;
+    unsigned char* strip = (unsigned char*)malloc((size_t)width * tile * 3);
+    unsigned char* raw = (unsigned char*)malloc(tile_bytes);
+    unsigned char* packed = (unsigned char*)malloc(tile_bytes);
+    unsigned char* index = (unsigned char*)calloc((size_t)(tiles_x * tiles_y), PTL_ENTRY_SIZE);
+    int* table = (int*)malloc(sizeof(int) << LZ_HASH_BITS);
+    if (strip == NULL || raw == NULL || packed == NULL || index == NULL || table == NULL) {
+        ret = ERR_MEMORY_ALLOC;
+    }
+
+    // ļͷռλдƬ
+    unsigned char header[PTL_HEADER_SIZE] = { 'P', 'T', 'L', '1' };
+    putU64(header + 4, (unsigned long long)width);
+    putU64(header + 12, (unsigned long long)height);
+    putU32(header + 20, (unsigned int)max_val);
+    putU32(header + 24, (unsigned int)tile);
+    putU32(header + 28, (unsigned int)compression);
+    if (ret == SUCCESS && fwrite(header, 1, PTL_HEADER_SIZE, out) != PTL_HEADER_SIZE) {
+        ret = ERR_WRITE_FAILED;
+    }
+    if (ret == SUCCESS &&
+        fwrite(index, PTL_ENTRY_SIZE, (size_t)(tiles_x * tiles_y), out) != (size_t)(tiles_x * tiles_y)) {
+        ret = ERR_WRITE_FAILED;
+    }
+    long long offset = PTL_HEADER_SIZE + tiles_x * tiles_y * PTL_ENTRY_SIZE;
+
+    for (long long ty = 0; ty < tiles_y && ret == SUCCESS; ty++) {
+        int h = (int)(height - ty * tile < tile ? height - ty * tile : tile);
+        for (int y = 0; y < h && ret == SUCCESS; y++) {
+            ret = readPPMRow(in, binary, width, max_val, strip + (size_t)y * width * 3);
+        }
+        for (long long tx = 0; tx < tiles_x && ret == SUCCESS; tx++) {
+            int w = (int)(width - tx * tile < tile ? width - tx * tile : tile);
+            for (int y = 0; y < h; y++) {
+                memcpy(raw + (size_t)y * w * 3, strip + ((size_t)y * width + (size_t)tx * tile) * 3, (size_t)w * 3);
+            }
+            int size = w * h * 3;
+            const unsigned char* data = raw;
+            unsigned int flags = 0;
+            if (compression) {
+                int packed_size = lzCompress(raw, size, packed, table);
+                if (packed_size > 0) {
+                    data = packed;
+                    size = packed_size;
+                    flags = PTL_FLAG_LZ;
+                }
+            }
+            if (fwrite(data, 1, size, out) != (size_t)size) {
+                ret = ERR_WRITE_FAILED;
+                break;
+            }
+            unsigned char* entry = index + (size_t)(ty * tiles_x + tx) * PTL_ENTRY_SIZE;
+            putU64(entry, (unsigned long long)offset);
+            putU32(entry + 8, (unsigned int)size);
+            putU32(entry + 12, flags);
+            offset += size;
+        }
+    }
+
+    if (ret == SUCCESS) {
+        if (fseek64(out, PTL_HEADER_SIZE, SEEK_SET) != 0 ||
+            fwrite(index, PTL_ENTRY_SIZE, (size_t)(tiles_x * tiles_y), out) != (size_t)(tiles_x * tiles_y)) {
+            ret = ERR_WRITE_FAILED;
+        }
+    }
+    free(strip);
+    free(raw);
+    free(packed);
+    free(index);
+    free(table);
+    fclose(in);
+    if (fclose(out) != 0 && ret == SUCCESS) {
+        ret = ERR_WRITE_FAILED;
+    }
+    return ret;
+}
+
+/**
+ * 򿪷ֿļֻļͷȡ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode openTiled(const char* path, TiledFile* tf) {
+    memset(tf, 0, sizeof(TiledFile));
+    tf->file = fopen(path, "rb");
+    if (tf->file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    unsigned char header[PTL_HEADER_SIZE];
+    if (fread(header, 1, PTL_HEADER_SIZE, tf->file) != PTL_HEADER_SIZE || memcmp(header, "PTL1", 4) != 0) {
+        fclose(tf->file);
+        tf->file = NULL;
+        return ERR_WRONG_FORMAT;
+    }
+    tf->width = (long long)getU64(header + 4);
+    tf->height = (long long)getU64(header + 12);
+    tf->max_val = (int)getU32(header + 20);
+    tf->tile = (int)getU32(header + 24);
+    tf->compression = (int)getU32(header + 28);
+    if (tf->width <= 0 || tf->height <= 0 || tf->max_val <= 0 || tf->max_val > 255 ||
+        tf->tile < 1 || tf->tile > 4096) {
+        fclose(tf->file);
+        tf->file = NULL;
+        return ERR_ILLEGAL_SIZE;
+    }
+    tf->tiles_x = (tf->width + tf->tile - 1) / tf->tile;
+    tf->tiles_y = (tf->height + tf->tile - 1) / tf->tile;
+    tf->packed = (unsigned char*)malloc((size_t)tf->tile * tf->tile * 3);
+    if (tf->packed == NULL) {
+        fclose(tf->file);
+        tf->file = NULL;
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+void closeTiled(TiledFile* tf) {
+    if (tf->file != NULL) {
+        fclose(tf->file);
+        tf->file = NULL;
+    }
+    free(tf->packed);
+    tf->packed = NULL;
+}
+
+/**
+ * һƬЧпΪƬʵʿȣ
+ * @param w/hƬʵʳߴ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readTile(TiledFile* tf, long long tx, long long ty, unsigned char* dst, int* w, int* h) {
+    *w = (int)(tf->width - tx * tf->tile < tf->tile ? tf->width - tx * tf->tile : tf->tile);
+    *h = (int)(tf->height - ty * tf->tile < tf->tile ? tf->height - ty * tf->tile : tf->tile);
+    int raw_size = *w * *h * 3;
+
+    unsigned char entry[PTL_ENTRY_SIZE];
+    long long pos = PTL_HEADER_SIZE + (ty * tf->tiles_x + tx) * PTL_ENTRY_SIZE;
+    if (fseek64(tf->file, pos, SEEK_SET) != 0 || fread(entry, 1, PTL_ENTRY_SIZE, tf->file) != PTL_ENTRY_SIZE) {
+        return ERR_FILE_BROKEN;
+    }
+    long long offset = (long long)getU64(entry);
+    int size = (int)getU32(entry + 8);
+    unsigned int flags = getU32(entry + 12);
+    if (size <= 0 || size > raw_size || (!(flags & PTL_FLAG_LZ) && size != raw_size)) {
+        return ERR_FILE_BROKEN;
+    }
+    if (fseek64(tf->file, offset, SEEK_SET) != 0) {
+        return ERR_FILE_BROKEN;
+    }
+    unsigned char* target = (flags & PTL_FLAG_LZ) ? tf->packed : dst;
+    if (fread(target, 1, size, tf->file) != (size_t)size) {
+        return ERR_FILE_BROKEN;
+    }
+    if ((flags & PTL_FLAG_LZ) && lzDecompress(tf->packed, size, dst, raw_size) != raw_size) {
+        return ERR_FILE_BROKEN;
+    }
+    tf->tiles_read++;
+    return SUCCESS;
+}
+
+/**
+ * ȡֻཻƬ
+ * @param bufw*h*3 ֽڣ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readRegion(TiledFile* tf, long long x0, long long y0, long long w, long long h, unsigned char* buf) {
+    if (x0 < 0 || y0 < 0 || w <= 0 || h <= 0 || x0 + w > tf->width || y0 + h > tf->height) {
+        return ERR_CROP_OUT_OF_BOUNDS;
+    }
+    int tile = tf->tile;
+    unsigned char* tile_buf = (unsigned char*)malloc((size_t)tile * tile * 3);
+    if (tile_buf == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = SUCCESS;
+    for (long long ty = y0 / tile; ty <= (y0 + h - 1) / tile && ret == SUCCESS; ty++) {
+        for (long long tx = x0 / tile; tx <= (x0 + w - 1) / tile && ret == SUCCESS; tx++) {
+            int tw, th;
+            ret = readTile(tf, tx, ty, tile_buf, &tw, &th);
+            if (ret != SUCCESS) {
+                break;
+            }
+            long long sx0 = tx * tile > x0 ? tx * tile : x0;
+            long long sx1 = tx * tile + tw < x0 + w ? tx * tile + tw : x0 + w;
+            long long sy0 = ty * tile > y0 ? ty * tile : y0;
+            long long sy1 = ty * tile + th < y0 + h ? ty * tile + th : y0 + h;
+            for (long long y = sy0; y < sy1; y++) {
+                memcpy(buf + ((size_t)(y - y0) * w + (size_t)(sx0 - x0)) * 3,
+                    tile_buf + ((size_t)(y - ty * tile) * tw + (size_t)(sx0 - tx * tile)) * 3,
+                    (size_t)(sx1 - sx0) * 3);
+            }
+        }
+    }
+    free(tile_buf);
+    return ret;
+}
+
+/**
+ * ѷֿļһдPPMʱͼ񣩣Ƭзȡ
+ * @param binary1=P60=P3
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode exportRegion(TiledFile* tf, const char* ppm_path, long long x0, long long y0, long long w, long long h, int binary) {
+    if (x0 < 0 || y0 < 0 || w <= 0 || h <= 0 || x0 + w > tf->width || y0 + h > tf->height) {
+        return ERR_CROP_OUT_OF_BOUNDS;
+    }
+    FILE* out = fopen(ppm_path, binary ? "wb" : "w");
+    if (out == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    ErrorCode ret = SUCCESS;
+    if (fprintf(out, "%s\n%lld %lld\n%d\n", binary ? "P6" : "P3", w, h, tf->max_val) < 0) {
+        ret = ERR_WRITE_FAILED;
+    }
+    int tile = tf->tile;
+    unsigned char* strip = (unsigned char*)malloc((size_t)w * tile * 3);
+    if (strip == NULL) {
+        ret = ERR_MEMORY_ALLOC;
+    }
+    long long y = y0;
+    while (y < y0 + h && ret == SUCCESS) {
+        // ÿȡһƬ߽磬֤ÿƬֻһ
+        long long next = (y / tile + 1) * tile;
+        long long rows = (next < y0 + h ? next : y0 + h) - y;
+        ret = readRegion(tf, x0, y, w, rows, strip);
+        for (long long r = 0; r < rows && ret == SUCCESS; r++) {
+            ret = writePPMRow(out, binary, w, strip + (size_t)r * w * 3);
+        }
+        y += rows;
+    }
+    free(strip);
+    if (fclose(out) != 0 && ret == SUCCESS) {
+        ret = ERR_WRITE_FAILED;
+    }
+    return ret;
+}
+
+//==========  ==========
+
+void printUsage(const char* prog) {
+    printf("÷\n");
+    printf("  %s pack <.ppm> <.ptl> [--tile N] [--lz]   PPM תֿļ\n", prog);
+    printf("  %s unpack <.ptl> <.ppm> [--p3]           ֿļת PPM\n", prog);
+    printf("  %s crop <.ptl> <.ppm> X Y W H [--p3]     ֻȡཻƬü\n", prog);
+    printf("  %s info <.ptl>                               ӡļͷ\n", prog);
+}
+
+double elapsedMs(clock_t start) {
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[]) {
+    // 1. 
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    const char* op = argv[1];
+    const char* input_path = argv[2];
+    const char* output_path = argc > 3 ? argv[3] : NULL;
+    int tile = 256;
+    int compression = 0;
+    int binary = 1;
+    long long params[4] = { 0, 0, 0, 0 };
+    int param_count = 0;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            tile = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--lz") == 0) {
+            compression = 1;
+        }
+        else if (strcmp(argv[i], "--p3") == 0) {
+            binary = 0;
+        }
+        else if (param_count < 4) {
+            params[param_count++] = atoll(argv[i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+    }
+
+    ErrorCode ret;
+    clock_t start = clock();
+    // 2. ִ
+    if (strcmp(op, "pack") == 0 && output_path != NULL && param_count == 0) {
+        if (tile < 8 || tile > 4096) {
+            printUsage(argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+        ret = packTiled(input_path, output_path, tile, compression);
+        if (ret == SUCCESS) {
+            printf("תɣ%s -> %sƬ %d%s%.1f ms\n", input_path, output_path, tile,
+                compression ? "LZ ѹ" : "", elapsedMs(start));
+        }
+    }
+    else if ((strcmp(op, "unpack") == 0 && output_path != NULL && param_count == 0) ||
+        (strcmp(op, "crop") == 0 && output_path != NULL && param_count == 4) ||
+        (strcmp(op, "info") == 0 && output_path == NULL)) {
+        TiledFile tf;
+        ret = openTiled(input_path, &tf);
+        if (ret == SUCCESS) {
+            if (strcmp(op, "info") == 0) {
+                printf("%lld x %lldֵ %dƬ %d%lld x %lld %s\n", tf.width, tf.height,
+                    tf.max_val, tf.tile, tf.tiles_x, tf.tiles_y, tf.compression ? "LZ ѹ" : "δѹ");
+            }
+            else if (strcmp(op, "unpack") == 0) {
+                ret = exportRegion(&tf, output_path, 0, 0, tf.width, tf.height, binary);
+            }
+            else {
+                ret = exportRegion(&tf, output_path, params[0], params[1], params[2], params[3], binary);
+            }
+            if (ret == SUCCESS && strcmp(op, "info") != 0) {
+                printf("д%sȡ %lld / %lld Ƭ%.1f ms\n", output_path, tf.tiles_read,
+                    tf.tiles_x * tf.tiles_y, elapsedMs(start));
+            }
+            closeTiled(&tf);
+        }
+    }
+    else {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        return ret;
+    }
+    return SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,900 @@
+/**
+ * 棺ˡint ƽ棬˵ĴСѡרŵʵ
+ *
+ *  convKernelInit ʱһΣ
+ *   ɷ    ΪһгһУSobelPrewittScharr˹ʱȺһάN*N γ˷Ϊ 2N 
+ *   ҶԳ  ÿйжԳƣ˹˹񻯣ʱɶӺٳˣ˷
+ *   ҷԳƣSobel/Prewitt/Scharr  Gxʱɶٳˣ
+ *   ȫ 0    ֱSobel  Gy мУ
+ * 3x35x57x7 ͨǿ볣߳õרŰ汾ϵȿֲ飬
+ * ڲѭȫչ x ѭɱgcc -O3x86 ϼ -mavx2  32 λ˷
+ * ߳ CONV_MAX_SIZEͨð汾ϵ㡢x ڲ㣬ϵһ˼ӣ
+ * ɷĴˣ˶ģͷ PSF ȣ FFT ֿصӣ Ҷ任.h
+ * ֽ߳ڵһõʱʵõļֱ֮ӶȡconvFftCrossoverֱӾֵͬ
+ * ͼɱ߽緽ʽƱԵѭ ConvBorderĬϰ 0 ƣ
+ * ȿܲñߵĻ壬ڲѭûκԽжϣ߽緽ʽֻӰ첹һ
+ * Ϊ intdivisor > 1 ʱ divisor 룬ΪԭʼۼֵݶȿΪضϵطΧɵ÷
+ * ۼֵֵ * ϵֵ֮ͣ int Χڣ convKernelFits 顣
+ * ÷
+ *   ConvKernel k;
+ *   convKernelInit(&k, 3, (const int[]){ -1, 0, 1, -2, 0, 2, -1, 0, 1 }, 1);
+ *   convPlane(src, dst, width, height, &k);
+ */
+#ifndef CONV_ENGINE_H
+#define CONV_ENGINE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "Ҷ任.h"
+
+#define CONV_MAX_SIZE 127
+
+#if defined(_MSC_VER)
+#define CONV_FORCE_INLINE static __forceinline
+#else
+#define CONV_FORCE_INLINE static inline __attribute__((always_inline))
+#endif
+
+typedef struct {
+    int size;                                 // ߳ CONV_MAX_SIZE
+    int taps[CONV_MAX_SIZE * CONV_MAX_SIZE];  // ϵ
+    int divisor;                              // 1=
+    //  convKernelInit õ
+    int separable;                            // taps[y][x] == col[y] * row[x]
+    int row[CONV_MAX_SIZE];
+    int col[CONV_MAX_SIZE];
+    int row_symmetry[CONV_MAX_SIZE];          // ÿУ1=ҶԳƣ-1=ҷԳƣ0=һ㣬2=ȫ 0
+    int row_taps_symmetry;                    // ɷʱ row ĶԳԣͬϣ
+    int col_taps_symmetry;                    // ɷʱ col ĶԳ
+    int nonzero;                              //  0 ϵͨð汾 0 ϵֱӾĴȣ
+} ConvKernel;
+
+// һάϵĶԳԣ2=ȫ 01=Գƣ-1=ԳƣΪ 00=һ
+static inline int convSymmetry(const int* t, int n) {
+    int zero = 1, sym = 1, anti = 1;
+    for (int i = 0; i < n; i++) {
+        zero &= t[i] == 0;
+        sym &= t[i] == t[n - 1 - i];
+        anti &= t[i] == -t[n - 1 - i];
+    }
+    return zero ? 2 : (sym ? 1 : (anti ? -1 : 0));
+}
+
+static inline int convGcd(int a, int b) {
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * ܷд row/col
+ */
+static inline int convFactor(ConvKernel* k) {
+    int n = k->size;
+    int r0 = -1, c0 = -1;
+    for (int i = 0; i < n * n && r0 < 0; i++) {
+        if (k->taps[i] != 0) {
+            r0 = i / n;
+            c0 = i % n;
+        }
+    }
+    if (r0 < 0) {
+        return 0;
+    }
+    // ȡ r0 гԼɵ c0 аõ
+    int g = 0;
+    for (int x = 0; x < n; x++) {
+        g = convGcd(g, k->taps[r0 * n + x]);
+    }
+    for (int x = 0; x < n; x++) {
+        k->row[x] = k->taps[r0 * n + x] / g;
+    }
+    for (int y = 0; y < n; y++) {
+        if (k->taps[y * n + c0] % k->row[c0] != 0) {
+            return 0;
+        }
+        k->col[y] = k->taps[y * n + c0] / k->row[c0];
+        for (int x = 0; x < n; x++) {
+            if (k->taps[y * n + x] != k->col[y] * k->row[x]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * ú˲
+ * @param size߳1~CONV_MAX_SIZE
+ * @param tapssize*size ϵ
+ * @param divisor1 ʾ
+ * @return 0=ɹ-1=Ϸ
+ */
+static inline int convKernelInit(ConvKernel* k, int size, const int* taps, int divisor) {
+    if (size < 1 || size > CONV_MAX_SIZE || size % 2 == 0 || divisor < 1) {
+        return -1;
+    }
+    memset(k, 0, sizeof(ConvKernel));
+    k->size = size;
+    k->divisor = divisor;
+    memcpy(k->taps, taps, sizeof(int) * size * size);
+    for (int i = 0; i < size * size; i++) {
+        k->nonzero += taps[i] != 0;
+    }
+    for (int y = 0; y < size; y++) {
+        k->row_symmetry[y] = convSymmetry(k->taps + y * size, size);
+    }
+    k->separable = size > 1 && convFactor(k);
+    if (k->separable) {
+        k->row_taps_symmetry = convSymmetry(k->row, size);
+        k->col_taps_symmetry = convSymmetry(k->col, size);
+    }
+    return 0;
+}
+
+/**
+ * ۼֵǷ int Χڣmax_val * ϵֵ֮ <= INT_MAX
+ * ɷ˺һмֵFFT ÿ鹱Ҳ
+ */
+static inline int convKernelFits(const ConvKernel* k, int max_val) {
+    long long sum = 0;
+    for (int i = 0; i < k->size * k->size; i++) {
+        sum += k->taps[i] < 0 ? -(long long)k->taps[i] : k->taps[i];
+    }
+    return sum * max_val <= INT_MAX;
+}
+
+/**
+ * ˹ˣһάϵ round(s * exp(-i*i / (2*sigma*sigma)))άΪΪϵ͵ƽ
+ *  ˹ģ.c  weight() ͬΪ exp(-(x*x+y*y)/(2*sigma*sigma)) ״ǰĳڹһʱԼ
+ * s ȡ 64max_val *   int ʱμ 1 ֱ8 λ 64뾶 15 ʱԼ 1e9
+ * 16 λ뾶 3 ʱԼΪ 48뾶 15 ʱԼΪ 9
+ * @param radius0~15
+ * @param max_valֵ1~65535
+ * @return 0=ɹ-1=Ϸ
+ */
+static inline int convGaussianKernel(ConvKernel* k, int radius, double sigma, int max_val) {
+    int n = 2 * radius + 1;
+    if (radius < 0 || radius > 15 || sigma <= 0 || max_val < 1 || max_val > 65535) {
+        return -1;
+    }
+    int g[CONV_MAX_SIZE];
+    int sum = 0;
+    for (int scale = 64; scale >= 1; scale--) {
+        sum = 0;
+        for (int i = 0; i < n; i++) {
+            int d = i - radius;
+            g[i] = (int)floor(scale * exp(-(d * d) / (2 * sigma * sigma)) + 0.5);
+            sum += g[i];
+        }
+        if ((long long)sum * sum * max_val <= INT_MAX) {
+            break;  // s=1 ʱ sum <= 31Ȼ
+        }
+    }
+    int taps[CONV_MAX_SIZE * CONV_MAX_SIZE];
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            taps[y * n + x] = g[y] * g[x];
+        }
+    }
+    return convKernelInit(k, n, taps, sum * sum);
+}
+
+//========== ߻ ==========
+
+// ͼصȡһ abcd Ϊ 3 
+typedef enum {
+    CONV_BORDER_CONSTANT = 0,  // vvv|abcdv ΪָĬ 0
+    CONV_BORDER_CLAMP,         // aaa|abcdƱԵ
+    CONV_BORDER_REFLECT,       // dcb|abcdԱԵΪ᾵񣨱Եزظ
+    CONV_BORDER_WRAP           // bcd|abcdѭ
+} ConvBorder;
+
+/**
+ * ȡ߽緽ʽconstant / clamp / reflect / wrap
+ * @return ߽緽ʽֲʶʱ -1
+ */
+static inline int convBorderByName(const char* name) {
+    const char* names[] = { "constant", "clamp", "reflect", "wrap" };
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ *  i ӳ䵽 [0, n) ڣ߽ i ͼʱ -1
+ * ѭԶ i ߿ȿԳͼ
+ */
+static inline int convBorderIndex(int i, int n, ConvBorder border) {
+    if (i >= 0 && i < n) {
+        return i;
+    }
+    switch (border) {
+    case CONV_BORDER_CLAMP:
+        return i < 0 ? 0 : n - 1;
+    case CONV_BORDER_REFLECT: {
+        if (n == 1) {
+            return 0;
+        }
+        int period = 2 * n - 2;
+        i %= period;
+        i = i < 0 ? i + period : i;
+        return i < n ? i : period - i;
+    }
+    case CONV_BORDER_WRAP:
+        i %= n;
+        return i < 0 ? i + n : i;
+    default:
+        return -1;
+    }
+}
+
+// ܸ pad صƽ棬data ָ򲹱ߺϽ
+typedef struct {
+    int* data;
+    int width;   // ԭͼ
+    int height;  // ԭͼ
+    int pad;
+    int stride;  // width + 2*pad
+} PaddedPlane;
+
+/**
+ * ƽ濽ܰ border ñߵĻ
+ * @param valueCONV_BORDER_CONSTANT ʱͼֵ
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int padPlaneBorder(PaddedPlane* p, const int* src, int width, int height, int pad, ConvBorder border, int value) {
+    p->width = width;
+    p->height = height;
+    p->pad = pad;
+    p->stride = width + 2 * pad;
+    p->data = (int*)malloc(sizeof(int) * p->stride * (height + 2 * pad));
+    if (p->data == NULL) {
+        return -1;
+    }
+    for (int py = 0; py < height + 2 * pad; py++) {
+        int* dst = p->data + (size_t)py * p->stride;
+        int sy = convBorderIndex(py - pad, height, border);
+        if (sy < 0) {
+            for (int x = 0; x < p->stride; x++) {
+                dst[x] = value;
+            }
+            continue;
+        }
+        const int* row = src + (size_t)sy * width;
+        memcpy(dst + pad, row, sizeof(int) * width);
+        //  pad ӳ
+        for (int x = 0; x < pad; x++) {
+            int left = convBorderIndex(x - pad, width, border);
+            int right = convBorderIndex(width + x, width, border);
+            dst[x] = left < 0 ? value : row[left];
+            dst[pad + width + x] = right < 0 ? value : row[right];
+        }
+    }
+    return 0;
+}
+
+/**
+ * ƽ濽ܲ 0 Ļ
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int padPlane(PaddedPlane* p, const int* src, int width, int height, int pad) {
+    return padPlaneBorder(p, src, width, height, pad, CONV_BORDER_CONSTANT, 0);
+}
+
+static inline void freePadded(PaddedPlane* p) {
+    free(p->data);
+    p->data = NULL;
+}
+
+//========== һάۼӣ߳רŻ ==========
+
+/**
+ * acc[x] += sum(t[i] * s[x + i])i = 0..n-1sym Ϊ t ĶԳ
+ * Գ n ʱڲȫչ
+ */
+CONV_FORCE_INLINE void convAccumN(const int* s, int* acc, int width, const int* taps, int n, int sym) {
+    int t[CONV_MAX_SIZE];
+    for (int i = 0; i < n; i++) {
+        t[i] = taps[i];
+    }
+    int c = n / 2;
+    if (sym == 1) {
+        for (int x = 0; x < width; x++) {
+            int v = t[c] * s[x + c];
+            for (int i = 0; i < c; i++) {
+                v += t[i] * (s[x + i] + s[x + n - 1 - i]);
+            }
+            acc[x] += v;
+        }
+    }
+    else if (sym == -1) {
+        for (int x = 0; x < width; x++) {
+            int v = 0;
+            for (int i = 0; i < c; i++) {
+                v += t[i] * (s[x + i] - s[x + n - 1 - i]);
+            }
+            acc[x] += v;
+        }
+    }
+    else {
+        for (int x = 0; x < width; x++) {
+            int v = 0;
+            for (int i = 0; i < n; i++) {
+                v += t[i] * s[x + i];
+            }
+            acc[x] += v;
+        }
+    }
+}
+
+/**
+ * ߳ǳʱͨð汾ϵ㡢x ڲ㣬ÿϵһĳ˼
+ * ϵڲʱѭ̵ֻܶڲ㣬öࣩ
+ */
+static inline void convAccumGeneric(const int* s, int* acc, int width, const int* taps, int n, int sym) {
+    int c = n / 2;
+    if (sym == 1 || sym == -1) {
+        for (int i = 0; i < c; i++) {
+            int t = taps[i];
+            const int* a = s + i;
+            const int* b = s + n - 1 - i;
+            if (t == 0) {
+                continue;
+            }
+            if (sym == 1) {
+                for (int x = 0; x < width; x++) {
+                    acc[x] += t * (a[x] + b[x]);
+                }
+            }
+            else {
+                for (int x = 0; x < width; x++) {
+                    acc[x] += t * (a[x] - b[x]);
+                }
+            }
+        }
+        if (sym == 1) {
+            int t = taps[c];
+            const int* m = s + c;
+            for (int x = 0; x < width; x++) {
+                acc[x] += t * m[x];
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < n; i++) {
+            int t = taps[i];
+            const int* a = s + i;
+            if (t == 0) {
+                continue;
+            }
+            for (int x = 0; x < width; x++) {
+                acc[x] += t * a[x];
+            }
+        }
+    }
+}
+
+static inline void convAccum(const int* s, int* acc, int width, const int* taps, int n, int sym) {
+    if (sym == 2) {
+        return;
+    }
+    switch (n) {
+    case 3:  convAccumN(s, acc, width, taps, 3, sym); break;
+    case 5:  convAccumN(s, acc, width, taps, 5, sym); break;
+    case 7:  convAccumN(s, acc, width, taps, 7, sym); break;
+    default: convAccumGeneric(s, acc, width, taps, n, sym); break;
+    }
+}
+
+/**
+ * ֱacc[x] += sum(t[i] * rows[i][x])rows Ϊ n ָ
+ */
+CONV_FORCE_INLINE void convAccumColumnN(const int* const* rows, int* acc, int width, const int* taps, int n, int sym) {
+    int c = n / 2;
+    if (sym == 1) {
+        for (int i = 0; i < c; i++) {
+            int t = taps[i];
+            const int* a = rows[i];
+            const int* b = rows[n - 1 - i];
+            for (int x = 0; x < width; x++) {
+                acc[x] += t * (a[x] + b[x]);
+            }
+        }
+        int t = taps[c];
+        const int* m = rows[c];
+        for (int x = 0; x < width; x++) {
+            acc[x] += t * m[x];
+        }
+    }
+    else if (sym == -1) {
+        for (int i = 0; i < c; i++) {
+            int t = taps[i];
+            const int* a = rows[i];
+            const int* b = rows[n - 1 - i];
+            for (int x = 0; x < width; x++) {
+                acc[x] += t * (a[x] - b[x]);
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < n; i++) {
+            int t = taps[i];
+            const int* a = rows[i];
+            if (t == 0) {
+                continue;
+            }
+            for (int x = 0; x < width; x++) {
+                acc[x] += t * a[x];
+            }
+        }
+    }
+}
+
+static inline void convAccumColumn(const int* const* rows, int* acc, int width, const int* taps, int n, int sym) {
+    if (sym == 2) {
+        return;
+    }
+    switch (n) {
+    case 3:  convAccumColumnN(rows, acc, width, taps, 3, sym); break;
+    case 5:  convAccumColumnN(rows, acc, width, taps, 5, sym); break;
+    case 7:  convAccumColumnN(rows, acc, width, taps, 7, sym); break;
+    default: convAccumColumnN(rows, acc, width, taps, n, sym); break;
+    }
+}
+
+/**
+ *  divisor 루Զ 0
+ */
+static inline void convFinish(const int* acc, int* dst, int width, int divisor) {
+    if (divisor == 1) {
+        memcpy(dst, acc, sizeof(int) * width);
+        return;
+    }
+    int half = divisor / 2;
+    for (int x = 0; x < width; x++) {
+        int v = acc[x];
+        dst[x] = v >= 0 ? (v + half) / divisor : -((half - v) / divisor);
+    }
+}
+
+//==========  ==========
+
+/**
+ * ֱӾߵƽ棨pad Сں˰뾶
+ * @param dstwidth*height 
+ * @return 0=ɹ-1=ڴ治򲹱߲
+ */
+static inline int convPaddedDirect(const PaddedPlane* p, int* dst, const ConvKernel* k) {
+    int n = k->size;
+    int r = n / 2;
+    int width = p->width;
+    int height = p->height;
+    if (p->pad < r) {
+        return -1;
+    }
+    int* acc = (int*)malloc(sizeof(int) * width);
+    if (acc == NULL) {
+        return -1;
+    }
+    //  y ڲ߻д (y + pad - r) С(pad - r) пʼȡ
+    const int* base = p->data + (size_t)(p->pad - r) * p->stride + (p->pad - r);
+
+    if (k->separable) {
+        // Ⱥ᣺height + 2r иһһάŽε n л壻
+        int* ring = (int*)malloc(sizeof(int) * width * n);
+        if (ring == NULL) {
+            free(acc);
+            return -1;
+        }
+        const int* rows[CONV_MAX_SIZE];
+        for (int y = -r; y < height + r; y++) {
+            int* h = ring + (size_t)((y + r) % n) * width;
+            memset(h, 0, sizeof(int) * width);
+            convAccum(base + (size_t)(y + r) * p->stride, h, width, k->row, n, k->row_taps_symmetry);
+            int out_y = y - r;  // Ѵ out_y-r .. out_y+r  n 
+            if (out_y < 0) {
+                continue;
+            }
+            for (int i = 0; i < n; i++) {
+                rows[i] = ring + (size_t)((out_y + i) % n) * width;
+            }
+            memset(acc, 0, sizeof(int) * width);
+            convAccumColumn(rows, acc, width, k->col, n, k->col_taps_symmetry);
+            convFinish(acc, dst + (size_t)out_y * width, width, k->divisor);
+        }
+        free(ring);
+    }
+    else {
+        for (int y = 0; y < height; y++) {
+            memset(acc, 0, sizeof(int) * width);
+            for (int ky = 0; ky < n; ky++) {
+                convAccum(base + (size_t)(y + ky) * p->stride, acc, width, k->taps + ky * n, n, k->row_symmetry[ky]);
+            }
+            convFinish(acc, dst + (size_t)y * width, width, k->divisor);
+        }
+    }
+    free(acc);
+    return 0;
+}
+
+//========== FFT ˣ ==========
+
+// ɷұ߳Сڸֵĺ˲ſ FFTСĺֱӾǸ죬ز
+#define CONV_FFT_MIN_SIZE 9
+
+// ֿ FFT Ĺÿ B*B 0  T*T 뷭תĺѭB + size - 1 <= T ֤
+typedef struct {
+    int tile;            // T2 
+    int block;           // B = T - size + 1
+    int cols;            // ÿеƵʷ T/2+1
+    RealFft row_fft;
+    Fft col_fft;
+    Complex* kernel;     // ˵ƵףT*cols
+    Complex* spec;       // ǰƵףT*cols
+    Complex* column;     // һеĹT
+    double* buf;         // ǰʵݣT*T
+} ConvFft;
+
+/**
+ * ѡ FFT ߳ÿ۰ T*T*log2(T) ƣԸ width*height ĿȡܴС
+ */
+static inline int convFftTile(int n, int width, int height) {
+    int best = 0;
+    double best_cost = 0;
+    for (int t = 16, lg = 4; t <= 4096; t <<= 1, lg++) {
+        int b = t - n + 1;
+        if (b < 1) {
+            continue;
+        }
+        double tiles = (double)((width + b - 1) / b) * ((height + b - 1) / b);
+        double cost = tiles * t * (double)t * lg;
+        if (best == 0 || cost < best_cost) {
+            best = t;
+            best_cost = cost;
+        }
+        if (b >= width && b >= height) {
+            break;  // һѸ T ֻ
+        }
+    }
+    return best;
+}
+
+static inline void convFftFree(ConvFft* f) {
+    realFftFree(&f->row_fft);
+    fftFree(&f->col_fft);
+    free(f->kernel);
+    free(f->spec);
+    free(f->column);
+    free(f->buf);
+}
+
+/**
+ * Ķά任ȶǰ rows ʵ FFTȫ 0ƵҲΪ 0ٶÿ FFT
+ */
+static inline void convFftForward(ConvFft* f, int rows) {
+    int t = f->tile;
+    int c = f->cols;
+    for (int y = 0; y < rows; y++) {
+        realFftForward(&f->row_fft, f->buf + (size_t)y * t, f->spec + (size_t)y * c);
+    }
+    memset(f->spec + (size_t)rows * c, 0, sizeof(Complex) * (t - rows) * c);
+    for (int x = 0; x < c; x++) {
+        for (int y = 0; y < t; y++) {
+            f->column[y] = f->spec[(size_t)y * c + x];
+        }
+        fftRun(&f->col_fft, f->column, 0);
+        for (int y = 0; y < t; y++) {
+            f->spec[(size_t)y * c + x] = f->column[y];
+        }
+    }
+}
+
+/**
+ * Ķά任һֻԭǰ rows 
+ */
+static inline void convFftInverse(ConvFft* f, int rows) {
+    int t = f->tile;
+    int c = f->cols;
+    for (int x = 0; x < c; x++) {
+        for (int y = 0; y < t; y++) {
+            f->column[y] = f->spec[(size_t)y * c + x];
+        }
+        fftRun(&f->col_fft, f->column, 1);
+        for (int y = 0; y < rows; y++) {
+            f->spec[(size_t)y * c + x] = f->column[y];
+        }
+    }
+    for (int y = 0; y < rows; y++) {
+        realFftInverse(&f->row_fft, f->spec + (size_t)y * c, f->buf + (size_t)y * t);
+    }
+}
+
+/**
+ * ׼ú˵Ƶ
+ * 水أתˣ㣬FFT ǾԺҷתٱ任
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int convFftInit(ConvFft* f, const ConvKernel* k, int width, int height) {
+    int n = k->size;
+    memset(f, 0, sizeof(ConvFft));
+    f->tile = convFftTile(n, width, height);
+    f->block = f->tile - n + 1;
+    f->cols = f->tile / 2 + 1;
+    int t = f->tile;
+    size_t spec_size = (size_t)t * f->cols;
+    int failed = realFftInit(&f->row_fft, t) != 0;
+    failed |= fftInit(&f->col_fft, t) != 0;
+    f->kernel = (Complex*)malloc(sizeof(Complex) * spec_size);
+    f->spec = (Complex*)malloc(sizeof(Complex) * spec_size);
+    f->column = (Complex*)malloc(sizeof(Complex) * t);
+    f->buf = (double*)calloc((size_t)t * t, sizeof(double));
+    if (failed || f->kernel == NULL || f->spec == NULL || f->column == NULL || f->buf == NULL) {
+        convFftFree(f);
+        return -1;
+    }
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            f->buf[(size_t)y * t + x] = k->taps[(n - 1 - y) * n + (n - 1 - x)];
+        }
+    }
+    convFftForward(f, n);
+    memcpy(f->kernel, f->spec, sizeof(Complex) * spec_size);
+    return 0;
+}
+
+/**
+ * FFT ߵƽ棨pad Сں˰뾶 convPaddedDirect ֵͬ
+ * ÿĹ˻֮ͣFFT ԶС 0.5ȷ
+ * @param dstwidth*height 
+ * @return 0=ɹ-1=ڴ治򲹱߲
+ */
+static inline int convPaddedFFT(const PaddedPlane* p, int* dst, const ConvKernel* k) {
+    int n = k->size;
+    int r = n / 2;
+    int width = p->width;
+    int height = p->height;
+    if (p->pad < r) {
+        return -1;
+    }
+    // Ϊߺ (width + 2r) x (height + 2r)± c Ӧ c - 2r
+    int in_width = width + 2 * r;
+    int in_height = height + 2 * r;
+    const int* base = p->data + (size_t)(p->pad - r) * p->stride + (p->pad - r);
+    ConvFft f;
+    if (convFftInit(&f, k, in_width, in_height) != 0) {
+        return -1;
+    }
+    int* acc = (int*)calloc((size_t)width * height, sizeof(int));
+    if (acc == NULL) {
+        convFftFree(&f);
+        return -1;
+    }
+    int t = f.tile;
+    int b = f.block;
+    size_t spec_size = (size_t)t * f.cols;
+    double scale = 1.0 / ((double)t * t);
+
+    for (int by = 0; by < in_height; by += b) {
+        int bh = in_height - by < b ? in_height - by : b;
+        for (int bx = 0; bx < in_width; bx += b) {
+            int bw = in_width - bx < b ? in_width - bx : b;
+            // 1. 鿽 T*T 壬Ҳಹ 0·任ﰴ 0 
+            for (int y = 0; y < bh; y++) {
+                double* row = f.buf + (size_t)y * t;
+                const int* src = base + (size_t)(by + y) * p->stride + bx;
+                for (int x = 0; x < bw; x++) {
+                    row[x] = src[x];
+                }
+                for (int x = bw; x < t; x++) {
+                    row[x] = 0;
+                }
+            }
+            // 2. 任˺˵Ƶס任
+            convFftForward(&f, bh);
+            for (size_t i = 0; i < spec_size; i++) {
+                Complex a = f.spec[i];
+                Complex w = f.kernel[i];
+                f.spec[i].re = a.re * w.re - a.im * w.im;
+                f.spec[i].im = a.re * w.im + a.im * w.re;
+            }
+            int out_rows = bh + n - 1;
+            convFftInverse(&f, out_rows);
+            // 3.  (bh+n-1) x (bw+n-1) ۼӵصӣ
+            int x_first = 2 * r - bx > 0 ? 2 * r - bx : 0;
+            int x_last = width + 2 * r - bx < bw + n - 1 ? width + 2 * r - bx : bw + n - 1;
+            for (int cy = 0; cy < out_rows; cy++) {
+                int oy = by + cy - 2 * r;
+                if (oy < 0 || oy >= height) {
+                    continue;
+                }
+                const double* row = f.buf + (size_t)cy * t;
+                int* out = acc + (size_t)oy * width + (bx - 2 * r);
+                for (int cx = x_first; cx < x_last; cx++) {
+                    out[cx] += (int)floor(row[cx] * scale + 0.5);
+                }
+            }
+        }
+    }
+    for (int y = 0; y < height; y++) {
+        convFinish(acc + (size_t)y * width, dst + (size_t)y * width, width, k->divisor);
+    }
+    free(acc);
+    convFftFree(&f);
+    return 0;
+}
+
+// ʱظеۼ 10msÿεʱ
+static inline double convTimePerRun(const PaddedPlane* p, int* dst, const ConvKernel* k, int use_fft) {
+    clock_t start = clock();
+    clock_t elapsed;
+    int runs = 0;
+    do {
+        if (use_fft) {
+            convPaddedFFT(p, dst, k);
+        }
+        else {
+            convPaddedDirect(p, dst, k);
+        }
+        runs++;
+        elapsed = clock() - start;
+    } while (elapsed < CLOCKS_PER_SEC / 100);
+    return (double)elapsed / runs;
+}
+
+/**
+ * ʵֽ߳ 192x192 ƽϴ CONV_FFT_MIN_SIZE ϵȫΪ 0 ĺ߳Ƚʵ֣
+ * ȡ FFT һθʱı߳һֱʱ CONV_MAX_SIZE + 2 FFT
+ */
+static inline int convMeasureCrossover(void) {
+    const int side = 192;
+    int* src = (int*)malloc(sizeof(int) * side * side);
+    int* dst = (int*)malloc(sizeof(int) * side * side);
+    int* taps = (int*)malloc(sizeof(int) * CONV_MAX_SIZE * CONV_MAX_SIZE);
+    ConvKernel* k = (ConvKernel*)malloc(sizeof(ConvKernel));
+    int crossover = CONV_MAX_SIZE + 2;
+    if (src != NULL && dst != NULL && taps != NULL && k != NULL) {
+        unsigned int seed = 12345;
+        for (int i = 0; i < side * side; i++) {
+            seed = seed * 1103515245u + 12345u;
+            src[i] = (int)((seed >> 16) & 255);
+        }
+        for (int n = CONV_FFT_MIN_SIZE; n <= CONV_MAX_SIZE; n += 2) {
+            for (int i = 0; i < n * n; i++) {
+                seed = seed * 1103515245u + 12345u;
+                taps[i] = (int)((seed >> 16) % 16) - 8;
+                taps[i] += taps[i] >= 0;  // -8..-11..8 0
+            }
+            PaddedPlane p;
+            if (convKernelInit(k, n, taps, 1) != 0 || padPlane(&p, src, side, side, n / 2) != 0) {
+                break;
+            }
+            double direct = convTimePerRun(&p, dst, k, 0);
+            double fft = convTimePerRun(&p, dst, k, 1);
+            freePadded(&p);
+            if (fft < direct) {
+                crossover = n;
+                break;
+            }
+        }
+    }
+    free(src);
+    free(dst);
+    free(taps);
+    free(k);
+    return crossover;
+}
+
+#define CONV_FFT_CROSSOVER_FILE "conv_fft_crossover.txt"  // ʵķֽ߳ڳĿ¼ļ
+
+static char g_conv_crossover_path[1024] = CONV_FFT_CROSSOVER_FILE;
+
+/**
+ * ֽ߳ļڳĿ¼ argv[0] õʱΪǰĿ¼
+ */
+static inline void convFftCrossoverFile(const char* argv0) {
+    const char* slash = NULL;
+    for (const char* c = argv0; c != NULL && *c != '\0'; c++) {
+        if (*c == '/' || *c == '\\') {
+            slash = c;
+        }
+    }
+    int dir_len = slash != NULL ? (int)(slash - argv0 + 1) : 0;
+    snprintf(g_conv_crossover_path, sizeof(g_conv_crossover_path), "%.*s%s", dir_len, argv0, CONV_FFT_CROSSOVER_FILE);
+}
+
+/**
+ * ɷ˴Ӷı߳ FFTϵȫΪ 0 ĺ˲ã
+ * ʱ CONV_FFT_CROSSOVER ֱøֵ -DCONV_FFT_CROSSOVER=9999 ر FFT
+ * ȶֽ߳ļûлݲϷʱʵһΣԼ 50~200 룩дļ֮вٲ
+ * ɾļ²绻˻߳ͬʱһεʱֻһ
+ */
+static inline int convFftCrossover(void) {
+#ifdef CONV_FFT_CROSSOVER
+    return CONV_FFT_CROSSOVER;
+#else
+    static int crossover = 0;  // 0=δȡ
+    int value;
+    #pragma omp critical(conv_fft_crossover)
+    {
+        if (crossover == 0) {
+            FILE* file = fopen(g_conv_crossover_path, "r");
+            if (file != NULL) {
+                if (fscanf(file, "%d", &value) == 1 && value >= CONV_FFT_MIN_SIZE && value <= CONV_MAX_SIZE + 2) {
+                    crossover = value;
+                }
+                fclose(file);
+            }
+        }
+        if (crossover == 0) {
+            crossover = convMeasureCrossover();
+            FILE* file = fopen(g_conv_crossover_path, "w");
+            if (file != NULL) {
+                fprintf(file, "%d\n", crossover);
+                fclose(file);
+            }
+        }
+        value = crossover;
+    }
+    return value;
+#endif
+}
+
+/**
+ * úǷ FFTֱӾĴۿ 0 ϵFFT Ĵۼֻ߳
+ * ϡĴˣϸ״˶ģ 0 ϵֽ߳ƽȽϣ
+ * ɷÿֻ 2N γ˷ֱӾ
+ */
+static inline int convUsesFft(const ConvKernel* k) {
+    if (k->separable || k->size < CONV_FFT_MIN_SIZE) {
+        return 0;
+    }
+    int crossover = convFftCrossover();
+    return k->size >= crossover && k->nonzero >= crossover * crossover;
+}
+
+/**
+ * Բߵƽpad Сں˰뾶ѡֱӾ FFT
+ * @param dstwidth*height 
+ * @return 0=ɹ-1=ڴ治򲹱߲
+ */
+static inline int convPadded(const PaddedPlane* p, int* dst, const ConvKernel* k) {
+    return convUsesFft(k) ? convPaddedFFT(p, dst, k) : convPaddedDirect(p, dst, k);
+}
+
+/**
+ * ͼⰴ border ȡֵ
+ * @param valueCONV_BORDER_CONSTANT ʱͼֵ
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int convPlaneBorder(const int* src, int* dst, int width, int height, const ConvKernel* k, ConvBorder border, int value) {
+    PaddedPlane p;
+    if (padPlaneBorder(&p, src, width, height, k->size / 2, border, value) != 0) {
+        return -1;
+    }
+    int ret = convPadded(&p, dst, k);
+    freePadded(&p);
+    return ret;
+}
+
+/**
+ * ͼⰴ 0 
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int convPlane(const int* src, int* dst, int width, int height, const ConvKernel* k) {
+    return convPlaneBorder(src, dst, width, height, k, CONV_BORDER_CONSTANT, 0);
+}
+
+#endif
\ No newline at end of file
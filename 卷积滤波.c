@@ -0,0 +1,1069 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ͳ.h"
+#include "ɫת.h"
+#include ".h"
+#include "ͼ.h"
+#include "ֵ˲.h"
+#include "̬ѧ.h"
+#include "ֱͼ.h"
+
+/**
+ * ˲ .h ĳ˲
+ *   sobel / prewitt / scharr  Ҷݶȷֵ sqrt(Gx*Gx + Gy*Gy)ѡֵֵ PGM
+ *   laplacian                 Ҷ˹ֵ PGM
+ *   sharpen                   ͨ񻯣ͬ
+ *   gauss R [sigma]           ͨ˹ģˣ룩ͬ
+ *   kernel ļ               ͨԶˣͬͣɷĴԶ FFT .h
+ *   box R                     ͨʽģͼÿش뾶޹أͬ
+ *   adaptive R [k]            sobel ֵ (2R+1)^2 ڵľֲֵ + k*׼ ֵͼk Ĭ 1 PGM
+ *   median R                  ͨ (2R+1)^2 ֵ˲ʱ䣬 ֵ˲.hֵ 255
+ *   erode|dilate|open|close RX [RY]  ͨ (2RX+1)x(2RY+1) ̬ѧ㣨 ̬ѧ.hRY Ĭͬ RX
+ *                             Ϊ PBM P4 sobelԵ --pbm ʱֱλͼ P4
+ *   equalize                  ֱͨͼ⻯ ֱͼ.hͬ
+ *   clahe [N] [clip]          ͨ CLAHEN*N 飨Ĭ 8ض clipĬ 2ͬ
+ * --otsu  sobel / prewitt / scharrɷֱֵͼ Otsu ֵٶֵ --threshold
+ * --median R κ˲֮ǰһֵ˲ȥݶȣ
+ * --rect x0,y0,x1,y1 ӡͼиþΣˣÿͨĺֵ͡׼ɸΡ
+ *  P2/P3/P5/P6ֵ 65535RGB תҶ BT.601ͬ sobelԵ.c
+ * ͼĬϰ 0 ƣʱݶ˹ı߽һȦ 0ͬ sobelԵ.c
+ * --border clamp|reflect|wrap ʱͼⰴƱԵѭȡֵ߽ճ㡣ص 0~ֵ
+ * ļ߳   ߳*߳ ϵȣΪ# ͷΪעͣ
+ *   3 16
+ *   1 2 1
+ *   2 4 2
+ *   1 2 1
+ * ÷˲ <˲> <> <> [] [--border ʽ] [--threshold T] [--otsu] [--median R] [--rect x0,y0,x1,y1] [--text]
+ */
+
+#define MAX_RECTS 16  // --rect 
+
+// ֿͨŵͼÿͨһ int ƽ棬ֱӽ棩
+typedef struct {
+    int width;         // ͼ
+    int height;        // ͼ߶
+    int max_val;       // ֵ
+    int channels;      // 1=Ҷȣ3=RGB
+    int* plane[3];     // ÿͨ width*height 
+} PlaneImage;
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_BAD_ARGUMENT,
+    ERR_BAD_KERNEL,
+    ERR_NOT_8BIT,
+    ERR_KERNEL_RANGE
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PGM P2/P5  PPM P3/P6 ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "вϷ",
+    "󣺾ļϷ",
+    "ֵ˲ֵֻ֧ 255 ͼ",
+    "󣺾ϵֵ֮ͳֵ int Χ"
+};
+
+//========== ȡ ==========
+
+typedef struct {
+    FILE* file;
+    unsigned char buf[1 << 16];
+    size_t pos;
+    size_t len;
+    double total;  // Ѷֽ
+} Reader;
+
+int readerByte(Reader* rd) {
+    if (rd->pos == rd->len) {
+        rd->len = fread(rd->buf, 1, sizeof(rd->buf), rd->file);
+        rd->pos = 0;
+        rd->total += rd->len;
+        if (rd->len == 0) {
+            return EOF;
+        }
+    }
+    return rd->buf[rd->pos++];
+}
+
+/**
+ * ȡһհ # עͣǰţԵһָ
+ * @return 0=ɹ-1=ʧ
+ */
+int readerNumber(Reader* rd, int* value) {
+    int ch = readerByte(rd);
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = readerByte(rd);
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = readerByte(rd);
+    }
+    int negative = ch == '-';
+    if (negative) {
+        ch = readerByte(rd);
+    }
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    int v = 0;
+    while (ch >= '0' && ch <= '9') {
+        if (v > 100000000) {
+            return -1;
+        }
+        v = v * 10 + (ch - '0');
+        ch = readerByte(rd);
+    }
+    *value = negative ? -v : v;
+    return 0;
+}
+
+//========== д ==========
+
+/**
+ * ͷͼĶ̬ڴ
+ */
+void freeImage(PlaneImage* img) {
+    for (int c = 0; c < 3; c++) {
+        if (img->plane[c] != NULL) {
+            STATS_FREE(sizeof(int) * img->width * img->height);
+            free(img->plane[c]);
+            img->plane[c] = NULL;
+        }
+    }
+}
+
+/**
+ * ͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode allocImage(PlaneImage* img, int width, int height, int max_val, int channels) {
+    memset(img, 0, sizeof(PlaneImage));
+    img->width = width;
+    img->height = height;
+    img->max_val = max_val;
+    img->channels = channels;
+    for (int c = 0; c < channels; c++) {
+        img->plane[c] = (int*)malloc(sizeof(int) * width * height);
+        if (img->plane[c] == NULL) {
+            freeImage(img);
+            return ERR_MEMORY_ALLOC;
+        }
+        STATS_ALLOC(sizeof(int) * width * height);
+    }
+    return SUCCESS;
+}
+
+/**
+ *  PGM/PPMͨ
+ * @param filenameļ·
+ * @param imgͼǰ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readImage(const char* filename, PlaneImage* img) {
+    memset(img, 0, sizeof(PlaneImage));
+    static Reader rd;
+    memset(&rd, 0, sizeof(Reader));
+    rd.file = fopen(filename, "rb");
+    if (rd.file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    int kind = 0;
+    int width, height, max_val;
+    ErrorCode ret = SUCCESS;
+    if (readerByte(&rd) != 'P' || ((kind = readerByte(&rd)) != '2' && kind != '3' && kind != '5' && kind != '6')) {
+        ret = ERR_WRONG_FORMAT;
+    }
+    else if (readerNumber(&rd, &width) != 0 || readerNumber(&rd, &height) != 0 || readerNumber(&rd, &max_val) != 0) {
+        ret = ERR_FILE_BROKEN;
+    }
+    else if (width <= 0 || height <= 0 || max_val <= 0 || max_val > 65535) {
+        ret = ERR_ILLEGAL_SIZE;
+    }
+    else {
+        ret = allocImage(img, width, height, max_val, (kind == '3' || kind == '6') ? 3 : 1);
+    }
+    if (ret != SUCCESS) {
+        fclose(rd.file);
+        return ret;
+    }
+
+    int binary = kind == '5' || kind == '6';
+    int wide = max_val > 255;
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count && ret == SUCCESS; i++) {
+        for (int c = 0; c < img->channels; c++) {
+            int v;
+            if (binary) {
+                v = readerByte(&rd);
+                if (wide && v != EOF) {
+                    int low = readerByte(&rd);
+                    v = low == EOF ? EOF : (v << 8) | low;
+                }
+                if (v == EOF) {
+                    ret = ERR_FILE_BROKEN;
+                    break;
+                }
+            }
+            else if (readerNumber(&rd, &v) != 0 || v < 0) {
+                ret = ERR_FILE_BROKEN;
+                break;
+            }
+            img->plane[c][i] = v;
+        }
+    }
+    STATS_BYTES_READ(rd.total);
+    fclose(rd.file);
+    if (ret != SUCCESS) {
+        freeImage(img);
+    }
+    return ret;
+}
+
+/**
+ * Ϊ PGMͨ PPMͨ
+ * @param filenameļ·
+ * @param imgͼ
+ * @param binary1=P5/P6max_val > 255 ʱÿ 2 ֽڴˣ0=P2/P3ıÿжӦͼһУ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writeImage(const char* filename, const PlaneImage* img, int binary) {
+    if (filename == NULL || img == NULL || img->plane[0] == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    const char* magic = img->channels == 3 ? (binary ? "P6" : "P3") : (binary ? "P5" : "P2");
+    int failed = fprintf(file, "%s\n%d %d\n%d\n", magic, img->width, img->height, img->max_val) < 0;
+    // һһдıÿ "65535 "
+    size_t row_samples = (size_t)img->width * img->channels;
+    unsigned char* line = (unsigned char*)malloc(row_samples * 6 + 1);
+    failed |= line == NULL;
+    int wide = img->max_val > 255;
+    for (int y = 0; y < img->height && !failed; y++) {
+        unsigned char* p = line;
+        for (int x = 0; x < img->width; x++) {
+            size_t i = (size_t)y * img->width + x;
+            for (int c = 0; c < img->channels; c++) {
+                int v = img->plane[c][i];
+                if (binary) {
+                    if (wide) {
+                        *p++ = (unsigned char)(v >> 8);
+                    }
+                    *p++ = (unsigned char)v;
+                }
+                else {
+                    p += sprintf((char*)p, "%d ", v);
+                }
+            }
+        }
+        if (!binary) {
+            p[-1] = '\n';
+        }
+        failed |= fwrite(line, 1, (size_t)(p - line), file) != (size_t)(p - line);
+    }
+    free(line);
+    if (!failed) {
+        STATS_BYTES_WRITTEN(ftell(file));
+    }
+    failed |= fclose(file) != 0;
+    return failed ? ERR_WRITE_FAILED : SUCCESS;
+}
+
+/**
+ * ļ߳  ϵ...
+ * ϵֵ֮ͳֵǷ񳬳 int Ҫȶͼ֪ convKernelFits 
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readKernel(const char* filename, ConvKernel* k) {
+    static Reader rd;
+    memset(&rd, 0, sizeof(Reader));
+    rd.file = fopen(filename, "rb");
+    if (rd.file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    int size, divisor;
+    int taps[CONV_MAX_SIZE * CONV_MAX_SIZE];
+    ErrorCode ret = SUCCESS;
+    if (readerNumber(&rd, &size) != 0 || readerNumber(&rd, &divisor) != 0
+        || size < 1 || size > CONV_MAX_SIZE || size % 2 == 0 || divisor < 1) {
+        ret = ERR_BAD_KERNEL;
+    }
+    for (int i = 0; i < size * size && ret == SUCCESS; i++) {
+        if (readerNumber(&rd, &taps[i]) != 0 || taps[i] < -65535 || taps[i] > 65535) {
+            ret = ERR_BAD_KERNEL;
+        }
+    }
+    fclose(rd.file);
+    if (ret == SUCCESS && convKernelInit(k, size, taps, divisor) != 0) {
+        ret = ERR_BAD_KERNEL;
+    }
+    return ret;
+}
+
+//========== ֵͼPBM P4λ̬ѧֱλ ==========
+
+// λĶֵͼÿ stride ֽڣλβ 8 λ 0
+// 1=ǰڣ0=ף PBM Լһ
+typedef struct {
+    int width;
+    int height;
+    int stride;           // ÿֽ (width+7)/8
+    unsigned char* bits;  // height*stride ֽ
+} BitMask;
+
+/**
+ * ͷŶֵͼĶ̬ڴ
+ */
+void freeMask(BitMask* mask) {
+    if (mask != NULL && mask->bits != NULL) {
+        STATS_FREE((size_t)mask->stride * mask->height);
+        free(mask->bits);
+        mask->bits = NULL;
+    }
+}
+
+/**
+ * ȫ 0 Ķֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode allocMask(BitMask* mask, int width, int height) {
+    mask->width = width;
+    mask->height = height;
+    mask->stride = (width + 7) / 8;
+    mask->bits = (unsigned char*)calloc((size_t)mask->stride * height, 1);
+    if (mask->bits == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC((size_t)mask->stride * height);
+    return SUCCESS;
+}
+
+/**
+ * ȡ PBM P4 ΪλĶֵͼԭ룬չ
+ * @param filenameļ·
+ * @param maskֵͼǰ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readPBM(const char* filename, BitMask* mask) {
+    mask->width = 0;
+    mask->height = 0;
+    mask->stride = 0;
+    mask->bits = NULL;
+
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    if (fgetc(file) != 'P' || fgetc(file) != '4') {
+        fclose(file);
+        return ERR_WRONG_FORMAT;
+    }
+
+    // ȡߣɼ # עͣ
+    int values[2];
+    for (int i = 0; i < 2; i++) {
+        int ch = fgetc(file);
+        while (ch == '#' || ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+            if (ch == '#') {
+                while (ch != '\n' && ch != EOF) {
+                    ch = fgetc(file);
+                }
+            }
+            ch = fgetc(file);
+        }
+        if (ch < '0' || ch > '9') {
+            fclose(file);
+            return ERR_FILE_BROKEN;
+        }
+        long long v = 0;
+        while (ch >= '0' && ch <= '9') {
+            v = v * 10 + (ch - '0');
+            if (v > 1000000000) {
+                fclose(file);
+                return ERR_ILLEGAL_SIZE;
+            }
+            ch = fgetc(file);
+        }
+        values[i] = (int)v;
+        if (i == 1 && ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n') {
+            fclose(file);
+            return ERR_FILE_BROKEN;  // ߶Ⱥǡһհַ֮Ϊλͼ
+        }
+    }
+    if (values[0] <= 0 || values[1] <= 0) {
+        fclose(file);
+        return ERR_ILLEGAL_SIZE;
+    }
+
+    ErrorCode ret = allocMask(mask, values[0], values[1]);
+    if (ret != SUCCESS) {
+        fclose(file);
+        return ret;
+    }
+    size_t size = (size_t)mask->stride * mask->height;
+    if (fread(mask->bits, 1, size, file) != size) {
+        freeMask(mask);
+        fclose(file);
+        return ERR_FILE_BROKEN;
+    }
+    // βλݲ涨 0 Աֽڴ
+    if (mask->width % 8 != 0) {
+        unsigned char keep = (unsigned char)(0xFF << (8 - mask->width % 8));
+        for (int y = 0; y < mask->height; y++) {
+            mask->bits[(size_t)y * mask->stride + mask->stride - 1] &= keep;
+        }
+    }
+    STATS_BYTES_READ(ftell(file));
+    fclose(file);
+    return SUCCESS;
+}
+
+/**
+ * ֵͼΪ PBM P4ÿ 1 λ
+ * @param filenameļ·
+ * @param maskֵͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writePBM(const char* filename, const BitMask* mask) {
+    if (filename == NULL || mask == NULL || mask->bits == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    size_t size = (size_t)mask->stride * mask->height;
+    if (fprintf(file, "P4\n%d %d\n", mask->width, mask->height) < 0 ||
+        fwrite(mask->bits, 1, size, file) != size) {
+        fclose(file);
+        return ERR_WRITE_FAILED;
+    }
+    STATS_BYTES_WRITTEN(ftell(file));
+    if (fclose(file) != 0) {
+        return ERR_WRITE_FAILED;
+    }
+    return SUCCESS;
+}
+
+//========== ˲ ==========
+
+// ݶӣGx Ϊˮƽ֣Gy Ϊת
+static const int SOBEL_GX[9] = { -1, 0, 1, -2, 0, 2, -1, 0, 1 };
+static const int SOBEL_GY[9] = { -1, -2, -1, 0, 0, 0, 1, 2, 1 };
+static const int PREWITT_GX[9] = { -1, 0, 1, -1, 0, 1, -1, 0, 1 };
+static const int PREWITT_GY[9] = { -1, -1, -1, 0, 0, 0, 1, 1, 1 };
+static const int SCHARR_GX[9] = { -3, 0, 3, -10, 0, 10, -3, 0, 3 };
+static const int SCHARR_GY[9] = { -3, -10, -3, 0, 0, 0, 3, 10, 3 };
+static const int LAPLACIAN[9] = { 0, 1, 0, 1, -4, 1, 0, 1, 0 };
+static const int SHARPEN[9] = { 0, -1, 0, -1, 5, -1, 0, -1, 0 };
+
+/**
+ * תΪͨҶȣԭأRGB  BT.601
+ */
+void toGray(PlaneImage* img) {
+    if (img->channels == 1) {
+        return;
+    }
+    size_t count = (size_t)img->width * img->height;
+    int* rgb = (int*)malloc(sizeof(int) * 3 * 4096);
+    int* gray = img->plane[0];  // ͵ظ R ƽ棺 i Ҷֻ i 
+    for (size_t first = 0; first < count; first += 4096) {
+        size_t n = count - first < 4096 ? count - first : 4096;
+        if (rgb == NULL) {
+            // ڴ治ʱת
+            for (size_t i = first; i < first + n; i++) {
+                int one[3] = { img->plane[0][i], img->plane[1][i], img->plane[2][i] };
+                colorToGrayWide(one, &gray[i], 1, LUMA_BT601);
+            }
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            rgb[3 * i] = img->plane[0][first + i];
+            rgb[3 * i + 1] = img->plane[1][first + i];
+            rgb[3 * i + 2] = img->plane[2][first + i];
+        }
+        colorToGrayWide(rgb, gray + first, n, LUMA_BT601);
+    }
+    free(rgb);
+    for (int c = 1; c < 3; c++) {
+        STATS_FREE(sizeof(int) * count);
+        free(img->plane[c]);
+        img->plane[c] = NULL;
+    }
+    img->channels = 1;
+}
+
+/**
+ * ߽һȦ 03x3 õͼ 0û壩
+ */
+void clearBorder(int* plane, int width, int height) {
+    memset(plane, 0, sizeof(int) * width);
+    memset(plane + (size_t)(height - 1) * width, 0, sizeof(int) * width);
+    for (int y = 1; y < height - 1; y++) {
+        plane[(size_t)y * width] = 0;
+        plane[(size_t)y * width + width - 1] = 0;
+    }
+}
+
+/**
+ * ݶȷֵҶֻһΣGxGy ˹
+ * @param imgͼ񣬴Ϊֵͨͼصֵ
+ * @param borderͼȡ߽ʱ߽һȦ 0
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode gradientMagnitude(PlaneImage* img, const int* gx_taps, const int* gy_taps, ConvBorder border) {
+    int width = img->width;
+    int height = img->height;
+    if (width < 3 || height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    toGray(img);
+    PaddedPlane plane;
+    int* gy = (int*)malloc(sizeof(int) * width * height);
+    if (gy == NULL || padPlaneBorder(&plane, img->plane[0], width, height, 1, border, 0) != 0) {
+        free(gy);
+        return ERR_MEMORY_ALLOC;
+    }
+    ConvKernel kx, ky;
+    convKernelInit(&kx, 3, gx_taps, 1);
+    convKernelInit(&ky, 3, gy_taps, 1);
+    int* gx = img->plane[0];  // Ҷѿ߻壬ԭƽ Gx
+    int failed = convPadded(&plane, gx, &kx) != 0 || convPadded(&plane, gy, &ky) != 0;
+    freePadded(&plane);
+    if (failed) {
+        free(gy);
+        return ERR_MEMORY_ALLOC;
+    }
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++) {
+        int magnitude = (int)sqrt((double)gx[i] * gx[i] + (double)gy[i] * gy[i]);
+        gx[i] = magnitude > img->max_val ? img->max_val : magnitude;
+    }
+    free(gy);
+    if (border == CONV_BORDER_CONSTANT) {
+        clearBorder(gx, width, height);
+    }
+    return SUCCESS;
+}
+
+/**
+ * ͨص 0~ֵabsolute=1 ʱȡֵ˹
+ * @param borderͼȡ߽ʱ 0 ƣ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode convolveChannels(PlaneImage* img, const ConvKernel* k, int absolute, ConvBorder border) {
+    size_t count = (size_t)img->width * img->height;
+    int* out = (int*)malloc(sizeof(int) * count);
+    if (out == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    for (int c = 0; c < img->channels; c++) {
+        if (convPlaneBorder(img->plane[c], out, img->width, img->height, k, border, 0) != 0) {
+            free(out);
+            return ERR_MEMORY_ALLOC;
+        }
+        int* dst = img->plane[c];
+        for (size_t i = 0; i < count; i++) {
+            int v = absolute && out[i] < 0 ? -out[i] : out[i];
+            dst[i] = v < 0 ? 0 : (v > img->max_val ? img->max_val : v);
+        }
+    }
+    free(out);
+    return SUCCESS;
+}
+
+/**
+ * ֵֵԭأСֵΪֵΪ 0
+ */
+void thresholdPlane(PlaneImage* img, int threshold) {
+    size_t count = (size_t)img->width * img->height;
+    int* p = img->plane[0];
+    for (size_t i = 0; i < count; i++) {
+        p[i] = p[i] >= threshold ? img->max_val : 0;
+    }
+}
+
+/**
+ * ͨʽģΪ (2*radius+1)^2 ͼڵĲ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode boxChannels(PlaneImage* img, int radius) {
+    for (int c = 0; c < img->channels; c++) {
+        IntegralImage ii;
+        if (integralBuild(&ii, img->plane[c], img->width, img->height, 0) != 0) {
+            return ERR_MEMORY_ALLOC;
+        }
+        integralBoxFilter(&ii, img->plane[c], radius);  // ֻͼֱдԭƽ
+        integralFree(&ii);
+    }
+    return SUCCESS;
+}
+
+/**
+ * ݶȷֵľֲֵԭأڴ ֵ + k*׼ ҲС floor_value ΪֵΪ 0
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode adaptiveThreshold(PlaneImage* img, int radius, double k, int floor_value) {
+    IntegralImage ii;
+    if (integralBuild(&ii, img->plane[0], img->width, img->height, 1) != 0) {
+        return ERR_MEMORY_ALLOC;
+    }
+    integralLocalThreshold(&ii, img->plane[0], img->plane[0], radius, k, floor_value, img->max_val);
+    integralFree(&ii);
+    return SUCCESS;
+}
+
+/**
+ * ӡΣˣֽصÿͨĺֵ͡׼ÿֻͨһλͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode printRectStats(const PlaneImage* img, int rects[][4], int rect_count) {
+    for (int c = 0; c < img->channels && rect_count > 0; c++) {
+        IntegralImage ii;
+        if (integralBuild(&ii, img->plane[c], img->width, img->height, 1) != 0) {
+            return ERR_MEMORY_ALLOC;
+        }
+        for (int r = 0; r < rect_count; r++) {
+            int x0 = rects[r][0] > 0 ? rects[r][0] : 0;
+            int y0 = rects[r][1] > 0 ? rects[r][1] : 0;
+            int x1 = rects[r][2] + 1 < img->width ? rects[r][2] + 1 : img->width;
+            int y1 = rects[r][3] + 1 < img->height ? rects[r][3] + 1 : img->height;
+            if (x0 >= x1 || y0 >= y1) {
+                printf(" (%d,%d)-(%d,%d)ͼ\n", rects[r][0], rects[r][1], rects[r][2], rects[r][3]);
+                continue;
+            }
+            double area = (double)(x1 - x0) * (y1 - y0);
+            long long sum = integralSum(&ii, x0, y0, x1, y1);
+            double mean = sum / area;
+            double var = integralSqSum(&ii, x0, y0, x1, y1) / area - mean * mean;
+            printf(" (%d,%d)-(%d,%d) ͨ %d %lldֵ %.3f׼ %.3f\n",
+                x0, y0, x1 - 1, y1 - 1, c, sum, mean, sqrt(var > 0 ? var : 0));
+        }
+        integralFree(&ii);
+    }
+    return SUCCESS;
+}
+
+/**
+ * ̬ͨѧ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode morphChannels(PlaneImage* img, int op, int rx, int ry) {
+    for (int c = 0; c < img->channels; c++) {
+        if (morphPlane(img->plane[c], img->width, img->height, rx, ry, (MorphOp)op) != 0) {
+            return ERR_MEMORY_ALLOC;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ֵͼ̬ѧ ̬ѧ.h morphMaskBitsÿΰλ봦 64 أչ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode morphMask(BitMask* mask, int op, int rx, int ry) {
+    return morphMaskBits(mask->bits, mask->stride, mask->width, mask->height, rx, ry, (MorphOp)op) == 0 ? SUCCESS : ERR_MEMORY_ALLOC;
+}
+
+/**
+ * ֵͨ˲
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode medianChannels(PlaneImage* img, int radius) {
+    if (img->max_val > 255) {
+        return ERR_NOT_8BIT;
+    }
+    int* out = (int*)malloc(sizeof(int) * img->width * img->height);
+    if (out == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    for (int c = 0; c < img->channels; c++) {
+        if (medianFilterPlane(img->plane[c], out, img->width, img->height, radius) != 0) {
+            free(out);
+            return ERR_MEMORY_ALLOC;
+        }
+        int* t = img->plane[c];
+        img->plane[c] = out;
+        out = t;
+    }
+    free(out);
+    return SUCCESS;
+}
+
+/**
+ * ֱͨͼ⻯ֱͨͼһͳƣÿͨһŲұ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode equalizeChannels(PlaneImage* img) {
+    int bins = img->max_val + 1;
+    size_t count = (size_t)img->width * img->height;
+    long long* hist = (long long*)malloc(sizeof(long long) * img->channels * bins);
+    int* lut = (int*)malloc(sizeof(int) * bins);
+    if (hist == NULL || lut == NULL || histPlanes(img->plane, img->channels, count, bins, hist) != 0) {
+        free(hist);
+        free(lut);
+        return ERR_MEMORY_ALLOC;
+    }
+    for (int c = 0; c < img->channels; c++) {
+        histEqualizeLut(hist + (size_t)c * bins, bins, (long long)count, img->max_val, lut);
+        histApplyLut(img->plane[c], count, lut);
+    }
+    free(hist);
+    free(lut);
+    return SUCCESS;
+}
+
+/**
+ * ͨ CLAHE߳ʱ߳
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode claheChannels(PlaneImage* img, int tiles, double clip) {
+    int tiles_x = tiles < img->width ? tiles : img->width;
+    int tiles_y = tiles < img->height ? tiles : img->height;
+    for (int c = 0; c < img->channels; c++) {
+        if (histClahe(img->plane[c], img->width, img->height, img->max_val, tiles_x, tiles_y, clip) != 0) {
+            return ERR_MEMORY_ALLOC;
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ͨ Otsu ֵ 0~ֵ
+ * @return ֵ-1=ڴ治
+ */
+int otsuThreshold(const PlaneImage* img) {
+    int bins = img->max_val + 1;
+    long long* hist = (long long*)malloc(sizeof(long long) * bins);
+    if (hist == NULL || histPlanes(img->plane, 1, (size_t)img->width * img->height, bins, hist) != 0) {
+        free(hist);
+        return -1;
+    }
+    int threshold = histOtsu(hist, bins);
+    free(hist);
+    return threshold;
+}
+
+void printUsage(const char* prog) {
+    printf("÷%s <˲> <.ppm|.pgm> <> [] [--border ʽ] [--threshold T] [--otsu] [--median R] [--rect x0,y0,x1,y1] [--text]\n", prog);
+    printf("  sobel | prewitt | scharr     Ҷݶȷֵ--threshold T ֵ--otsu Զֵ\n");
+    printf("  laplacian                    Ҷ˹ֵ\n");
+    printf("  sharpen                      ͨ\n");
+    printf("  gauss R [sigma]              ͨ˹ģ뾶 1~15sigma Ĭ R/2\n");
+    printf("  kernel ļ                ͨԶˣ߳  ϵ...߳ 127Զ FFT\n");
+    printf("  box R                        ͨʽģͼ뾶ͬ\n");
+    printf("  adaptive R [k]               sobel ֵھֲֵ + k*׼ ʱΪԵk Ĭ 1--threshold T ΪСֵ\n");
+    printf("  median R                     ֵͨ˲8 λͼ񣬰뾶 1~127ʱ뾶޹أ\n");
+    printf("  erode|dilate|open|close RX [RY]  ͨθʴ///գ(2RX+1)x(2RY+1)RY Ĭͬ RXPBM P4  P4\n");
+    printf("  equalize                     ֱͨͼ⻯\n");
+    printf("  clahe [N] [clip]             ͨƶԱȶȵķֿ⻯N*N 飬Ĭ 8clip Ĭ 2\n");
+    printf("  --border constant|clamp|reflect|wrapͼȡ 0 / ƱԵ /  / ѭĬ constant\n");
+    printf("  --median R˲ǰһֵ˲ȥ\n");
+    printf("  --rect x0,y0,x1,y1ӡͼþÿͨĺֵ͡׼ɸΣ\n");
+    printf("  --textıʽ P2/P3Ĭ P5/P6\n");
+}
+
+/**
+ * ̿
+ */
+int main(int argc, char* argv[]) {
+    STATS_INIT(argc, argv);
+    convFftCrossoverFile(argv[0]);  // FFT ֽ߳ʵһκڳԱߣֱ֮Ӷȡ
+
+    // 1. 
+    if (argc < 4) {
+        printUsage(argv[0]);
+        STATS_FINISH();
+        return ERR_BAD_ARGUMENT;
+    }
+    const char* filter = argv[1];
+    const char* input_path = argv[2];
+    const char* output_path = argv[3];
+    const char* params[2] = { NULL, NULL };
+    int param_count = 0;
+    int threshold = -1;
+    int binary = 1;
+    int border = CONV_BORDER_CONSTANT;
+    int rects[MAX_RECTS][4];
+    int rect_count = 0;
+    int median_radius = 0;
+    int otsu = 0;
+    int valid = 1;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--border") == 0 && i + 1 < argc) {
+            border = convBorderByName(argv[++i]);
+            valid &= border >= 0;
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atoi(argv[++i]);
+            valid &= threshold >= 0;
+        }
+        else if (strcmp(argv[i], "--rect") == 0 && i + 1 < argc && rect_count < MAX_RECTS) {
+            int* r = rects[rect_count++];
+            valid &= sscanf(argv[++i], "%d,%d,%d,%d", &r[0], &r[1], &r[2], &r[3]) == 4 && r[0] <= r[2] && r[1] <= r[3];
+        }
+        else if (strcmp(argv[i], "--median") == 0 && i + 1 < argc) {
+            median_radius = atoi(argv[++i]);
+            valid &= median_radius >= 1 && median_radius <= MEDIAN_MAX_RADIUS;
+        }
+        else if (strcmp(argv[i], "--otsu") == 0) {
+            otsu = 1;
+        }
+        else if (strcmp(argv[i], "--text") == 0) {
+            binary = 0;
+        }
+        else if (argv[i][0] != '-' && param_count < 2) {
+            params[param_count++] = argv[i];
+        }
+        else {
+            valid = 0;
+        }
+    }
+
+    // 2. ѡ˲
+    const int* gx_taps = NULL;
+    const int* gy_taps = NULL;
+    int absolute = 0;
+    int box_radius = 0;
+    int median_only = 0;
+    int morph_op = -1;
+    int morph_rx = 0;
+    int morph_ry = 0;
+    int equalize = 0;
+    int clahe_tiles = 0;
+    double clahe_clip = 2.0;
+    int local_radius = 0;
+    double local_k = 1.0;
+    int gauss_radius = 0;
+    double gauss_sigma = 0.0;
+    ConvKernel kernel;
+    ErrorCode ret = SUCCESS;
+    if (strcmp(filter, "sobel") == 0) {
+        gx_taps = SOBEL_GX;
+        gy_taps = SOBEL_GY;
+    }
+    else if (strcmp(filter, "prewitt") == 0) {
+        gx_taps = PREWITT_GX;
+        gy_taps = PREWITT_GY;
+    }
+    else if (strcmp(filter, "scharr") == 0) {
+        gx_taps = SCHARR_GX;
+        gy_taps = SCHARR_GY;
+    }
+    else if (strcmp(filter, "laplacian") == 0) {
+        convKernelInit(&kernel, 3, LAPLACIAN, 1);
+        absolute = 1;
+    }
+    else if (strcmp(filter, "sharpen") == 0) {
+        convKernelInit(&kernel, 3, SHARPEN, 1);
+    }
+    else if (strcmp(filter, "gauss") == 0 && params[0] != NULL) {
+        gauss_radius = atoi(params[0]);
+        gauss_sigma = params[1] != NULL ? atof(params[1]) : gauss_radius / 2.0;
+        valid &= gauss_radius >= 1 && convGaussianKernel(&kernel, gauss_radius, gauss_sigma, 255) == 0;
+    }
+    else if (strcmp(filter, "kernel") == 0 && params[0] != NULL) {
+        ret = readKernel(params[0], &kernel);
+    }
+    else if (strcmp(filter, "box") == 0 && params[0] != NULL) {
+        box_radius = atoi(params[0]);
+        valid &= box_radius >= 1;
+    }
+    else if (strcmp(filter, "median") == 0 && params[0] != NULL) {
+        median_only = atoi(params[0]);
+        valid &= median_only >= 1 && median_only <= MEDIAN_MAX_RADIUS;
+    }
+    else if (morphOpByName(filter) >= 0 && params[0] != NULL) {
+        morph_op = morphOpByName(filter);
+        morph_rx = atoi(params[0]);
+        morph_ry = params[1] != NULL ? atoi(params[1]) : morph_rx;
+        valid &= morph_rx >= 0 && morph_ry >= 0 && morph_rx + morph_ry > 0;
+    }
+    else if (strcmp(filter, "equalize") == 0) {
+        equalize = 1;
+    }
+    else if (strcmp(filter, "clahe") == 0) {
+        clahe_tiles = params[0] != NULL ? atoi(params[0]) : 8;
+        clahe_clip = params[1] != NULL ? atof(params[1]) : 2.0;
+        valid &= clahe_tiles >= 1 && clahe_clip >= 1.0;
+    }
+    else if (strcmp(filter, "adaptive") == 0 && params[0] != NULL) {
+        gx_taps = SOBEL_GX;
+        gy_taps = SOBEL_GY;
+        local_radius = atoi(params[0]);
+        local_k = params[1] != NULL ? atof(params[1]) : 1.0;
+        valid &= local_radius >= 1;
+    }
+    else {
+        valid = 0;
+    }
+    valid &= gx_taps != NULL || threshold < 0;  // ֵֻݶȷֵ
+    valid &= !otsu || (gx_taps != NULL && local_radius == 0 && threshold < 0);
+    if (!valid) {
+        printUsage(argv[0]);
+        STATS_FINISH();
+        return ERR_BAD_ARGUMENT;
+    }
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        STATS_FINISH();
+        return ret;
+    }
+
+    // 3~5. ̬ѧ PBM P4 ʱ̶λͼҲ P4--median--rect ã
+    if (morph_op >= 0) {
+        BitMask mask;
+        STATS_BEGIN(mask_read_span, "read");
+        ret = readPBM(input_path, &mask);
+        STATS_END(mask_read_span, mask.width * mask.height);
+        if (ret != ERR_WRONG_FORMAT) {
+            if (ret == SUCCESS && (median_radius > 0 || rect_count > 0)) {
+                freeMask(&mask);
+                printUsage(argv[0]);
+                STATS_FINISH();
+                return ERR_BAD_ARGUMENT;
+            }
+            if (ret == SUCCESS) {
+                printf("ȡɹ%dx%d أPBM ֵͼ\n", mask.width, mask.height);
+                STATS_BEGIN(mask_span, "filter");
+                ret = morphMask(&mask, morph_op, morph_rx, morph_ry);
+                STATS_END(mask_span, mask.width * mask.height);
+            }
+            if (ret == SUCCESS) {
+                STATS_BEGIN(mask_write_span, "write");
+                ret = writePBM(output_path, &mask);
+                STATS_END(mask_write_span, mask.width * mask.height);
+            }
+            freeMask(&mask);
+            if (ret != SUCCESS) {
+                printf("%s\n", error_messages[ret]);
+                STATS_FINISH();
+                return ret;
+            }
+            printf("ɹ%s\n", output_path);
+            STATS_FINISH();
+            return SUCCESS;
+        }
+    }
+
+    // 3. 
+    PlaneImage img;
+    STATS_BEGIN(read_span, "read");
+    ret = readImage(input_path, &img);
+    STATS_END(read_span, img.width * img.height);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        STATS_FINISH();
+        return ret;
+    }
+    printf("ȡɹ%dx%d أֵ%d\n", img.width, img.height, img.max_val);
+
+    // 4. ֵԤ
+    if (median_radius > 0) {
+        STATS_BEGIN(median_span, "median");
+        ret = medianChannels(&img, median_radius);
+        STATS_END(median_span, img.width * img.height);
+        if (ret != SUCCESS) {
+            freeImage(&img);
+            printf("%s\n", error_messages[ret]);
+            STATS_FINISH();
+            return ret;
+        }
+    }
+
+    // 5. ˲
+    STATS_BEGIN(filter_span, "filter");
+    if (gx_taps != NULL) {
+        ret = gradientMagnitude(&img, gx_taps, gy_taps, (ConvBorder)border);
+        if (ret == SUCCESS && local_radius > 0) {
+            ret = adaptiveThreshold(&img, local_radius, local_k, threshold >= 0 ? threshold : 0);
+        }
+        else if (ret == SUCCESS && otsu) {
+            threshold = otsuThreshold(&img);
+            ret = threshold >= 0 ? SUCCESS : ERR_MEMORY_ALLOC;
+            if (ret == SUCCESS) {
+                printf("Otsu ֵ%d\n", threshold);
+                thresholdPlane(&img, threshold);
+            }
+        }
+        else if (ret == SUCCESS && threshold >= 0) {
+            thresholdPlane(&img, threshold);
+        }
+    }
+    else if (box_radius > 0) {
+        ret = boxChannels(&img, box_radius);
+    }
+    else if (median_only > 0) {
+        ret = medianChannels(&img, median_only);
+    }
+    else if (morph_op >= 0) {
+        ret = morphChannels(&img, morph_op, morph_rx, morph_ry);
+    }
+    else if (equalize) {
+        ret = equalizeChannels(&img);
+    }
+    else if (clahe_tiles > 0) {
+        ret = claheChannels(&img, clahe_tiles, clahe_clip);
+    }
+    else {
+        if (gauss_radius > 0) {
+            convGaussianKernel(&kernel, gauss_radius, gauss_sigma, img.max_val);  // 16 λʱϵСۼӲ
+        }
+        if (absolute) {
+            toGray(&img);
+        }
+        if (!convKernelFits(&kernel, img.max_val)) {
+            ret = ERR_KERNEL_RANGE;
+        }
+        else {
+            printf("ʽ%s\n", convUsesFft(&kernel) ? "FFT ֿ" : "ֱӾ");
+            ret = convolveChannels(&img, &kernel, absolute, (ConvBorder)border);
+        }
+        if (ret == SUCCESS && absolute && border == CONV_BORDER_CONSTANT) {
+            clearBorder(img.plane[0], img.width, img.height);
+        }
+    }
+    STATS_END(filter_span, img.width * img.height);
+    if (ret == SUCCESS) {
+        ret = printRectStats(&img, rects, rect_count);
+    }
+
+    // 6. 
+    if (ret == SUCCESS) {
+        STATS_BEGIN(write_span, "write");
+        ret = writeImage(output_path, &img, binary);
+        STATS_END(write_span, img.width * img.height);
+    }
+    freeImage(&img);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        STATS_FINISH();
+        return ret;
+    }
+    printf("ɹ%s\n", output_path);
+    STATS_FINISH();
+    return SUCCESS;
+}
\ No newline at end of file
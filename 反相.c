@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "ͳ.h"
 
 //TYPE BEGIN
 typedef struct {
@@ -66,6 +67,7 @@ void read() {
 	inPPM.height = height;
 	inPPM.colorset = colorset;
 	inPPM.data = malloc(sizeof(Pixel) * width * height);
+	STATS_ALLOC(sizeof(Pixel) * width * height);
 	int r, g, b;
 	for (int y = 0; y < height; y++) {
 		for (int x = 0; x < width; x++) {
@@ -80,6 +82,7 @@ void read() {
 			}
 		}
 	}
+	STATS_BYTES_READ(ftell(stdin));
 	fclose(stdin);
 }
 
@@ -107,6 +110,7 @@ void write() {
 		return;
 	}
 	fflush(file);
+	STATS_BYTES_WRITTEN(ftell(file));
 	fclose(file);
 }
 
@@ -128,17 +132,28 @@ void handle() {
 	outPPM.height = height;
 	outPPM.colorset = inPPM.colorset;
 	outPPM.data = malloc(sizeof(Pixel) * width * height);
+	STATS_ALLOC(sizeof(Pixel) * width * height);
+	STATS_BEGIN(kernel_span, "invert");
 	for (int y = 0; y < height; y++) {
 		for (int x = 0; x < width; x++) {
 			outPPM.data[x + y * width] = invert(inPPM.data + x + y * width, inPPM.colorset);
 		}
 	}
+	STATS_END(kernel_span, width * height);
 }
 //FUNCTION END
 
-int main() {
+int main(int argc, char* argv[]) {
+	STATS_INIT(argc, argv);
+	STATS_BEGIN(read_span, "read");
 	read();
+	STATS_END(read_span, inPPM.width * inPPM.height);
+	STATS_BEGIN(handle_span, "handle");
 	handle();
+	STATS_END(handle_span, outPPM.width * outPPM.height);
+	STATS_BEGIN(write_span, "write");
 	write();
+	STATS_END(write_span, outPPM.width * outPPM.height);
+	STATS_FINISH();
 	return ERR_STATE;
 }
\ No newline at end of file
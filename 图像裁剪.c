@@ -1,7 +1,15 @@
 #define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include "ͳ.h"
+#include ".h"
+#include "д.h"
+#include ".h"
 
 // ؽṹ壨RGBͨ
 typedef struct {
@@ -27,7 +35,9 @@ typedef enum {
     ERR_MEMORY_ALLOC,
     ERR_FILE_BROKEN,
     ERR_WRITE_FAILED,
-    ERR_CROP_OUT_OF_BOUNDS
+    ERR_CROP_OUT_OF_BOUNDS,
+    ERR_BAD_SCALE,
+    ERR_BAD_BOXES
 } ErrorCode;
 
 // ȫִϢӳ
@@ -39,7 +49,9 @@ const char* error_messages[] = {
     "ڴʧ",
     "ļ",
     "дļʧ",
-    "󣺲ü򳬳ͼ߽"
+    "󣺲ü򳬳ͼ߽",
+    "ųߴ粻Ϸ",
+    "󣺲üбϷ--boxes ļÿ x0 y0  ߣ--grid   x y"
 };
 
 /**
@@ -47,18 +59,20 @@ const char* error_messages[] = {
  */
 void freePPM(PPM* ppm) {
     if (ppm != NULL && ppm->data != NULL) {
+        STATS_FREE(sizeof(Pixel) * ppm->width * ppm->height);
         free(ppm->data);
         ppm->data = NULL;
     }
 }
 
 /**
- * ȡPPM P3ʽͼ
+ * ȡPPM P3ʽͼǰУıʽ޷У֮вٽ
  * @param filenameļ·
- * @param ppmPPMṹ壨ǰ
+ * @param ppmPPMṹ壨ǰheight Ϊʵʶ
+ * @param rows
  * @return 루SUCCESS=ɹ
  */
-ErrorCode readPPM(const char* filename, PPM* ppm) {
+ErrorCode readPPMRows(const char* filename, PPM* ppm, int rows) {
     // ʼPPMṹ
     ppm->width = 0;
     ppm->height = 0;
@@ -96,6 +110,7 @@ ErrorCode readPPM(const char* filename, PPM* ppm) {
         fclose(file);
         return ERR_ILLEGAL_SIZE;
     }
+    ppm->height = ppm->height < rows ? ppm->height : rows;
 
     // ڴ
     ppm->data = (Pixel*)malloc(sizeof(Pixel) * ppm->width * ppm->height);
@@ -103,6 +118,7 @@ ErrorCode readPPM(const char* filename, PPM* ppm) {
         fclose(file);
         return ERR_MEMORY_ALLOC;
     }
+    STATS_ALLOC(sizeof(Pixel) * ppm->width * ppm->height);
 
     // ȡ
     for (int i = 0; i < ppm->width * ppm->height; i++) {
@@ -113,10 +129,31 @@ ErrorCode readPPM(const char* filename, PPM* ppm) {
         }
     }
 
+    STATS_BYTES_READ(ftell(file));
     fclose(file);
     return SUCCESS;
 }
 
+/**
+ * ȡPPM P3ʽͼ
+ * @param filenameļ·
+ * @param ppmPPMṹ壨ǰ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readPPM(const char* filename, PPM* ppm) {
+    return readPPMRows(filename, ppm, INT_MAX);
+}
+
+/**
+ * һڣÿһ memcpy÷У߽磩
+ * @param dst cropW*cropH 
+ */
+void copyWindow(const PPM* in, int x0, int y0, int cropW, int cropH, Pixel* dst) {
+    for (int y = 0; y < cropH; y++) {
+        memcpy(dst + (size_t)y * cropW, in->data + x0 + (size_t)(y0 + y) * in->width, sizeof(Pixel) * cropW);
+    }
+}
+
 /**
  * ͼüĺȫ棬ԶУ߽磩
  * @param inԭͼ
@@ -151,24 +188,56 @@ ErrorCode cropPPM(const PPM* in, PPM* out, int x0, int y0, int cropW, int cropH)
     if (out->data == NULL) {
         return ERR_MEMORY_ALLOC;
     }
+    STATS_ALLOC(sizeof(Pixel) * cropW * cropH);
 
-    // Ĳü߼ظƲü
-    for (int y = 0; y < cropH; y++) {          // üͼ
-        for (int x = 0; x < cropW; x++) {      // üͼ
-            // ԭͼжӦص(x0 + x) + (y0 + y) * ԭ
-            int inIndex = (x0 + x) + (y0 + y) * in->width;
-            // üͼx + y * ü
-            int outIndex = x + y * cropW;
-            // 
-            out->data[outIndex] = in->data[inIndex];
-        }
+    // Ĳü߼üÿԭͼģи
+    STATS_BEGIN(crop_span, "crop");
+    copyWindow(in, x0, y0, cropW, cropH, out->data);
+    STATS_END(crop_span, cropW * cropH);
+
+    return SUCCESS;
+}
+
+/**
+ * ţ .hȺزС 4 ķʽС
+ * @param inͼͨΪü
+ * @param outͼ
+ * @param scaleWźȣ1
+ * @param scaleHź߶ȣ1
+ * @param filterRESIZE_BOX / RESIZE_BILINEAR / RESIZE_BICUBIC / RESIZE_LANCZOS3
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode resizePPM(const PPM* in, PPM* out, int scaleW, int scaleH, ResizeFilter filter) {
+    if (in == NULL || out == NULL || in->data == NULL) {
+        return ERR_FILE_BROKEN;
+    }
+    if (scaleW <= 0 || scaleH <= 0) {
+        return ERR_BAD_SCALE;
     }
 
+    out->width = scaleW;
+    out->height = scaleH;
+    out->max_val = in->max_val;
+    out->data = (Pixel*)malloc(sizeof(Pixel) * scaleW * scaleH);
+    if (out->data == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC(sizeof(Pixel) * scaleW * scaleH);
+
+    // Pixel{int r, g, b} 鰴 int 
+    STATS_BEGIN(resize_span, "resize");
+    int failed = resizeImage((const int*)in->data, in->width, in->height, (int*)out->data, scaleW, scaleH,
+        3, in->max_val, filter, 2);
+    STATS_END(resize_span, scaleW * scaleH);
+    if (failed) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
     return SUCCESS;
 }
 
 /**
- * PPM P3ʽͼ
+ * PPM P3ʽͼ񣨸диʽԤļƫд룬 д.h
  * @param filenameļ·
  * @param ppmPPMͼ
  * @return 루SUCCESS=ɹ
@@ -178,39 +247,159 @@ ErrorCode writePPM(const char* filename, const PPM* ppm) {
         return ERR_WRITE_FAILED;
     }
 
-    // ļıģʽд룩
-    FILE* file = fopen(filename, "w");
-    if (file == NULL) {
+    long long written = parallelWritePPM(filename, (const int*)ppm->data, ppm->width, ppm->height, ppm->max_val, 0);
+    if (written < 0) {
         return ERR_WRITE_FAILED;
     }
+    STATS_BYTES_WRITTEN(written);
+    return SUCCESS;
+}
 
-    // дļͷħߡֵ
-    if (fprintf(file, "P3\n") < 0 ||
-        fprintf(file, "%d %d\n", ppm->width, ppm->height) < 0 ||
-        fprintf(file, "%d\n", ppm->max_val) < 0) {
-        fclose(file);
-        return ERR_WRITE_FAILED;
+//========== üһν룬ڣ ==========
+
+// üб
+typedef struct {
+    int count;       // ڸ
+    int capacity;    // ѷ
+    int (*box)[4];   // ÿڣx0 y0  
+} CropList;
+
+void freeCropList(CropList* list) {
+    free(list->box);
+    memset(list, 0, sizeof(CropList));
+}
+
+/**
+ * ׷һڣ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode cropListAdd(CropList* list, int x0, int y0, int cropW, int cropH) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        int (*box)[4] = (int (*)[4])realloc(list->box, sizeof(int[4]) * capacity);
+        if (box == NULL) {
+            return ERR_MEMORY_ALLOC;
+        }
+        list->box = box;
+        list->capacity = capacity;
     }
+    int* b = list->box[list->count++];
+    b[0] = x0;
+    b[1] = y0;
+    b[2] = cropW;
+    b[3] = cropH;
+    return SUCCESS;
+}
 
-    // дݣÿ3أʽգ
-    for (int i = 0; i < ppm->width * ppm->height; i++) {
-        if (fprintf(file, "%d %d %d ", ppm->data[i].r, ppm->data[i].g, ppm->data[i].b) < 0) {
-            fclose(file);
-            return ERR_WRITE_FAILED;
+/**
+ * 봰бļÿ x0 y0  ߣ# ֮Ϊעͣ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readCropList(const char* filename, CropList* list) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    char line[256];
+    ErrorCode ret = SUCCESS;
+    while (ret == SUCCESS && fgets(line, sizeof(line), file) != NULL) {
+        char* comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
         }
-        if ((i + 1) % 3 == 0) {  // ÿ3ػУɶ
-            fprintf(file, "\n");
+        int b[4];
+        char rest;
+        int n = sscanf(line, "%d%d%d%d %c", &b[0], &b[1], &b[2], &b[3], &rest);
+        if (n == EOF) {
+            continue;  // лֻע
         }
+        ret = n == 4 ? cropListAdd(list, b[0], b[1], b[2], b[3]) : ERR_BAD_BOXES;
     }
-
     fclose(file);
+    if (ret == SUCCESS && list->count == 0) {
+        ret = ERR_BAD_BOXES;
+    }
+    return ret;
+}
+
+/**
+ * ̶ͼĴڣֻȡͼڵģȣ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode gridCropList(CropList* list, int width, int height, int cropW, int cropH, int strideX, int strideY) {
+    for (int y0 = 0; y0 + cropH <= height; y0 += strideY) {
+        for (int x0 = 0; x0 + cropW <= width; x0 += strideX) {
+            ErrorCode ret = cropListAdd(list, x0, y0, cropW, cropH);
+            if (ret != SUCCESS) {
+                return ret;
+            }
+        }
+    }
+    return list->count > 0 ? SUCCESS : ERR_CROP_OUT_OF_BOUNDS;
+}
+
+/**
+ * дõµĴڵױߣıֻһ
+ */
+int cropListRows(const CropList* list) {
+    int rows = 0;
+    for (int i = 0; i < list->count; i++) {
+        int bottom = list->box[i][1] + list->box[i][3];
+        rows = bottom > rows ? bottom : rows;
+    }
+    return rows;
+}
+
+/**
+ * ͬһѽͼóдڲдڲУ memcpyд д.h
+ * @param pattern·ʽ%d Ϊţ 0 ʼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writeCrops(const PPM* in, const CropList* list, const char* pattern) {
+    for (int i = 0; i < list->count; i++) {
+        const int* b = list->box[i];
+        if (b[0] < 0 || b[1] < 0 || b[2] <= 0 || b[3] <= 0 || b[0] + b[2] > in->width || b[1] + b[3] > in->height) {
+            return ERR_CROP_OUT_OF_BOUNDS;
+        }
+    }
+
+    // Լ仺塢ơдڴС̬ܲͬ
+    int failed = 0;  // 1=ڴ治㣬2=дʧ
+    long long written = 0;
+    #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed) reduction(+:written)
+    for (int i = 0; i < list->count; i++) {
+        const int* b = list->box[i];
+        Pixel* window = (Pixel*)malloc(sizeof(Pixel) * b[2] * b[3]);
+        if (window == NULL) {
+            failed |= 1;
+            continue;
+        }
+        copyWindow(in, b[0], b[1], b[2], b[3], window);
+        char path[512];
+        snprintf(path, sizeof(path), pattern, i);
+        long long n = parallelWritePPM(path, (const int*)window, b[2], b[3], in->max_val, 0);
+        if (n < 0) {
+            failed |= 2;
+        }
+        else {
+            written += n;
+        }
+        free(window);
+    }
+    STATS_BYTES_WRITTEN(written);
+    if (failed) {
+        return (failed & 1) ? ERR_MEMORY_ALLOC : ERR_WRITE_FAILED;
+    }
     return SUCCESS;
 }
 
 /**
  * ü̿
  */
-int main() {
+int main(int argc, char* argv[]) {
+    STATS_INIT(argc, argv);
+    RESULT_CACHE_INIT(argc, argv);
+
     // 1. òɸ޸ģ
     const char* input_path = "C:\\code\\001 ͼѧϰ\\man.ppm";       // PPMͼ·
     const char* output_path = "C:\\code\\001 ͼѧϰ\\(ü)man.ppm";  // üͼ·
@@ -218,6 +407,79 @@ int main() {
     int crop_y0 = 50;    // üϽ0-based
     int crop_width = 500; // üͼ
     int crop_height = 750; // üͼ߶
+    int scale_width = 0;   // üŵĿȣ0=
+    int scale_height = 0;  // üŵĸ߶ȣ0=
+    ResizeFilter scale_filter = RESIZE_LANCZOS3;  // ˲
+    const char* multi_pattern = "C:\\code\\001 ͼѧϰ\\(ü)man.%d.ppm";  // üʱ i ڵ·
+    const char* boxes_path = NULL;  // --boxes ļÿһ x0 y0  
+    int grid[4] = { 0, 0, 0, 0 };   // --grid   x y̶ͼĴ
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--boxes") == 0 && i + 1 < argc) {
+            boxes_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--grid") == 0 && i + 4 < argc) {
+            for (int k = 0; k < 4; k++) {
+                grid[k] = atoi(argv[++i]);
+            }
+            if (grid[0] <= 0 || grid[1] <= 0 || grid[2] <= 0 || grid[3] <= 0) {
+                printf("%s\n", error_messages[ERR_BAD_BOXES]);
+                STATS_FINISH();
+                return ERR_BAD_BOXES;
+            }
+        }
+    }
+
+    // 2~5. ģʽֻһΣдڲвüдļ߽棬Ҳţ
+    if (boxes_path != NULL || grid[0] > 0) {
+        CropList list;
+        memset(&list, 0, sizeof(CropList));
+        ErrorCode multi_ret = boxes_path != NULL ? readCropList(boxes_path, &list) : SUCCESS;
+        int rows = boxes_path != NULL ? cropListRows(&list) : INT_MAX;  // Ҫͼ
+        PPM in_ppm;
+        memset(&in_ppm, 0, sizeof(PPM));
+        if (multi_ret == SUCCESS) {
+            printf("ڶȡͼ%s...\n", input_path);
+            STATS_BEGIN(read_span, "read");
+            multi_ret = readPPMRows(input_path, &in_ppm, rows);
+            STATS_END(read_span, in_ppm.width * in_ppm.height);
+        }
+        if (multi_ret == SUCCESS && grid[0] > 0) {
+            multi_ret = gridCropList(&list, in_ppm.width, in_ppm.height, grid[0], grid[1], grid[2], grid[3]);
+        }
+        if (multi_ret == SUCCESS) {
+            printf("ȡɹ %dx%d أڲü %d ...\n", in_ppm.width, in_ppm.height, list.count);
+            STATS_BEGIN(multi_span, "handle");
+            multi_ret = writeCrops(&in_ppm, &list, multi_pattern);
+            STATS_END(multi_span, in_ppm.width * in_ppm.height);
+        }
+        freePPM(&in_ppm);
+        freeCropList(&list);
+        if (multi_ret != SUCCESS) {
+            printf("%s\n", error_messages[multi_ret]);
+            STATS_FINISH();
+            return multi_ret;
+        }
+        printf("ɹ\n");
+        STATS_FINISH();
+        return SUCCESS;
+    }
+
+    // üûʱֱȡĽ --cache DIR 
+    ResultKey cache_key;
+    resultKeyInit(&cache_key, "crop");
+    resultKeyAddFile(&cache_key, input_path);
+    resultKeyAddInt(&cache_key, "x0", crop_x0);
+    resultKeyAddInt(&cache_key, "y0", crop_y0);
+    resultKeyAddInt(&cache_key, "width", crop_width);
+    resultKeyAddInt(&cache_key, "height", crop_height);
+    resultKeyAddInt(&cache_key, "scale_width", scale_width);
+    resultKeyAddInt(&cache_key, "scale_height", scale_height);
+    resultKeyAddInt(&cache_key, "scale_filter", scale_filter);
+    if (resultCacheFetch(&cache_key, output_path)) {
+        printf("Ѵӽд%s\n", output_path);
+        STATS_FINISH();
+        return SUCCESS;
+    }
 
     // 2. PPMṹ
     PPM in_ppm, out_ppm;
@@ -226,9 +488,12 @@ int main() {
 
     // 3. ȡͼ
     printf("ڶȡͼ%s...\n", input_path);
+    STATS_BEGIN(read_span, "read");
     ErrorCode read_ret = readPPM(input_path, &in_ppm);
+    STATS_END(read_span, in_ppm.width * in_ppm.height);
     if (read_ret != SUCCESS) {
         printf("%s\n", error_messages[read_ret]);
+        STATS_FINISH();
         return read_ret;
     }
     printf("ȡɹԭͼߴ %dx%d أֵ%d\n",
@@ -237,29 +502,54 @@ int main() {
     // 4. ִͼü
     printf("ڲüͼʼ(%d,%d)üߴ %dx%d...\n",
         crop_x0, crop_y0, crop_width, crop_height);
+    STATS_BEGIN(handle_span, "handle");
     ErrorCode crop_ret = cropPPM(&in_ppm, &out_ppm, crop_x0, crop_y0, crop_width, crop_height);
+    STATS_END(handle_span, out_ppm.width * out_ppm.height);
     if (crop_ret != SUCCESS) {
         printf("%s\n", error_messages[crop_ret]);
         freePPM(&in_ppm);
         freePPM(&out_ppm);
+        STATS_FINISH();
         return crop_ret;
     }
     printf("üɹͼߴ %dx%d \n", out_ppm.width, out_ppm.height);
 
+    // 4.5 Ųüͬһνɣдһ飩
+    if (scale_width > 0 || scale_height > 0) {
+        PPM scaled_ppm;
+        memset(&scaled_ppm, 0, sizeof(PPM));
+        printf("ͼ%dx%d -> %dx%d...\n", out_ppm.width, out_ppm.height, scale_width, scale_height);
+        ErrorCode scale_ret = resizePPM(&out_ppm, &scaled_ppm, scale_width, scale_height, scale_filter);
+        if (scale_ret != SUCCESS) {
+            printf("%s\n", error_messages[scale_ret]);
+            freePPM(&in_ppm);
+            freePPM(&out_ppm);
+            STATS_FINISH();
+            return scale_ret;
+        }
+        freePPM(&out_ppm);
+        out_ppm = scaled_ppm;
+    }
+
     // 5. ü
     printf("ڱüͼ%s...\n", output_path);
+    STATS_BEGIN(write_span, "write");
     ErrorCode write_ret = writePPM(output_path, &out_ppm);
+    STATS_END(write_span, out_ppm.width * out_ppm.height);
     if (write_ret != SUCCESS) {
         printf("%s\n", error_messages[write_ret]);
         freePPM(&in_ppm);
         freePPM(&out_ppm);
+        STATS_FINISH();
         return write_ret;
     }
     printf("ɹ\n");
+    resultCacheStore(&cache_key, output_path);
 
     // 6. ͷŶ̬ڴ
     freePPM(&in_ppm);
     freePPM(&out_ppm);
 
+    STATS_FINISH();
     return SUCCESS;
 }
\ No newline at end of file
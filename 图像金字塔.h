@@ -0,0 +1,196 @@
+/**
+ * ͼ˹5 ͷ 1-4-6-4-1 ģигȡϳһ˹
+ *
+ * вһηڴ 0 ǰμ룬ԼΪԭͼ 4/3 offset С
+ * ÿΪһ (n+1)/2Сһ㲻С 3x3Sobel ҪͼⰴԱԵΪ᾵ȡֵdcb|abcd
+ * ˹һɣ÷ÿдõ 0 о͵ pyramidRowsReady
+ * һ 5 жѾ߲㴫ݣжڸд롢ڻʱȡ
+ * ֻ谴жһ顣ÿֻżλü㣺 5 ӣٺȡ 5 ͷ
+ * ˹ l  = ˹ l  -  l+1 Ŵ󣨲 0 ͬһ *4߲㼴˹߲㣻ɲм㡣
+ * ÷
+ *   Pyramid p;
+ *   pyramidInit(&p, width, height, 4);
+ *   for (int y = 0; y < height; y++) {
+ *       ... д pyramidLevel(&p, 0) + y * width ...
+ *       pyramidRowsReady(&p, y + 1);
+ *   }
+ *   pyramidFree(&p);
+ */
+#ifndef IMAGE_PYRAMID_H
+#define IMAGE_PYRAMID_H
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PYRAMID_MAX_LEVELS 16  // 
+#define PYRAMID_MIN_SIZE 3     // ÿߵ
+
+typedef struct {
+    int levels;
+    int width[PYRAMID_MAX_LEVELS];
+    int height[PYRAMID_MAX_LEVELS];
+    size_t offset[PYRAMID_MAX_LEVELS];  //  data е
+    int ready[PYRAMID_MAX_LEVELS];      // 
+    int* data;                          // вţĩβһۼӵĹ
+    int* row;                           //  0  + 4Ҹ 2 
+} Pyramid;
+
+static inline int* pyramidLevel(const Pyramid* p, int level) {
+    return p->data + p->offset[level];
+}
+
+static inline void pyramidFree(Pyramid* p) {
+    free(p->data);
+    p->data = NULL;
+    p->row = NULL;
+    p->levels = 0;
+}
+
+/**
+ * ߴδʼ
+ * @param levelsϣĲ 0 㣩ߴ粻ʱԶ
+ * @return 0=ɹ-1=ߴ粻Ϸڴ治
+ */
+static inline int pyramidInit(Pyramid* p, int width, int height, int levels) {
+    memset(p, 0, sizeof(Pyramid));
+    if (width < PYRAMID_MIN_SIZE || height < PYRAMID_MIN_SIZE || levels < 1) {
+        return -1;
+    }
+    levels = levels < PYRAMID_MAX_LEVELS ? levels : PYRAMID_MAX_LEVELS;
+    size_t total = 0;
+    for (int l = 0; l < levels; l++) {
+        if (l > 0) {
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+            if (width < PYRAMID_MIN_SIZE || height < PYRAMID_MIN_SIZE) {
+                break;
+            }
+        }
+        p->width[l] = width;
+        p->height[l] = height;
+        p->offset[l] = total;
+        total += (size_t)width * height;
+        p->levels = l + 1;
+    }
+    p->data = (int*)malloc(sizeof(int) * (total + p->width[0] + 4));
+    if (p->data == NULL) {
+        p->levels = 0;
+        return -1;
+    }
+    p->row = p->data + total;
+    return 0;
+}
+
+// ±꣨101 ʽn >= 3 ʱ -2 ~ n+1 Ч
+static inline int pyramidReflect(int i, int n) {
+    if (i < 0) {
+        return -i;
+    }
+    return i < n ? i : 2 * n - 2 - i;
+}
+
+/**
+ * ɵ level-1  level ĵ y У(1 4 6 4 1)^T (1 4 6 4 1) / 256
+ */
+static inline void pyramidDownRow(Pyramid* p, int level, int y) {
+    int w0 = p->width[level - 1];
+    int h0 = p->height[level - 1];
+    const int* src = pyramidLevel(p, level - 1);
+    const int* r0 = src + (size_t)pyramidReflect(2 * y - 2, h0) * w0;
+    const int* r1 = src + (size_t)pyramidReflect(2 * y - 1, h0) * w0;
+    const int* r2 = src + (size_t)pyramidReflect(2 * y, h0) * w0;
+    const int* r3 = src + (size_t)pyramidReflect(2 * y + 1, h0) * w0;
+    const int* r4 = src + (size_t)pyramidReflect(2 * y + 2, h0) * w0;
+    int* t = p->row + 2;  // t[-2] ~ t[w0+1] Ч
+    for (int x = 0; x < w0; x++) {
+        t[x] = r0[x] + 4 * (r1[x] + r3[x]) + 6 * r2[x] + r4[x];
+    }
+    t[-2] = t[2];
+    t[-1] = t[1];
+    t[w0] = t[w0 - 2];
+    t[w0 + 1] = t[w0 - 3];
+    int* dst = pyramidLevel(p, level) + (size_t)y * p->width[level];
+    for (int x = 0; x < p->width[level]; x++) {
+        const int* c = t + 2 * x;
+        dst[x] = (c[-2] + 4 * (c[-1] + c[1]) + 6 * c[0] + c[2] + 128) >> 8;
+    }
+}
+
+/**
+ *  0 ǰ rows дãѸ㷲ж
+ */
+static inline void pyramidRowsReady(Pyramid* p, int rows) {
+    p->ready[0] = rows;
+    for (int l = 1; l < p->levels; l++) {
+        int below = p->ready[l - 1];
+        int last = p->height[l - 1] - 1;
+        while (p->ready[l] < p->height[l]) {
+            int y = p->ready[l];
+            int need = 2 * y + 2 < last ? 2 * y + 2 : last;  // ҪһУµоϷ
+            if (need >= below) {
+                break;
+            }
+            pyramidDownRow(p, l, y);
+            p->ready[l]++;
+        }
+    }
+}
+
+/**
+ *  0 ɸ˹src Ϊ width[0]*height[0] ƽ棩
+ */
+static inline void pyramidBuild(Pyramid* p, const int* src) {
+    size_t count = (size_t)p->width[0] * p->height[0];
+    memcpy(pyramidLevel(p, 0), src, sizeof(int) * count);
+    p->ready[0] = 0;
+    for (int l = 1; l < p->levels; l++) {
+        p->ready[l] = 0;
+    }
+    pyramidRowsReady(p, p->height[0]);
+}
+
+/**
+ * ˹lap Ȱ gauss ͬĳߴ pyramidInit
+ * Ŵһ㣺żλȡ (1 6 1)/8λȡ (4 4)/8ˣ( + 32) >> 6
+ */
+static inline void pyramidLaplacian(const Pyramid* gauss, Pyramid* lap) {
+    int top = gauss->levels - 1;
+    memcpy(pyramidLevel(lap, top), pyramidLevel(gauss, top), sizeof(int) * gauss->width[top] * gauss->height[top]);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int l = 0; l < top; l++) {
+        int w0 = gauss->width[l];
+        int h0 = gauss->height[l];
+        int w1 = gauss->width[l + 1];
+        int h1 = gauss->height[l + 1];
+        const int* g0 = pyramidLevel(gauss, l);
+        const int* g1 = pyramidLevel(gauss, l + 1);
+        int* dst = pyramidLevel(lap, l);
+        for (int y = 0; y < h0; y++) {
+            int k = y / 2;
+            int wy[3] = { 1, 6, 1 };
+            int ry[3] = { pyramidReflect(k - 1, h1), k, pyramidReflect(k + 1, h1) };
+            if (y & 1) {
+                wy[0] = 0;
+                wy[1] = 4;
+                wy[2] = 4;
+            }
+            for (int x = 0; x < w0; x++) {
+                int j = x / 2;
+                int left = pyramidReflect(j - 1, w1);
+                int right = pyramidReflect(j + 1, w1);
+                int sum = 0;
+                for (int i = 0; i < 3; i++) {
+                    const int* r = g1 + (size_t)ry[i] * w1;
+                    int h = (x & 1) ? 4 * (r[j] + r[right]) : r[left] + 6 * r[j] + r[right];
+                    sum += wy[i] * h;
+                }
+                dst[(size_t)y * w0 + x] = g0[(size_t)y * w0 + x] - ((sum + 32) >> 6);
+            }
+        }
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,590 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// 64 λļƫ
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#else
+#define fseek64 fseeko
+#endif
+
+#define TILE 64  //  TILE x TILE Ƭ¼
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_CROP_OUT_OF_BOUNDS,
+    ERR_BAD_ARGUMENT
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PPM P3/P6ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "󣺲ü򳬳ͼ߽",
+    "вϷ"
+};
+
+// 8 λ RGB ͼÿ 3 ֽ
+typedef struct {
+    int width;
+    int height;
+    int max_val;
+    unsigned char* data;
+} Image;
+
+// һеĲ <>.state йһαȽ
+typedef struct {
+    char op[16];      // blur / crop
+    int width;        // ߴ
+    int height;
+    int max_val;
+    int p[5];         // blurradius x1 y1 x2 y2cropx0 y0 width height
+    long header_len;  // ļͷȣݵʼƫƣ
+} RunState;
+
+//========== PPM д ==========
+
+/**
+ * հ # ע
+ */
+int skipSpace(FILE* file) {
+    int ch = fgetc(file);
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = fgetc(file);
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = fgetc(file);
+    }
+    return ch;
+}
+
+/**
+ * ȡһǸASCII
+ * @return 0=ɹ-1=ʧ
+ */
+int readNumber(FILE* file, int* value) {
+    int ch = skipSpace(file);
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    long long v = 0;
+    while (ch >= '0' && ch <= '9') {
+        v = v * 10 + (ch - '0');
+        if (v > 0x7fffffff) {
+            return -1;
+        }
+        ch = fgetc(file);
+    }
+    if (ch != EOF) {
+        ungetc(ch, file);
+    }
+    *value = (int)v;
+    return 0;
+}
+
+/**
+ * ȡPPMͼP3P6ֵ 255
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readImage(const char* filename, Image* img) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    char magic[2];
+    if (fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '3' && magic[1] != '6')) {
+        fclose(file);
+        return ERR_WRONG_FORMAT;
+    }
+    if (readNumber(file, &img->width) != 0 || readNumber(file, &img->height) != 0 ||
+        readNumber(file, &img->max_val) != 0) {
+        fclose(file);
+        return ERR_FILE_BROKEN;
+    }
+    if (img->width <= 0 || img->height <= 0 || img->max_val <= 0 || img->max_val > 255) {
+        fclose(file);
+        return ERR_ILLEGAL_SIZE;
+    }
+    size_t n = (size_t)img->width * img->height * 3;
+    img->data = (unsigned char*)malloc(n);
+    if (img->data == NULL) {
+        fclose(file);
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = SUCCESS;
+    if (magic[1] == '6') {
+        fgetc(file);
+        if (fread(img->data, 1, n, file) != n) {
+            ret = ERR_FILE_BROKEN;
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; i++) {
+            int v;
+            if (readNumber(file, &v) != 0 || v > img->max_val) {
+                ret = ERR_FILE_BROKEN;
+                break;
+            }
+            img->data[i] = (unsigned char)v;
+        }
+    }
+    fclose(file);
+    if (ret != SUCCESS) {
+        free(img->data);
+        img->data = NULL;
+    }
+    return ret;
+}
+
+/**
+ * дP6ͼ
+ * @param header_lenļͷ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writeImage(const char* filename, const Image* img, long* header_len) {
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    int len = fprintf(file, "P6\n%d %d\n%d\n", img->width, img->height, img->max_val);
+    size_t n = (size_t)img->width * img->height * 3;
+    int failed = len < 0 || fwrite(img->data, 1, n, file) != n;
+    failed |= fclose(file) != 0;
+    *header_len = len;
+    return failed ? ERR_WRITE_FAILED : SUCCESS;
+}
+
+void freeImage(Image* img) {
+    free(img->data);
+    img->data = NULL;
+}
+
+/**
+ * ȡļС
+ * @return ֽļڷ -1
+ */
+long long fileSize(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    fseek64(file, 0, SEEK_END);
+#ifdef _WIN32
+    long long size = _ftelli64(file);
+#else
+    long long size = (long long)ftello(file);
+#endif
+    fclose(file);
+    return size;
+}
+
+//========== ״̬ļ ==========
+
+int loadState(const char* path, RunState* state) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    int n = fscanf(file, "%15s %d %d %d %d %d %d %d %d %ld", state->op, &state->width, &state->height,
+        &state->max_val, &state->p[0], &state->p[1], &state->p[2], &state->p[3], &state->p[4], &state->header_len);
+    fclose(file);
+    return n == 10 ? 0 : -1;
+}
+
+ErrorCode saveState(const char* path, const RunState* state) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    int failed = fprintf(file, "%s %d %d %d %d %d %d %d %d %ld\n", state->op, state->width, state->height,
+        state->max_val, state->p[0], state->p[1], state->p[2], state->p[3], state->p[4], state->header_len) < 0;
+    failed |= fclose(file) != 0;
+    return failed ? ERR_WRITE_FAILED : SUCCESS;
+}
+
+//========== ں ==========
+
+double weight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+/**
+ * һΣͬ ˹ģ.csigma=5Խذɫƣbox ԭƣ
+ * @param table(2r+1)^2 Ȩأ dx 㡢dy ڲ
+ */
+void blurRect(const Image* in, Image* out, int radius, const double* table, double sum_weight,
+    const int* box, int rx0, int ry0, int rx1, int ry1) {
+    int width = in->width;
+    int height = in->height;
+    for (int y = ry0; y < ry1; y++) {
+        for (int x = rx0; x < rx1; x++) {
+            unsigned char* d = out->data + ((size_t)y * width + x) * 3;
+            if (!(box[0] <= x && x <= box[2] && box[1] <= y && y <= box[3])) {
+                memcpy(d, in->data + ((size_t)y * width + x) * 3, 3);
+                continue;
+            }
+            int r = 0, g = 0, b = 0;
+            const double* wt = table;
+            for (int i = x - radius; i <= x + radius; i++) {
+                for (int j = y - radius; j <= y + radius; j++, wt++) {
+                    if (i < 0 || j < 0 || i >= width || j >= height) {
+                        continue;  // BLACK
+                    }
+                    const unsigned char* s = in->data + ((size_t)j * width + i) * 3;
+                    r += *wt * s[0];
+                    g += *wt * s[1];
+                    b += *wt * s[2];
+                }
+            }
+            d[0] = (unsigned char)(r / sum_weight);
+            d[1] = (unsigned char)(g / sum_weight);
+            d[2] = (unsigned char)(b / sum_weight);
+        }
+    }
+}
+
+/**
+ * üһ
+ */
+void cropRect(const Image* in, Image* out, int x0, int y0, int rx0, int ry0, int rx1, int ry1) {
+    for (int y = ry0; y < ry1; y++) {
+        memcpy(out->data + ((size_t)y * out->width + rx0) * 3,
+            in->data + ((size_t)(y + y0) * in->width + x0 + rx0) * 3, (size_t)(rx1 - rx0) * 3);
+    }
+}
+
+//==========  ==========
+
+typedef struct {
+    int tiles_x;
+    int tiles_y;
+    unsigned char* dirty;
+} DirtyMap;
+
+/**
+ * Ѿ [x0,x1) x [y0,y1)ֲõ漰ƬΪ
+ */
+void markRect(DirtyMap* map, int x0, int y0, int x1, int y1, int width, int height) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > width) x1 = width;
+    if (y1 > height) y1 = height;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    for (int ty = y0 / TILE; ty <= (y1 - 1) / TILE; ty++) {
+        for (int tx = x0 / TILE; tx <= (x1 - 1) / TILE; tx++) {
+            map->dirty[ty * map->tiles_x + tx] = 1;
+        }
+    }
+}
+
+/**
+ * 󽻣˵ box Ƭ󽻣ڱȽƬ¾ģеĸǷͬ
+ */
+void clipBox(const int* box, int tx0, int ty0, int tx1, int ty1, int* out) {
+    out[0] = box[0] > tx0 ? box[0] : tx0;
+    out[1] = box[1] > ty0 ? box[1] : ty0;
+    out[2] = box[2] < tx1 - 1 ? box[2] : tx1 - 1;
+    out[3] = box[3] < ty1 - 1 ? box[3] : ty1 - 1;
+    if (out[0] > out[2] || out[1] > out[3]) {
+        out[0] = out[1] = 0;
+        out[2] = out[3] = -1;  // 
+    }
+}
+
+/**
+ * ƬдļӦλãP6  fseek + fwrite
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode patchFile(const char* path, long header_len, const Image* img, const DirtyMap* map, long long* bytes) {
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    ErrorCode ret = SUCCESS;
+    *bytes = 0;
+    for (int ty = 0; ty < map->tiles_y && ret == SUCCESS; ty++) {
+        for (int tx = 0; tx < map->tiles_x && ret == SUCCESS; tx++) {
+            if (!map->dirty[ty * map->tiles_x + tx]) {
+                continue;
+            }
+            int x0 = tx * TILE;
+            int x1 = x0 + TILE < img->width ? x0 + TILE : img->width;
+            int y1 = (ty + 1) * TILE < img->height ? (ty + 1) * TILE : img->height;
+            for (int y = ty * TILE; y < y1; y++) {
+                size_t offset = ((size_t)y * img->width + x0) * 3;
+                size_t n = (size_t)(x1 - x0) * 3;
+                if (fseek64(file, header_len + (long long)offset, SEEK_SET) != 0 ||
+                    fwrite(img->data + offset, 1, n, file) != n) {
+                    ret = ERR_WRITE_FAILED;
+                    break;
+                }
+                *bytes += n;
+            }
+        }
+    }
+    if (fclose(file) != 0 && ret == SUCCESS) {
+        ret = ERR_WRITE_FAILED;
+    }
+    return ret;
+}
+
+//==========  ==========
+
+void printUsage(const char* prog) {
+    printf("÷\n");
+    printf("  %s blur <.ppm> <.ppm> R X1 Y1 X2 Y2   ģ򣨺˵㣩\n", prog);
+    printf("  %s crop <.ppm> <.ppm> X Y W H\n", prog);
+    printf("Ϊ P6ٴʱ <>.state / <>.prev бϴβȽϣ\n");
+    printf("ֻ仯Ƭԭظдļ --full ǿȫ\n");
+}
+
+/**
+ *  -> Ƚϴ״̬õƬ -> ֻƬ -> ԭظд
+ */
+int main(int argc, char* argv[]) {
+    // 1. 
+    int full = 0;
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--full") == 0) {
+            full = 1;
+        }
+        else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    int is_blur = argc == 9 && strcmp(argv[1], "blur") == 0;
+    int is_crop = argc == 8 && strcmp(argv[1], "crop") == 0;
+    if (!is_blur && !is_crop) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    const char* input_path = argv[2];
+    const char* output_path = argv[3];
+    RunState state;
+    memset(&state, 0, sizeof(RunState));
+    strcpy(state.op, argv[1]);
+    for (int i = 0; i < argc - 4; i++) {
+        state.p[i] = atoi(argv[4 + i]);
+    }
+    if (is_blur && (state.p[0] < 0 || state.p[0] > 64)) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    char state_path[512], prev_path[512];
+    snprintf(state_path, sizeof(state_path), "%s.state", output_path);
+    snprintf(prev_path, sizeof(prev_path), "%s.prev", output_path);
+
+    // 2. ȡ
+    clock_t start = clock();
+    Image in, out, prev;
+    memset(&in, 0, sizeof(Image));
+    memset(&out, 0, sizeof(Image));
+    memset(&prev, 0, sizeof(Image));
+    ErrorCode ret = readImage(input_path, &in);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        return ret;
+    }
+    state.width = in.width;
+    state.height = in.height;
+    state.max_val = in.max_val;
+    int radius = state.p[0];
+    int* box = &state.p[1];
+    if (is_blur) {
+        out.width = in.width;
+        out.height = in.height;
+    }
+    else {
+        if (state.p[0] < 0 || state.p[1] < 0 || state.p[2] <= 0 || state.p[3] <= 0 ||
+            state.p[0] + state.p[2] > in.width || state.p[1] + state.p[3] > in.height) {
+            printf("%s\n", error_messages[ERR_CROP_OUT_OF_BOUNDS]);
+            freeImage(&in);
+            return ERR_CROP_OUT_OF_BOUNDS;
+        }
+        out.width = state.p[2];
+        out.height = state.p[3];
+    }
+    out.max_val = in.max_val;
+
+    // 3. жܷϴεĲߴ硢ߴ綼ͬϴĸ
+    RunState old;
+    int incremental = !full && loadState(state_path, &old) == 0 && strcmp(old.op, state.op) == 0 &&
+        old.width == state.width && old.height == state.height && old.max_val == state.max_val &&
+        (is_blur || (old.p[2] == state.p[2] && old.p[3] == state.p[3])) &&
+        fileSize(output_path) == old.header_len + (long long)out.width * out.height * 3 &&
+        readImage(prev_path, &prev) == SUCCESS && prev.width == in.width && prev.height == in.height;
+
+    double sum_weight = 0.0;
+    double* table = NULL;
+    if (is_blur) {
+        int side = 2 * radius + 1;
+        table = (double*)malloc(sizeof(double) * side * side);
+        if (table == NULL) {
+            freeImage(&in);
+            freeImage(&prev);
+            return ERR_MEMORY_ALLOC;
+        }
+        for (int dx = -radius; dx <= radius; dx++) {
+            for (int dy = -radius; dy <= radius; dy++) {
+                table[(dx + radius) * side + (dy + radius)] = weight(5.0, dx, dy, &sum_weight);
+            }
+        }
+    }
+    out.data = (unsigned char*)malloc((size_t)out.width * out.height * 3);
+    DirtyMap map;
+    map.tiles_x = (out.width + TILE - 1) / TILE;
+    map.tiles_y = (out.height + TILE - 1) / TILE;
+    map.dirty = (unsigned char*)calloc((size_t)map.tiles_x * map.tiles_y, 1);
+    DirtyMap in_map;
+    in_map.tiles_x = (in.width + TILE - 1) / TILE;
+    in_map.tiles_y = (in.height + TILE - 1) / TILE;
+    in_map.dirty = (unsigned char*)calloc((size_t)in_map.tiles_x * in_map.tiles_y, 1);
+    if (out.data == NULL || map.dirty == NULL || in_map.dirty == NULL) {
+        ret = ERR_MEMORY_ALLOC;
+    }
+
+    int dirty_count = map.tiles_x * map.tiles_y;
+    if (ret == SUCCESS && incremental) {
+        // 4a. 仯ƬȽϴĸ仯Ƭں˰뾶ӳ䵽
+        int halo = is_blur ? radius : 0;
+        int shift_x = is_blur ? 0 : state.p[0];
+        int shift_y = is_blur ? 0 : state.p[1];
+        for (int ty = 0; ty < in_map.tiles_y; ty++) {
+            for (int tx = 0; tx < in_map.tiles_x; tx++) {
+                int x0 = tx * TILE, y0 = ty * TILE;
+                int x1 = x0 + TILE < in.width ? x0 + TILE : in.width;
+                int y1 = y0 + TILE < in.height ? y0 + TILE : in.height;
+                for (int y = y0; y < y1; y++) {
+                    size_t offset = ((size_t)y * in.width + x0) * 3;
+                    if (memcmp(in.data + offset, prev.data + offset, (size_t)(x1 - x0) * 3) != 0) {
+                        in_map.dirty[ty * in_map.tiles_x + tx] = 1;
+                        markRect(&map, x0 - halo - shift_x, y0 - halo - shift_y,
+                            x1 + halo - shift_x, y1 + halo - shift_y, out.width, out.height);
+                        break;
+                    }
+                }
+            }
+        }
+        // 4b. 仯
+        if (is_blur) {
+            const int* old_box = &old.p[1];
+            for (int ty = 0; ty < map.tiles_y; ty++) {
+                for (int tx = 0; tx < map.tiles_x; tx++) {
+                    int x0 = tx * TILE, y0 = ty * TILE;
+                    int x1 = x0 + TILE < out.width ? x0 + TILE : out.width;
+                    int y1 = y0 + TILE < out.height ? y0 + TILE : out.height;
+                    int a[4], b[4];
+                    clipBox(old_box, x0, y0, x1, y1, a);
+                    clipBox(box, x0, y0, x1, y1, b);
+                    int covered = a[0] <= a[2] || b[0] <= b[2];
+                    // 뾶ˣ¾򸲸ǵƬҪ㣻ֻиǷΧͬƬҪ
+                    if ((old.p[0] != radius && covered) || memcmp(a, b, sizeof(a)) != 0) {
+                        map.dirty[ty * map.tiles_x + tx] = 1;
+                    }
+                }
+            }
+        }
+        else if (old.p[0] != state.p[0] || old.p[1] != state.p[1]) {
+            // ԭƶڵݶƽ
+            memset(map.dirty, 1, (size_t)map.tiles_x * map.tiles_y);
+        }
+
+        // 5a. ֻƬԭظд
+        dirty_count = 0;
+        for (int ty = 0; ty < map.tiles_y; ty++) {
+            for (int tx = 0; tx < map.tiles_x; tx++) {
+                if (!map.dirty[ty * map.tiles_x + tx]) {
+                    continue;
+                }
+                dirty_count++;
+                int x0 = tx * TILE, y0 = ty * TILE;
+                int x1 = x0 + TILE < out.width ? x0 + TILE : out.width;
+                int y1 = y0 + TILE < out.height ? y0 + TILE : out.height;
+                if (is_blur) {
+                    blurRect(&in, &out, radius, table, sum_weight, box, x0, y0, x1, y1);
+                }
+                else {
+                    cropRect(&in, &out, state.p[0], state.p[1], x0, y0, x1, y1);
+                }
+            }
+        }
+        long long bytes = 0, prev_bytes = 0;
+        state.header_len = old.header_len;
+        ret = patchFile(output_path, state.header_len, &out, &map, &bytes);
+        if (ret == SUCCESS) {
+            // ϴĸҲֻд仯Ƭ
+            long prev_header = (long)(fileSize(prev_path) - (long long)in.width * in.height * 3);
+            ret = patchFile(prev_path, prev_header, &in, &in_map, &prev_bytes);
+        }
+        if (ret == SUCCESS) {
+            printf("㣺 %d / %d Ƭд %.2f MB\n", dirty_count,
+                map.tiles_x * map.tiles_y, bytes / (1024.0 * 1024.0));
+        }
+    }
+    else if (ret == SUCCESS) {
+        // 5b. ȫ
+        if (is_blur) {
+            blurRect(&in, &out, radius, table, sum_weight, box, 0, 0, out.width, out.height);
+        }
+        else {
+            cropRect(&in, &out, state.p[0], state.p[1], 0, 0, out.width, out.height);
+        }
+        ret = writeImage(output_path, &out, &state.header_len);
+        long prev_header;
+        if (ret == SUCCESS) {
+            ret = writeImage(prev_path, &in, &prev_header);
+        }
+        if (ret == SUCCESS) {
+            printf("ȫ㣺%d Ƭ\n", dirty_count);
+        }
+    }
+    if (ret == SUCCESS) {
+        ret = saveState(state_path, &state);
+    }
+    if (ret == SUCCESS) {
+        printf("д%s%.1f ms\n", output_path, (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC);
+    }
+    else {
+        printf("%s\n", error_messages[ret]);
+        remove(state_path);  // ״̬ʱ´ȫ
+    }
+
+    free(table);
+    free(map.dirty);
+    free(in_map.dirty);
+    freeImage(&in);
+    freeImage(&out);
+    freeImage(&prev);
+    return ret;
+}
\ No newline at end of file
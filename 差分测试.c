@@ -0,0 +1,1454 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ɫת.h"
+#include ".h"
+#include ".h"
+#include ".h"
+#include "ֱͼ.h"
+#include "˹ģ.h"
+#include "ֵ˲.h"
+#include "̬ѧ.h"
+#include "ͼ.h"
+#include "cannyԵ.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// ؽṹ壨RGBͨ
+typedef struct {
+    int r;
+    int g;
+    int b;
+} Pixel;
+
+// PPMͼṹ
+typedef struct {
+    int width;    // ͼ
+    int height;   // ͼ߶
+    int max_val;  // ֵ
+    Pixel* data;  // 
+} PPM;
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_BAD_ARGUMENT,
+    ERR_MISMATCH
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PPM P3ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "вϷ",
+    "Ż汾οʵֽһ"
+};
+
+#define TEST_KERNEL_MAX_SIZE 15  // ˵߳
+
+// һ
+typedef struct {
+    PPM a;                // 
+    int x1, y1, x2, y2;   // ģ򣨿ɲֻȫͼ
+    int radius;           // ˹ģֵʽģİ뾶
+    int threshold;        // Sobelֵ
+    int low, high;        // Canny ֵ
+    int kernel_size;      // ˱߳
+    int kernel_taps[TEST_KERNEL_MAX_SIZE * TEST_KERNEL_MAX_SIZE];
+    int kernel_divisor;
+    int border;           // ConvBorder
+    int border_value;     // ֵ߽
+    int out_width;        // źĳߴ
+    int out_height;
+    int filter;           // ResizeFilter
+    int rx, ry;           // ̬ѧṹԪذ뾶
+    int morph_op;         // MorphOp
+} TestCase;
+
+/**
+ * ͷPPMͼĶ̬ڴ
+ */
+void freePPM(PPM* ppm) {
+    if (ppm != NULL && ppm->data != NULL) {
+        free(ppm->data);
+        ppm->data = NULL;
+    }
+}
+
+/**
+ * Ϊͼ
+ *  calloc 㣺SobelCanny ı߿ԭʵֻڱдڵأ߽ɱ
+ */
+ErrorCode allocPPM(PPM* out, int width, int height, int max_val) {
+    out->width = width;
+    out->height = height;
+    out->max_val = max_val;
+    out->data = (Pixel*)calloc((size_t)width * height, sizeof(Pixel));
+    if (out->data == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+//========== οʵ֣ӸԭֻȫֱΪʽΣ򰴶ֱӼ ==========
+
+// ˹ģ.c
+Pixel BLACK = { 0, 0, 0 };
+
+Pixel* getPixel(PPM* source, int x, int y) {
+    if (x < 0 || y < 0 || x >= source->width || y >= source->height) {
+        return &BLACK;
+    }
+    return source->data + x + y * source->width;
+}
+
+double weight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+Pixel blur(PPM* source, int x, int y, int radius) {
+    Pixel p;
+    p.r = 0;
+    p.g = 0;
+    p.b = 0;
+    Pixel* temp;
+    double sum_weight = 0.0;
+    for (int i = x - radius; i <= x + radius; i++) {
+        for (int j = y - radius; j <= y + radius; j++) {
+            double WEIGHT = weight(5.0, i - x, j - y, &sum_weight);
+            temp = getPixel(source, i, j);
+            p.r += WEIGHT * temp->r;
+            p.g += WEIGHT * temp->g;
+            p.b += WEIGHT * temp->b;
+        }
+    }
+    p.r /= sum_weight;
+    p.g /= sum_weight;
+    p.b /= sum_weight;
+    return p;
+}
+
+ErrorCode refBlur(const TestCase* tc, PPM* out) {
+    PPM* in = (PPM*)&tc->a;
+    int width = in->width;
+    int height = in->height;
+    if (allocPPM(out, width, height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (tc->x1 <= x && x <= tc->x2 && tc->y1 <= y && y <= tc->y2) {
+                out->data[x + y * width] = blur(in, x, y, tc->radius);
+            }
+            else {
+                out->data[x + y * width] = in->data[x + y * width];
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+// sobelԵ.cҶȰ BT.601 ȡȷضϣԭ double ʽںǡΪʱ 1
+void refRgbToGray(const PPM* in, unsigned char* gray) {
+    if (in == NULL || gray == NULL || in->data == NULL) {
+        return;
+    }
+    for (int i = 0; i < in->width * in->height; i++) {
+        int r = in->data[i].r;
+        int g = in->data[i].g;
+        int b = in->data[i].b;
+        gray[i] = (unsigned char)((299 * r + 587 * g + 114 * b) / 1000);
+    }
+}
+
+ErrorCode refSobelEdgeDetect(const PPM* in, PPM* out, unsigned char threshold) {
+    if (in == NULL || out == NULL || in->data == NULL) {
+        return ERR_FILE_BROKEN;
+    }
+    if (in->width < 3 || in->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    if (allocPPM(out, in->width, in->height, 255) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    unsigned char* gray = (unsigned char*)malloc(sizeof(unsigned char) * in->width * in->height);
+    if (gray == NULL) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
+    refRgbToGray(in, gray);
+
+    int Gx[3][3] = { {-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1} };
+    int Gy[3][3] = { {-1, -2, -1}, {0, 0, 0}, {1, 2, 1} };
+    for (int y = 1; y < in->height - 1; y++) {
+        for (int x = 1; x < in->width - 1; x++) {
+            int gx = 0, gy = 0;
+            for (int ky = -1; ky <= 1; ky++) {
+                for (int kx = -1; kx <= 1; kx++) {
+                    int gray_idx = (x + kx) + (y + ky) * in->width;
+                    gx += gray[gray_idx] * Gx[ky + 1][kx + 1];
+                    gy += gray[gray_idx] * Gy[ky + 1][kx + 1];
+                }
+            }
+            double magnitude = sqrt((double)(gx * gx + gy * gy));
+            unsigned char edge = (magnitude >= threshold) ? 255 : 0;
+            int out_idx = x + y * out->width;
+            out->data[out_idx].r = edge;
+            out->data[out_idx].g = edge;
+            out->data[out_idx].b = edge;
+        }
+    }
+    for (int y = 0; y < out->height; y++) {
+        for (int x = 0; x < out->width; x++) {
+            if (x == 0 || x == out->width - 1 || y == 0 || y == out->height - 1) {
+                int out_idx = x + y * out->width;
+                out->data[out_idx].r = 0;
+                out->data[out_idx].g = 0;
+                out->data[out_idx].b = 0;
+            }
+        }
+    }
+    free(gray);
+    return SUCCESS;
+}
+
+ErrorCode refSobel(const TestCase* tc, PPM* out) {
+    return refSobelEdgeDetect(&tc->a, out, (unsigned char)tc->threshold);
+}
+
+// ҶȻ.cԭΪ invertʵΪͨƽ
+Pixel grayAverage(Pixel* source, int colorset) {
+    (void)colorset;
+    Pixel p;
+    int gray = 0;
+    gray = (source->r + source->g + source->b) / 3;
+    p.r = gray;
+    p.g = gray;
+    p.b = gray;
+    return p;
+}
+
+ErrorCode refGray(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int width = in->width;
+    int height = in->height;
+    if (allocPPM(out, width, height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            out->data[x + y * width] = grayAverage(in->data + x + y * width, in->max_val);
+        }
+    }
+    return SUCCESS;
+}
+
+// BT.601 Ҷȣͬ refRgbToGrayͨҶֵ
+ErrorCode refLuma601(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    int count = in->width * in->height;
+    unsigned char* gray = (unsigned char*)malloc((size_t)count);
+    if (gray == NULL) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
+    refRgbToGray(in, gray);
+    for (int i = 0; i < count; i++) {
+        out->data[i].r = gray[i];
+        out->data[i].g = gray[i];
+        out->data[i].b = gray[i];
+    }
+    free(gray);
+    return SUCCESS;
+}
+
+// ȱ任ΪɫʿռתĲο
+ErrorCode refCopy(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    memcpy(out->data, in->data, sizeof(Pixel) * in->width * in->height);
+    return SUCCESS;
+}
+
+// Cannyؼ㡣ݶΪͼⲹ 0  Sobel sobelGradients ͬһȦҲ㣬ȦȽϣ
+//  cannyԵ.h ͬtan 22.5㡢tan 67.5  15 λֵͺΪͼĹɢ
+void refSobelGradients(const unsigned char* gray, int width, int height, int* gx, int* gy) {
+    int Gx[3][3] = { {-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1} };
+    int Gy[3][3] = { {-1, -2, -1}, {0, 0, 0}, {1, 2, 1} };
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int sx = 0, sy = 0;
+            for (int ky = -1; ky <= 1; ky++) {
+                for (int kx = -1; kx <= 1; kx++) {
+                    int xx = x + kx;
+                    int yy = y + ky;
+                    int v = (xx < 0 || yy < 0 || xx >= width || yy >= height) ? 0 : gray[xx + yy * width];
+                    sx += v * Gx[ky + 1][kx + 1];
+                    sy += v * Gy[ky + 1][kx + 1];
+                }
+            }
+            gx[x + y * width] = sx;
+            gy[x + y * width] = sy;
+        }
+    }
+}
+
+ErrorCode refCanny(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int width = in->width;
+    int height = in->height;
+    if (width < 3 || height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    // 8 λҶݶȷֵ sqrt(2)*4*255  1442.5ߵֵû壬ƽܳ int
+    if (tc->low < 0 || tc->high < tc->low || tc->high > 1443) {
+        return ERR_BAD_ARGUMENT;
+    }
+    int count = width * height;
+    unsigned char* gray = (unsigned char*)malloc((size_t)count);
+    unsigned char* mark = (unsigned char*)calloc((size_t)count, 1);
+    int* gx = (int*)malloc(sizeof(int) * count);
+    int* gy = (int*)malloc(sizeof(int) * count);
+    int* stack = (int*)malloc(sizeof(int) * count);
+    if (gray == NULL || mark == NULL || gx == NULL || gy == NULL || stack == NULL ||
+        allocPPM(out, width, height, 255) != SUCCESS) {
+        free(gray);
+        free(mark);
+        free(gx);
+        free(gy);
+        free(stack);
+        return ERR_MEMORY_ALLOC;
+    }
+    refRgbToGray(in, gray);
+    refSobelGradients(gray, width, height, gx, gy);
+
+    // 1. Ǽֵƣ1=2=ǿ
+    for (int y = 1; y < height - 1; y++) {
+        for (int x = 1; x < width - 1; x++) {
+            int i = x + y * width;
+            int ax = abs(gx[i]);
+            int ay = abs(gy[i]);
+            int dx, dy;
+            if (ay * 32768 < ax * 13573) {
+                dx = 1;
+                dy = 0;
+            }
+            else if (ay * 32768 > ax * 79109) {
+                dx = 0;
+                dy = 1;
+            }
+            else {
+                dx = 1;
+                dy = ((gx[i] < 0) == (gy[i] < 0)) ? 1 : -1;
+            }
+            int before = gx[i - dx - dy * width] * gx[i - dx - dy * width] + gy[i - dx - dy * width] * gy[i - dx - dy * width];
+            int after = gx[i + dx + dy * width] * gx[i + dx + dy * width] + gy[i + dx + dy * width] * gy[i + dx + dy * width];
+            int m = gx[i] * gx[i] + gy[i] * gy[i];
+            if (m > before && m >= after) {
+                mark[i] = m >= tc->high * tc->high ? 2 : (m >= tc->low * tc->low ? 1 : 0);
+            }
+        }
+    }
+
+    // 2. ͺӣǿس 8 ڽӵظĳǿ
+    int top = 0;
+    for (int i = 0; i < count; i++) {
+        if (mark[i] == 2) {
+            stack[top++] = i;
+        }
+    }
+    while (top > 0) {
+        int i = stack[--top];
+        int x = i % width;
+        int y = i / width;
+        for (int yy = y - 1; yy <= y + 1; yy++) {
+            for (int xx = x - 1; xx <= x + 1; xx++) {
+                if (xx >= 0 && yy >= 0 && xx < width && yy < height && mark[xx + yy * width] == 1) {
+                    mark[xx + yy * width] = 2;
+                    stack[top++] = xx + yy * width;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        int edge = mark[i] == 2 ? 255 : 0;
+        out->data[i].r = edge;
+        out->data[i].g = edge;
+        out->data[i].b = edge;
+    }
+    free(gray);
+    free(mark);
+    free(gx);
+    free(gy);
+    free(stack);
+    return SUCCESS;
+}
+
+// °ͨƽ㣬 runPlanes  RGB һΣ 0=ɹ-1=Ϸ
+typedef int (*PlaneFunc)(const TestCase* tc, const int* src, int* dst, int width, int height);
+
+/**
+ * ͨƽֱ㣬ٺϳ
+ * @return 루SUCCESS=ɹfunc  -1 ʱΪ ERR_BAD_ARGUMENT
+ */
+ErrorCode runPlanes(const TestCase* tc, PPM* out, PlaneFunc func) {
+    const PPM* in = &tc->a;
+    int count = in->width * in->height;
+    int* src = (int*)malloc(sizeof(int) * count);
+    int* dst = (int*)malloc(sizeof(int) * count);
+    if (src == NULL || dst == NULL || allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        free(src);
+        free(dst);
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = SUCCESS;
+    for (int c = 0; c < 3 && ret == SUCCESS; c++) {
+        const int* s = (const int*)in->data + c;
+        int* d = (int*)out->data + c;
+        for (int i = 0; i < count; i++) {
+            src[i] = s[3 * i];
+        }
+        if (func(tc, src, dst, in->width, in->height) != 0) {
+            ret = ERR_BAD_ARGUMENT;
+        }
+        for (int i = 0; i < count; i++) {
+            d[3 * i] = dst[i];
+        }
+    }
+    free(src);
+    free(dst);
+    if (ret != SUCCESS) {
+        freePPM(out);
+    }
+    return ret;
+}
+
+// أתˣͼⰴ߽緽ʽȡֵԳ루Զ 0
+int refBorderIndex(int i, int n, int border) {
+    if (i >= 0 && i < n) {
+        return i;
+    }
+    if (border == CONV_BORDER_CLAMP) {
+        return i < 0 ? 0 : n - 1;
+    }
+    if (border == CONV_BORDER_REFLECT) {
+        if (n == 1) {
+            return 0;
+        }
+        while (i < 0 || i >= n) {
+            i = i < 0 ? -i : 2 * (n - 1) - i;
+        }
+        return i;
+    }
+    if (border == CONV_BORDER_WRAP) {
+        return ((i % n) + n) % n;
+    }
+    return -1;
+}
+
+int refConvPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    int n = tc->kernel_size;
+    int r = n / 2;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            long long acc = 0;
+            for (int ky = 0; ky < n; ky++) {
+                int sy = refBorderIndex(y + ky - r, height, tc->border);
+                for (int kx = 0; kx < n; kx++) {
+                    int sx = refBorderIndex(x + kx - r, width, tc->border);
+                    int v = (sx < 0 || sy < 0) ? tc->border_value : src[sx + sy * width];
+                    acc += (long long)tc->kernel_taps[ky * n + kx] * v;
+                }
+            }
+            dst[x + y * width] = tc->kernel_divisor == 1 ? (int)acc : (int)llround((double)acc / tc->kernel_divisor);
+        }
+    }
+    return 0;
+}
+
+ErrorCode refConv(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, refConvPlane);
+}
+
+// ֵͼ⸴ƱԵ (2r+1)^2 ȡмһ
+int compareInt(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int refMedianPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    int r = tc->radius;
+    if (r < 1) {
+        return -1;
+    }
+    int side = 2 * r + 1;
+    int* window = (int*)malloc(sizeof(int) * side * side);
+    if (window == NULL) {
+        return -1;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int n = 0;
+            for (int yy = y - r; yy <= y + r; yy++) {
+                for (int xx = x - r; xx <= x + r; xx++) {
+                    int sx = xx < 0 ? 0 : (xx >= width ? width - 1 : xx);
+                    int sy = yy < 0 ? 0 : (yy >= height ? height - 1 : yy);
+                    window[n++] = src[sx + sy * width];
+                }
+            }
+            qsort(window, n, sizeof(int), compareInt);
+            dst[x + y * width] = window[n / 2];
+        }
+    }
+    free(window);
+    return 0;
+}
+
+ErrorCode refMedian(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, refMedianPlane);
+}
+
+// ̬ѧδͼڲֵСֵʴ/ ֵͣΪȺһ
+void refMorphPass(const int* src, int* dst, int width, int height, int rx, int ry, int dilate) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int v = src[x + y * width];
+            for (int yy = y - ry; yy <= y + ry; yy++) {
+                for (int xx = x - rx; xx <= x + rx; xx++) {
+                    if (xx < 0 || yy < 0 || xx >= width || yy >= height) {
+                        continue;
+                    }
+                    int s = src[xx + yy * width];
+                    v = dilate ? (s > v ? s : v) : (s < v ? s : v);
+                }
+            }
+            dst[x + y * width] = v;
+        }
+    }
+}
+
+int refMorphPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    int op = tc->morph_op;
+    int first = (op == MORPH_DILATE || op == MORPH_CLOSE);
+    if (op == MORPH_ERODE || op == MORPH_DILATE) {
+        refMorphPass(src, dst, width, height, tc->rx, tc->ry, first);
+        return 0;
+    }
+    int* temp = (int*)malloc(sizeof(int) * width * height);
+    if (temp == NULL) {
+        return -1;
+    }
+    refMorphPass(src, temp, width, height, tc->rx, tc->ry, first);
+    refMorphPass(temp, dst, width, height, tc->rx, tc->ry, !first);
+    free(temp);
+    return 0;
+}
+
+ErrorCode refMorph(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, refMorphPlane);
+}
+
+// ʽģͼڲͣ( + /2) / 
+int refBoxPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    int r = tc->radius;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            long long sum = 0;
+            long long area = 0;
+            for (int yy = y - r; yy <= y + r; yy++) {
+                for (int xx = x - r; xx <= x + r; xx++) {
+                    if (xx >= 0 && yy >= 0 && xx < width && yy < height) {
+                        sum += src[xx + yy * width];
+                        area++;
+                    }
+                }
+            }
+            dst[x + y * width] = (int)((sum + area / 2) / area);
+        }
+    }
+    return 0;
+}
+
+ErrorCode refBox(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, refBoxPlane);
+}
+
+// ţ˲״봰ȡͬ .hϵ double Ҳ룬һ벢ض
+ErrorCode refResizeWeights(int in_size, int out_size, ResizeFilter filter, double* w) {
+    double scale = (double)in_size / out_size;
+    double filter_scale = scale > 1.0 ? scale : 1.0;
+    double support = resizeSupport(filter) * filter_scale;
+    for (int i = 0; i < out_size; i++) {
+        double center = (i + 0.5) * scale;
+        int lo = (int)floor(center - support + 0.5);
+        int hi = (int)floor(center + support + 0.5);
+        lo = lo > 0 ? lo : 0;
+        hi = hi < in_size ? hi : in_size;
+        double total = 0.0;
+        for (int k = lo; k < hi; k++) {
+            total += resizeWeight(filter, (k + 0.5 - center) / filter_scale);
+        }
+        if (total == 0.0) {
+            return ERR_BAD_ARGUMENT;
+        }
+        for (int k = 0; k < in_size; k++) {
+            w[(size_t)i * in_size + k] = (k >= lo && k < hi) ? resizeWeight(filter, (k + 0.5 - center) / filter_scale) / total : 0.0;
+        }
+    }
+    return SUCCESS;
+}
+
+ErrorCode refResize(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int width = in->width;
+    int height = in->height;
+    int out_width = tc->out_width;
+    int out_height = tc->out_height;
+    double* wx = (double*)malloc(sizeof(double) * out_width * width);
+    double* wy = (double*)malloc(sizeof(double) * out_height * height);
+    double* rows = (double*)malloc(sizeof(double) * out_width * height * 3);
+    ErrorCode ret = (wx == NULL || wy == NULL || rows == NULL) ? ERR_MEMORY_ALLOC : SUCCESS;
+    if (ret == SUCCESS) {
+        ret = refResizeWeights(width, out_width, (ResizeFilter)tc->filter, wx);
+    }
+    if (ret == SUCCESS) {
+        ret = refResizeWeights(height, out_height, (ResizeFilter)tc->filter, wy);
+    }
+    if (ret == SUCCESS) {
+        ret = allocPPM(out, out_width, out_height, in->max_val);
+    }
+    if (ret == SUCCESS) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < out_width; x++) {
+                for (int c = 0; c < 3; c++) {
+                    double v = 0.0;
+                    for (int k = 0; k < width; k++) {
+                        v += wx[(size_t)x * width + k] * ((const int*)in->data)[((size_t)y * width + k) * 3 + c];
+                    }
+                    rows[((size_t)y * out_width + x) * 3 + c] = v;
+                }
+            }
+        }
+        for (int y = 0; y < out_height; y++) {
+            for (int x = 0; x < out_width; x++) {
+                for (int c = 0; c < 3; c++) {
+                    double v = 0.0;
+                    for (int k = 0; k < height; k++) {
+                        v += wy[(size_t)y * height + k] * rows[((size_t)k * out_width + x) * 3 + c];
+                    }
+                    int q = (int)floor(v + 0.5);
+                    ((int*)out->data)[((size_t)y * out_width + x) * 3 + c] = q < 0 ? 0 : (q > in->max_val ? in->max_val : q);
+                }
+            }
+        }
+    }
+    free(wx);
+    free(wy);
+    free(rows);
+    return ret;
+}
+
+//========== ʵ֣ʵʵõڣǼǵ VARIANTS  ==========
+
+/**
+ * ˹ģ˹ģ.c Ĳߴ + Ȩ˹ģ.h
+ */
+ErrorCode blurEngine(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    if (blurRegion((const int*)in->data, in->width, in->height, tc->x1, tc->y1, tc->x2, tc->y2, tc->radius, (int*)out->data) != 0) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+// sobelԵ.c  Sobel 
+const int SOBEL_GX[9] = { -1, 0, 1, -2, 0, 2, -1, 0, 1 };
+const int SOBEL_GY[9] = { -1, -2, -1, 0, 0, 0, 1, 2, 1 };
+
+/**
+ *  sobelԵ.c  sobelGradients ͬBT.601 Ҷȣ 0 ߺþ GxGy
+ * @param gxgywidth*height 
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode engineGradients(const PPM* in, int* gx, int* gy) {
+    size_t count = (size_t)in->width * in->height;
+    unsigned char* gray = (unsigned char*)malloc(count);
+    if (gray == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    colorToGray((const int*)in->data, gray, count, LUMA_BT601);
+    for (size_t i = 0; i < count; i++) {
+        gx[i] = gray[i];
+    }
+    free(gray);
+    PaddedPlane plane;
+    if (padPlane(&plane, gx, in->width, in->height, 1) != 0) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ConvKernel kx, ky;
+    convKernelInit(&kx, 3, SOBEL_GX, 1);
+    convKernelInit(&ky, 3, SOBEL_GY, 1);
+    int failed = convPadded(&plane, gx, &kx) != 0 || convPadded(&plane, gy, &ky) != 0;
+    freePadded(&plane);
+    return failed ? ERR_MEMORY_ALLOC : SUCCESS;
+}
+
+/**
+ * SobelengineGradients  sobelEdgeDetect ķʽȡֵֵ߿ú
+ */
+ErrorCode sobelEngine(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int width = in->width;
+    int height = in->height;
+    if (width < 3 || height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int* gx = (int*)malloc(sizeof(int) * width * height);
+    int* gy = (int*)malloc(sizeof(int) * width * height);
+    ErrorCode ret = (gx == NULL || gy == NULL) ? ERR_MEMORY_ALLOC : engineGradients(in, gx, gy);
+    if (ret == SUCCESS) {
+        ret = allocPPM(out, width, height, 255);
+    }
+    if (ret == SUCCESS) {
+        for (int y = 1; y < height - 1; y++) {
+            for (int x = 1; x < width - 1; x++) {
+                int idx = x + y * width;
+                double magnitude = sqrt((double)(gx[idx] * gx[idx] + gy[idx] * gy[idx]));
+                int edge = (magnitude >= tc->threshold) ? 255 : 0;
+                out->data[idx].r = edge;
+                out->data[idx].g = edge;
+                out->data[idx].b = edge;
+            }
+        }
+    }
+    free(gx);
+    free(gy);
+    return ret;
+}
+
+/**
+ * CannyengineGradients խ int16 󽻸 cannyEdgesͬ sobelԵ.c  sobelCanny
+ */
+ErrorCode cannyEngine(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int width = in->width;
+    int height = in->height;
+    if (width < 3 || height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int count = width * height;
+    int* gx = (int*)malloc(sizeof(int) * count);
+    int* gy = (int*)malloc(sizeof(int) * count);
+    short* gx16 = (short*)malloc(sizeof(short) * count);
+    short* gy16 = (short*)malloc(sizeof(short) * count);
+    unsigned char* edge = (unsigned char*)malloc((size_t)count);
+    ErrorCode ret = (gx == NULL || gy == NULL || gx16 == NULL || gy16 == NULL || edge == NULL) ? ERR_MEMORY_ALLOC : engineGradients(in, gx, gy);
+    if (ret == SUCCESS) {
+        for (int i = 0; i < count; i++) {
+            gx16[i] = (short)gx[i];
+            gy16[i] = (short)gy[i];
+        }
+        ret = cannyEdges(gx16, gy16, width, height, tc->low, tc->high, edge) == 0 ? SUCCESS : ERR_BAD_ARGUMENT;
+    }
+    if (ret == SUCCESS) {
+        ret = allocPPM(out, width, height, 255);
+    }
+    if (ret == SUCCESS) {
+        for (int i = 0; i < count; i++) {
+            out->data[i].r = edge[i];
+            out->data[i].g = edge[i];
+            out->data[i].b = edge[i];
+        }
+    }
+    free(gx);
+    free(gy);
+    free(gx16);
+    free(gy16);
+    free(edge);
+    return ret;
+}
+
+/**
+ * 棺߽緽ʽߺֱӾ FFT  convPadded ķֽѡ·⵽
+ */
+int convEnginePlane(const TestCase* tc, const int* src, int* dst, int width, int height, int use_fft) {
+    ConvKernel k;
+    if (convKernelInit(&k, tc->kernel_size, tc->kernel_taps, tc->kernel_divisor) != 0) {
+        return -1;
+    }
+    PaddedPlane plane;
+    if (padPlaneBorder(&plane, src, width, height, k.size / 2, (ConvBorder)tc->border, tc->border_value) != 0) {
+        return -1;
+    }
+    int ret = use_fft ? convPaddedFFT(&plane, dst, &k) : convPaddedDirect(&plane, dst, &k);
+    freePadded(&plane);
+    return ret;
+}
+
+int convDirectPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    return convEnginePlane(tc, src, dst, width, height, 0);
+}
+
+int convFftPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    return convEnginePlane(tc, src, dst, width, height, 1);
+}
+
+ErrorCode convDirect(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, convDirectPlane);
+}
+
+ErrorCode convFft(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, convFftPlane);
+}
+
+/**
+ * 棺ԤСreduce_gap=0ֻ˲Ĳοʵֿɱ
+ * ϵ 14 λ룬 1
+ */
+ErrorCode resizeEngine(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    if (allocPPM(out, tc->out_width, tc->out_height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    if (resizeImage((const int*)in->data, in->width, in->height, (int*)out->data, tc->out_width, tc->out_height,
+        3, in->max_val, (ResizeFilter)tc->filter, 0) != 0) {
+        freePPM(out);
+        return ERR_BAD_ARGUMENT;
+    }
+    return SUCCESS;
+}
+
+/**
+ * ֵ˲ֵ˲.hʱֱͼ8 λ
+ */
+int medianPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    return medianFilterPlane(src, dst, width, height, tc->radius);
+}
+
+ErrorCode medianEngine(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, medianPlane);
+}
+
+/**
+ * ̬ѧ̬ѧ.h ĻҶƽʵ֣van Herk/Gil-Werman
+ */
+int morphEnginePlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    memcpy(dst, src, sizeof(int) * width * height);
+    return morphPlane(dst, width, height, tc->rx, tc->ry, (MorphOp)tc->morph_op);
+}
+
+ErrorCode morphEngine(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, morphEnginePlane);
+}
+
+/**
+ * ʽģͼ.h ÿ O(1) ѯ
+ */
+int boxIntegralPlane(const TestCase* tc, const int* src, int* dst, int width, int height) {
+    IntegralImage ii;
+    if (integralBuild(&ii, src, width, height, 0) != 0) {
+        return -1;
+    }
+    integralBoxFilter(&ii, dst, tc->radius);
+    integralFree(&ii);
+    return 0;
+}
+
+ErrorCode boxIntegral(const TestCase* tc, PPM* out) {
+    return runPlanes(tc, out, boxIntegralPlane);
+}
+
+/**
+ * ҶȻɫת.h ƽʽ16 λھȷ
+ */
+ErrorCode grayEngine(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int count = in->width * in->height;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    int* gray = (int*)malloc(sizeof(int) * count);
+    if (gray == NULL) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
+    colorToGrayWide((const int*)in->data, gray, (size_t)count, LUMA_AVERAGE);
+    for (int i = 0; i < count; i++) {
+        out->data[i].r = gray[i];
+        out->data[i].g = gray[i];
+        out->data[i].b = gray[i];
+    }
+    free(gray);
+    return SUCCESS;
+}
+
+/**
+ * BT.601 Ҷȣɫת.h Ķ汾ȷضϣ
+ */
+ErrorCode luma601Engine(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    int count = in->width * in->height;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    unsigned char* gray = (unsigned char*)malloc((size_t)count);
+    if (gray == NULL) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
+    colorToGray((const int*)in->data, gray, (size_t)count, LUMA_BT601);
+    for (int i = 0; i < count; i++) {
+        out->data[i].r = gray[i];
+        out->data[i].g = gray[i];
+        out->data[i].b = gray[i];
+    }
+    free(gray);
+    return SUCCESS;
+}
+
+/**
+ * RGB -> YCbCr -> RGB ԭQ16 㣬 1
+ */
+ErrorCode yCbCrRoundTrip(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    size_t count = (size_t)in->width * in->height;
+    rgbToYCbCr((const int*)in->data, (int*)out->data, count);
+    yCbCrToRgb((const int*)out->data, (int*)out->data, count);
+    return SUCCESS;
+}
+
+/**
+ * RGB -> HSV -> RGB ԭH  1 ȣ 2
+ */
+ErrorCode hsvRoundTrip(const TestCase* tc, PPM* out) {
+    const PPM* in = &tc->a;
+    if (allocPPM(out, in->width, in->height, in->max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    size_t count = (size_t)in->width * in->height;
+    rgbToHsv((const int*)in->data, (int*)out->data, count);
+    hsvToRgb((const int*)out->data, (int*)out->data, count);
+    return SUCCESS;
+}
+
+//========== Աȿ ==========
+
+typedef ErrorCode (*KernelFunc)(const TestCase* tc, PPM* out);
+
+// ݲͨԼر
+typedef struct {
+    int max_abs_diff;
+    double max_mismatch_ratio;
+} Tolerance;
+
+typedef struct {
+    const char* kernel;
+    const char* variant;
+    KernelFunc reference;
+    KernelFunc optimized;
+    Tolerance tolerance;
+    int max_val_limit;  // οʵȷֵضϣ
+} Variant;
+
+const Variant VARIANTS[] = {
+    { "blur",      "engine",      refBlur,      blurEngine,       { 0, 0.0 },   65535 },
+    { "sobel",     "engine",      refSobel,     sobelEngine,      { 0, 0.0 },   255 },
+    { "canny",     "engine",      refCanny,     cannyEngine,      { 0, 0.0 },   255 },
+    { "conv",      "direct",      refConv,      convDirect,       { 0, 0.0 },   65535 },
+    { "conv",      "fft",         refConv,      convFft,          { 0, 0.0 },   65535 },
+    { "resize",    "engine",      refResize,    resizeEngine,     { 1, 0.0 },   255 },
+    { "median",    "engine",      refMedian,    medianEngine,     { 0, 0.0 },   255 },
+    { "morph",     "engine",      refMorph,     morphEngine,      { 0, 0.0 },   65535 },
+    { "box",       "integral",    refBox,       boxIntegral,      { 0, 0.0 },   65535 },
+    { "gray",      "engine",      refGray,      grayEngine,       { 0, 0.0 },   65535 },
+    { "luma601",   "engine",      refLuma601,   luma601Engine,    { 0, 0.0 },   255 },
+    { "ycbcr",     "round-trip",  refCopy,      yCbCrRoundTrip,   { 1, 0.0 },   255 },
+    { "hsv",       "round-trip",  refCopy,      hsvRoundTrip,     { 2, 0.0 },   255 }
+};
+const int VARIANTS_COUNT = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+
+// ÿŻ汾ۼƽ
+typedef struct {
+    int cases;
+    int failures;
+    int max_diff_seen;
+    double worst_mismatch_ratio;
+} VariantReport;
+
+const int THREAD_COUNTS[] = { 1, 2, 3, 4, 8 };
+const int THREAD_COUNTS_COUNT = sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]);
+
+const int MAX_VALS[] = { 1, 7, 15, 100, 255, 1023, 65535 };
+const int MAX_VALS_COUNT = sizeof(MAX_VALS) / sizeof(MAX_VALS[0]);
+
+// ̶ǵı߽ߴ磺1 ءС Sobel 3x3 ޡе
+const int EDGE_SIZES[][2] = {
+    { 1, 1 }, { 2, 2 }, { 2, 5 }, { 3, 3 }, { 4, 3 }, { 1, 64 }, { 64, 1 },
+    { 17, 9 }, { 31, 33 }, { 33, 32 }, { 127, 65 }
+};
+const int EDGE_SIZES_COUNT = sizeof(EDGE_SIZES) / sizeof(EDGE_SIZES[0]);
+
+unsigned int g_seed = 12345;
+
+unsigned int nextRandom() {
+    g_seed = g_seed * 1103515245u + 12345u;
+    return (g_seed >> 8) & 0xFFFFFF;
+}
+
+int randomRange(int lo, int hi) {
+    return lo + (int)(nextRandom() % (unsigned int)(hi - lo + 1));
+}
+
+/**
+ * ͼ / ɫ / ֵֻ֮Ǳֵ߽
+ */
+ErrorCode makeRandomImage(PPM* ppm, int width, int height, int max_val) {
+    if (allocPPM(ppm, width, height, max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    int style = randomRange(0, 3);
+    int constant = randomRange(0, max_val);
+    for (int i = 0; i < width * height; i++) {
+        Pixel* p = &ppm->data[i];
+        if (style == 0) {         // ɫ
+            p->r = p->g = p->b = constant;
+        }
+        else if (style == 1) {    // ֻ 0 ֵ
+            p->r = (nextRandom() & 1) ? max_val : 0;
+            p->g = (nextRandom() & 1) ? max_val : 0;
+            p->b = (nextRandom() & 1) ? max_val : 0;
+        }
+        else {                    // 
+            p->r = randomRange(0, max_val);
+            p->g = randomRange(0, max_val);
+            p->b = randomRange(0, max_val);
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * Ƚͼ񣬷Ƿݲڣ±
+ */
+int compareImages(const PPM* ref, const PPM* opt, const Tolerance* tol, VariantReport* report) {
+    if (ref->width != opt->width || ref->height != opt->height || ref->max_val != opt->max_val) {
+        return 0;
+    }
+    int count = ref->width * ref->height;
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        int dr = abs(ref->data[i].r - opt->data[i].r);
+        int dg = abs(ref->data[i].g - opt->data[i].g);
+        int db = abs(ref->data[i].b - opt->data[i].b);
+        int diff = dr > dg ? (dr > db ? dr : db) : (dg > db ? dg : db);
+        if (diff > report->max_diff_seen) {
+            report->max_diff_seen = diff;
+        }
+        if (diff > tol->max_abs_diff) {
+            mismatches++;
+        }
+    }
+    double ratio = count > 0 ? (double)mismatches / count : 0.0;
+    if (ratio > report->worst_mismatch_ratio) {
+        report->worst_mismatch_ratio = ratio;
+    }
+    return ratio <= tol->max_mismatch_ratio;
+}
+
+void setThreads(int threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#else
+    (void)threads;
+#endif
+}
+
+/**
+ * һа汾ÿ汾ÿ߳¶οȽ
+ * @return ʧܴ
+ */
+int runCase(const TestCase* tc, VariantReport* reports, int verbose) {
+    int failures = 0;
+    for (int v = 0; v < VARIANTS_COUNT; v++) {
+        const Variant* var = &VARIANTS[v];
+        if (tc->a.max_val > var->max_val_limit) {
+            continue;
+        }
+        PPM ref;
+        memset(&ref, 0, sizeof(PPM));
+        ErrorCode ref_ret = var->reference(tc, &ref);
+
+        for (int t = 0; t < THREAD_COUNTS_COUNT; t++) {
+            PPM opt;
+            memset(&opt, 0, sizeof(PPM));
+            setThreads(THREAD_COUNTS[t]);
+            ErrorCode opt_ret = var->optimized(tc, &opt);
+
+            int ok = (opt_ret == ref_ret);
+            if (ok && ref_ret == SUCCESS) {
+                ok = compareImages(&ref, &opt, &var->tolerance, &reports[v]);
+            }
+            reports[v].cases++;
+            if (!ok) {
+                reports[v].failures++;
+                failures++;
+                if (verbose) {
+                    printf("  һ£%s/%s  %dx%d(max %d)뾶 %dֵ %dCanny %d/%d (%d,%d)-(%d,%d)"
+                        " %dx%d %d߽ %dŵ %dx%d˲ %dṹԪ %dx%d %d"
+                        "߳ %dֵ %d/%d\n",
+                        var->kernel, var->variant, tc->a.width, tc->a.height, tc->a.max_val,
+                        tc->radius, tc->threshold, tc->low, tc->high, tc->x1, tc->y1, tc->x2, tc->y2,
+                        tc->kernel_size, tc->kernel_size, tc->kernel_divisor, tc->border,
+                        tc->out_width, tc->out_height, tc->filter, 2 * tc->rx + 1, 2 * tc->ry + 1, tc->morph_op,
+                        THREAD_COUNTS[t], ref_ret, opt_ret);
+                }
+            }
+            freePPM(&opt);
+        }
+        freePPM(&ref);
+    }
+    return failures;
+}
+
+/**
+ * ˣһˡɷˣһгһУҶԳƺֻǾĸר·
+ */
+void makeKernel(TestCase* tc) {
+    int n = 2 * randomRange(0, TEST_KERNEL_MAX_SIZE / 2) + 1;
+    int style = randomRange(0, 2);
+    int row[TEST_KERNEL_MAX_SIZE];
+    int col[TEST_KERNEL_MAX_SIZE];
+    for (int i = 0; i < n; i++) {
+        row[i] = randomRange(-4, 4);
+        col[i] = randomRange(-4, 4);
+    }
+    int sum = 0;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            int t;
+            if (style == 0) {
+                t = randomRange(-8, 8);
+            }
+            else if (style == 1) {
+                t = col[y] * row[x];
+            }
+            else {
+                t = x <= n / 2 ? randomRange(-8, 8) : tc->kernel_taps[y * n + (n - 1 - x)];
+            }
+            tc->kernel_taps[y * n + x] = t;
+            sum += abs(t);
+        }
+    }
+    tc->kernel_size = n;
+    tc->kernel_divisor = (nextRandom() & 1) ? 1 : randomRange(1, sum > 1 ? sum : 1);
+}
+
+/**
+ * һ
+ * @param width/heightߴ
+ */
+ErrorCode makeCase(TestCase* tc, int width, int height) {
+    memset(tc, 0, sizeof(TestCase));
+    int max_val = MAX_VALS[randomRange(0, MAX_VALS_COUNT - 1)];
+    if (makeRandomImage(&tc->a, width, height, max_val) != SUCCESS) {
+        return ERR_MEMORY_ALLOC;
+    }
+    tc->radius = randomRange(0, 5);
+    tc->threshold = (nextRandom() % 8 == 0) ? (int)(nextRandom() & 1) * 255 : randomRange(0, 255);
+    tc->high = (nextRandom() & 1) ? randomRange(0, 255) : randomRange(0, 1500);  // ż Canny ֵ 1443
+    tc->low = randomRange(0, tc->high);
+    tc->x1 = randomRange(-4, width);
+    tc->y1 = randomRange(-4, height);
+    tc->x2 = randomRange(tc->x1, width + 4);
+    tc->y2 = randomRange(tc->y1, height + 4);
+    makeKernel(tc);
+    tc->border = randomRange(CONV_BORDER_CONSTANT, CONV_BORDER_WRAP);
+    tc->border_value = randomRange(0, max_val);
+    tc->out_width = (nextRandom() % 4 == 0) ? width : randomRange(1, 2 * width);
+    tc->out_height = (nextRandom() % 4 == 0) ? height : randomRange(1, 2 * height);
+    tc->filter = randomRange(RESIZE_BOX, RESIZE_LANCZOS3);
+    tc->rx = randomRange(0, 5);
+    tc->ry = randomRange(0, 5);
+    tc->morph_op = randomRange(MORPH_ERODE, MORPH_CLOSE);
+    return SUCCESS;
+}
+
+//========== 汾 ==========
+
+// ĹùںˣBT.601 ҶȡSobel ţڹ̶ϵָơ
+// ں˶ RESULT_CACHE_VERSION ûм 1 ʱɻظĶǰĽ
+// ָƶԲϾͱȷѰ汾 1ѴӡָƵǼǵ
+typedef struct {
+    int version;
+    unsigned long long fingerprint;
+} CacheFingerprint;
+
+const CacheFingerprint CACHE_FINGERPRINTS[] = {
+    { 2, 0xF98AF3E17A812D3CULL }
+};
+const int CACHE_FINGERPRINTS_COUNT = sizeof(CACHE_FINGERPRINTS) / sizeof(CACHE_FINGERPRINTS[0]);
+
+unsigned long long fingerprintMix(unsigned long long hash, const int* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        hash = (hash ^ (unsigned int)values[i]) * 1099511628211ULL;  // FNV-1a int 
+    }
+    return hash;
+}
+
+/**
+ * ̶루޹أϸںָ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode cacheFingerprint(unsigned long long* hash) {
+    const int width = 97;
+    const int height = 61;
+    size_t count = (size_t)width * height;
+    int* rgb = (int*)malloc(sizeof(int) * count * 3);
+    unsigned char* gray = (unsigned char*)malloc(count);
+    int* gx = (int*)malloc(sizeof(int) * count);
+    int* gy = (int*)malloc(sizeof(int) * count);
+    int* scaled = (int*)malloc(sizeof(int) * 150 * 90 * 3);
+    ErrorCode ret = (rgb == NULL || gray == NULL || gx == NULL || gy == NULL || scaled == NULL) ? ERR_MEMORY_ALLOC : SUCCESS;
+    if (ret == SUCCESS) {
+        unsigned int seed = 20240601u;
+        for (size_t i = 0; i < count * 3; i++) {
+            seed = seed * 1103515245u + 12345u;
+            rgb[i] = (int)((seed >> 8) & 0xFF);
+        }
+        *hash = 14695981039346656037ULL;
+
+        // sobelԵ.cBT.601 Ҷ + ߺ Sobel 
+        colorToGray(rgb, gray, count, LUMA_BT601);
+        for (size_t i = 0; i < count; i++) {
+            gx[i] = gray[i];
+        }
+        *hash = fingerprintMix(*hash, gx, count);
+        PaddedPlane plane;
+        ConvKernel kx, ky;
+        convKernelInit(&kx, 3, SOBEL_GX, 1);
+        convKernelInit(&ky, 3, SOBEL_GY, 1);
+        if (padPlane(&plane, gx, width, height, 1) != 0) {
+            ret = ERR_MEMORY_ALLOC;
+        }
+        else {
+            int failed = convPadded(&plane, gx, &kx) != 0 || convPadded(&plane, gy, &ky) != 0;
+            freePadded(&plane);
+            ret = failed ? ERR_MEMORY_ALLOC : SUCCESS;
+        }
+        *hash = fingerprintMix(*hash, gx, count);
+        *hash = fingerprintMix(*hash, gy, count);
+    }
+
+    // ͼü.cüţŴСһΣ
+    for (int f = RESIZE_BOX; f <= RESIZE_LANCZOS3 && ret == SUCCESS; f++) {
+        int sizes[2][2] = { { 150, 90 }, { 23, 17 } };
+        for (int s = 0; s < 2 && ret == SUCCESS; s++) {
+            if (resizeImage(rgb, width, height, scaled, sizes[s][0], sizes[s][1], 3, 255, (ResizeFilter)f, 2) != 0) {
+                ret = ERR_MEMORY_ALLOC;
+            }
+            else {
+                *hash = fingerprintMix(*hash, scaled, (size_t)sizes[s][0] * sizes[s][1] * 3);
+            }
+        }
+    }
+    free(rgb);
+    free(gray);
+    free(gx);
+    free(gy);
+    free(scaled);
+    return ret;
+}
+
+/**
+ * ǰ RESULT_CACHE_VERSION ǼǵָƱںʵһ£1 ̸߳߳һΣ
+ * @return ʧܴ
+ */
+int checkCacheVersion(void) {
+    const unsigned long long* expected = NULL;
+    for (int i = 0; i < CACHE_FINGERPRINTS_COUNT; i++) {
+        if (CACHE_FINGERPRINTS[i].version == RESULT_CACHE_VERSION) {
+            expected = &CACHE_FINGERPRINTS[i].fingerprint;
+        }
+    }
+    int failures = 0;
+    for (int t = 0; t < THREAD_COUNTS_COUNT; t++) {
+        unsigned long long hash = 0;
+        setThreads(THREAD_COUNTS[t]);
+        if (cacheFingerprint(&hash) != SUCCESS) {
+            printf("%s\n", error_messages[ERR_MEMORY_ALLOC]);
+            return failures + 1;
+        }
+        if (expected == NULL || hash != *expected) {
+            printf("棺ںָ 0x%016llX߳ %d RESULT_CACHE_VERSION %d ǼǵĲһ£"
+                "ںıʱ .h İ汾 1 Ǽָ\n", hash, THREAD_COUNTS[t], RESULT_CACHE_VERSION);
+            failures++;
+        }
+    }
+    if (failures == 0) {
+        printf("棺汾 %d ںָһ\n", RESULT_CACHE_VERSION);
+    }
+    return failures;
+}
+
+//========== CLAHE ƽ̹ͼ ==========
+
+// ƽ̹ͼֵͬ CLAHE Ӧ䣺ضļΧϾ̯ڸֵƺȡ
+// ض߶ȼ 2 ӦֵС㣩ټ 1 
+typedef struct {
+    int width;
+    int height;
+    int tiles;
+    double clip;
+} ClaheFlatCase;
+
+const ClaheFlatCase CLAHE_FLAT_CASES[] = {
+    { 40, 30, 4, 2.0 }, { 97, 61, 8, 3.0 }, { 300, 200, 8, 2.0 }
+};
+const int CLAHE_FLAT_CASES_COUNT = sizeof(CLAHE_FLAT_CASES) / sizeof(CLAHE_FLAT_CASES[0]);
+
+/**
+ * 8 λ10 λ16 λֵ£ߴ硢Ҷֵƽ̹ͼ CLAHE ֮ݲ
+ * @return ʧܴ
+ */
+int checkClaheFlat(void) {
+    const int max_vals[] = { 255, 1023, 65535 };
+    int failures = 0;
+    for (int c = 0; c < CLAHE_FLAT_CASES_COUNT; c++) {
+        const ClaheFlatCase* fc = &CLAHE_FLAT_CASES[c];
+        size_t count = (size_t)fc->width * fc->height;
+        int* plane = (int*)malloc(sizeof(int) * count);
+        if (plane == NULL) {
+            printf("%s\n", error_messages[ERR_MEMORY_ALLOC]);
+            return failures + 1;
+        }
+        long long area = (long long)(fc->width / fc->tiles) * (fc->height / fc->tiles);
+        for (int m = 0; m < 3; m++) {
+            int max_val = max_vals[m];
+            long long limit = (long long)(fc->clip * area / (max_val + 1));
+            limit = limit > 1 ? limit : 1;
+            long long tolerance = ((limit + 2) * max_val + area - 1) / area + 1;
+            for (int k = 0; k <= 8; k++) {
+                int value = (int)((long long)max_val * k / 8);
+                for (size_t i = 0; i < count; i++) {
+                    plane[i] = value;
+                }
+                int worst = 0;
+                if (histClahe(plane, fc->width, fc->height, max_val, fc->tiles, fc->tiles, fc->clip) != 0) {
+                    worst = max_val;
+                }
+                for (size_t i = 0; i < count && worst < max_val; i++) {
+                    int diff = plane[i] > value ? plane[i] - value : value - plane[i];
+                    worst = diff > worst ? diff : worst;
+                }
+                if (worst > tolerance) {
+                    printf("CLAHE%dx%d ƽ̹ͼֵ %dֵ %d%dx%d 飬clip %.1fƫ %dݲ %lld\n",
+                        fc->width, fc->height, value, max_val, fc->tiles, fc->tiles, fc->clip, worst, tolerance);
+                    failures++;
+                }
+            }
+        }
+        free(plane);
+    }
+    if (failures == 0) {
+        printf("CLAHEƽ̹ͼһ£ݲڣ\n");
+    }
+    return failures;
+}
+
+/**
+ * ̶ܹ߽ߴ磬ߴ
+ */
+int main(int argc, char* argv[]) {
+    // 1. ò
+    int iterations = 200;    // 
+    int verbose = 1;         // ӡÿһ
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iters") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            g_seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--quiet") == 0) {
+            verbose = 0;
+        }
+        else {
+            printf("÷%s [--iters N] [--seed S] [--quiet]\n", argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+    }
+    printf("ӣ%u%d\n", g_seed, iterations);
+
+    // 2. 
+    VariantReport reports[sizeof(VARIANTS) / sizeof(VARIANTS[0])];
+    memset(reports, 0, sizeof(reports));
+    int failures = 0;
+    for (int i = 0; i < EDGE_SIZES_COUNT + iterations; i++) {
+        int width, height;
+        if (i < EDGE_SIZES_COUNT) {
+            width = EDGE_SIZES[i][0];
+            height = EDGE_SIZES[i][1];
+        }
+        else {
+            width = randomRange(1, 300);
+            height = randomRange(1, 200);
+        }
+        TestCase tc;
+        if (makeCase(&tc, width, height) != SUCCESS) {
+            printf("%s\n", error_messages[ERR_MEMORY_ALLOC]);
+            return ERR_MEMORY_ALLOC;
+        }
+        failures += runCase(&tc, reports, verbose);
+        freePPM(&tc.a);
+    }
+
+    // 3. 
+    printf("%-10s %-12s %8s %8s %10s %12s %10s\n",
+        "ں", "汾", "", "ʧ", "", "һ%", "ݲ");
+    for (int v = 0; v < VARIANTS_COUNT; v++) {
+        char tol[32];
+        sprintf(tol, "%d/%.1f%%", VARIANTS[v].tolerance.max_abs_diff,
+            VARIANTS[v].tolerance.max_mismatch_ratio * 100.0);
+        printf("%-10s %-12s %8d %8d %10d %12.3f %10s\n",
+            VARIANTS[v].kernel, VARIANTS[v].variant, reports[v].cases, reports[v].failures,
+            reports[v].max_diff_seen, reports[v].worst_mismatch_ratio * 100.0, tol);
+    }
+    failures += checkCacheVersion();
+    failures += checkClaheFlat();
+    if (failures > 0) {
+        printf("%s%d Σ\n", error_messages[ERR_MISMATCH], failures);
+        return ERR_MISMATCH;
+    }
+    printf("ȫһ\n");
+    return SUCCESS;
+}
\ No newline at end of file
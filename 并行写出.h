@@ -0,0 +1,278 @@
+/**
+ * дȰմСԤļ̸߳ʽԼд֪ƫƶλд룬ֻһ fsync
+ *
+ * P6 ÿдֽȿ֪P3 Ȳÿдʽĳȣǰ׺͵õдƫƣ
+ * ٲиʽд룬ҪıŽڴ档
+ * ıŲԭ writePPM ֽһ£ÿոÿ 3 ػУ
+ * ʱ -fopenmpgcc /openmpMSVC߳дд˳д
+ *  Windows ƽ̨Ҫڰ <stdio.h> ֮ǰ _POSIX_C_SOURCE 200809Lpwrite / fsync
+ * ÷
+ *   long long n = parallelWritePPM(path, (const int*)ppm->data, width, height, max_val, 0);
+ *   Pixel{int r, g, b} 鰴 int 鴫뼴
+ */
+#ifndef PARALLEL_WRITE_H
+#define PARALLEL_WRITE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define PARALLEL_WRITE_BAND_ROWS 64  // ÿд
+
+//========== ļԤ + λд룩 ==========
+
+#ifdef _WIN32
+typedef HANDLE OutFile;
+#define OUT_FILE_INVALID INVALID_HANDLE_VALUE
+#else
+typedef int OutFile;
+#define OUT_FILE_INVALID (-1)
+#endif
+
+/**
+ * ļԤ total ֽ
+ */
+static inline OutFile outFileCreate(const char* path, long long total) {
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        return h;
+    }
+    LARGE_INTEGER size;
+    size.QuadPart = total;
+    if (!SetFilePointerEx(h, size, NULL, FILE_BEGIN) || !SetEndOfFile(h)) {
+        CloseHandle(h);
+        return INVALID_HANDLE_VALUE;
+    }
+    return h;
+#else
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    int ret = -1;
+#ifdef __linux__
+    ret = posix_fallocate(fd, 0, (off_t)total);
+#endif
+    if (ret != 0 && ftruncate(fd, (off_t)total) != 0) {
+        // ļϵͳ֧ fallocate ʱ˻ ftruncateϡļ
+        close(fd);
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+/**
+ *  offset д n ֽڣƶļָ룬ɶ߳ͬʱ
+ * @return 0=ɹ-1=ʧ
+ */
+static inline int outFileWriteAt(OutFile f, long long offset, const unsigned char* buf, size_t n) {
+    while (n > 0) {
+        size_t chunk = n > (1u << 30) ? (1u << 30) : n;
+#ifdef _WIN32
+        OVERLAPPED ov;
+        memset(&ov, 0, sizeof(ov));
+        ov.Offset = (DWORD)(offset & 0xFFFFFFFF);
+        ov.OffsetHigh = (DWORD)(offset >> 32);
+        DWORD written = 0;
+        if (!WriteFile(f, buf, (DWORD)chunk, &written, &ov) || written == 0) {
+            return -1;
+        }
+#else
+        ssize_t written = pwrite(f, buf, chunk, (off_t)offset);
+        if (written <= 0) {
+            return -1;
+        }
+#endif
+        buf += written;
+        offset += written;
+        n -= (size_t)written;
+    }
+    return 0;
+}
+
+/**
+ * ˢ̣дֻһΣر
+ * @return 0=ɹ-1=ʧ
+ */
+static inline int outFileClose(OutFile f) {
+#ifdef _WIN32
+    int failed = !FlushFileBuffers(f);
+    failed |= !CloseHandle(f);
+#else
+    int failed = fsync(f) != 0;
+    failed |= close(f) != 0;
+#endif
+    return failed ? -1 : 0;
+}
+
+//========== P3 дĳʽ ==========
+
+static inline int decimalLength(int v) {
+    int len = v < 0 ? 2 : 1;
+    unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+    while (u >= 10) {
+        u /= 10;
+        len++;
+    }
+    return len;
+}
+
+/**
+ *  [first, first+count)  P3 ʽֽ
+ */
+static inline long long p3BandLength(const int* samples, long long first, long long count) {
+    long long len = 0;
+    for (long long i = first; i < first + count; i++) {
+        const int* s = samples + i * 3;
+        len += decimalLength(s[0]) + decimalLength(s[1]) + decimalLength(s[2]) + 3;
+        if ((i + 1) % 3 == 0) {
+            len++;
+        }
+    }
+    return len;
+}
+
+static inline unsigned char* putDecimal(unsigned char* p, int v) {
+    unsigned char tmp[12];
+    int n = 0;
+    unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+    do {
+        tmp[n++] = (unsigned char)('0' + u % 10);
+        u /= 10;
+    } while (u > 0);
+    if (v < 0) {
+        *p++ = '-';
+    }
+    while (n > 0) {
+        *p++ = tmp[--n];
+    }
+    *p++ = ' ';
+    return p;
+}
+
+/**
+ *  [first, first+count)  P3 ʽ buf
+ * @return дֽ
+ */
+static inline size_t p3BandFormat(const int* samples, long long first, long long count, unsigned char* buf) {
+    unsigned char* p = buf;
+    for (long long i = first; i < first + count; i++) {
+        const int* s = samples + i * 3;
+        p = putDecimal(p, s[0]);
+        p = putDecimal(p, s[1]);
+        p = putDecimal(p, s[2]);
+        if ((i + 1) % 3 == 0) {
+            *p++ = '\n';
+        }
+    }
+    return (size_t)(p - buf);
+}
+
+/**
+ *  [first, first+count)  P6 д bufmax_val > 255 ʱÿ 2 ֽڴˣ
+ */
+static inline size_t p6BandFormat(const int* samples, long long first, long long count, int wide, unsigned char* buf) {
+    unsigned char* p = buf;
+    const int* s = samples + first * 3;
+    for (long long i = 0; i < count * 3; i++) {
+        if (wide) {
+            *p++ = (unsigned char)(s[i] >> 8);
+        }
+        *p++ = (unsigned char)s[i];
+    }
+    return (size_t)(p - buf);
+}
+
+//========== д ==========
+
+/**
+ * дPPM
+ * @param sampleswidth*height*3  RGB 
+ * @param binary1=P60=P3
+ * @return дֽʧܷ -1
+ */
+static inline long long parallelWritePPM(const char* path, const int* samples, int width, int height, int max_val, int binary) {
+    if (path == NULL || samples == NULL || width <= 0 || height <= 0) {
+        return -1;
+    }
+    char header[64];
+    int header_len = snprintf(header, sizeof(header), "%s\n%d %d\n%d\n", binary ? "P6" : "P3", width, height, max_val);
+    int bands = (height + PARALLEL_WRITE_BAND_ROWS - 1) / PARALLEL_WRITE_BAND_ROWS;
+    long long* offsets = (long long*)malloc(sizeof(long long) * (bands + 1));
+    if (offsets == NULL) {
+        return -1;
+    }
+    int wide = max_val > 255;
+
+    // 1. дȣP6 ֱP3 ʽֽ
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int b = 0; b < bands; b++) {
+        long long first = (long long)b * PARALLEL_WRITE_BAND_ROWS * width;
+        int rows = height - b * PARALLEL_WRITE_BAND_ROWS;
+        long long count = (long long)(rows < PARALLEL_WRITE_BAND_ROWS ? rows : PARALLEL_WRITE_BAND_ROWS) * width;
+        offsets[b + 1] = binary ? count * 3 * (wide ? 2 : 1) : p3BandLength(samples, first, count);
+    }
+
+    // 2. ǰ׺͵õÿдļеƫ
+    offsets[0] = header_len;
+    long long band_max = 0;
+    for (int b = 0; b < bands; b++) {
+        if (offsets[b + 1] > band_max) {
+            band_max = offsets[b + 1];
+        }
+        offsets[b + 1] += offsets[b];
+    }
+    long long total = offsets[bands];
+
+    // 3. Ԥļ
+    OutFile file = outFileCreate(path, total);
+    if (file == OUT_FILE_INVALID) {
+        free(offsets);
+        return -1;
+    }
+    int failed = outFileWriteAt(file, 0, (const unsigned char*)header, (size_t)header_len) != 0;
+
+    // 4. ̸߳ʽԼдд֪ƫƣ尴ֻ߳һ
+    #pragma omp parallel
+    {
+        unsigned char* buf = (unsigned char*)malloc((size_t)band_max);
+        int local_failed = buf == NULL;
+        #pragma omp for schedule(dynamic, 1)
+        for (int b = 0; b < bands; b++) {
+            if (local_failed) {
+                continue;
+            }
+            long long first = (long long)b * PARALLEL_WRITE_BAND_ROWS * width;
+            int rows = height - b * PARALLEL_WRITE_BAND_ROWS;
+            long long count = (long long)(rows < PARALLEL_WRITE_BAND_ROWS ? rows : PARALLEL_WRITE_BAND_ROWS) * width;
+            size_t n = binary ? p6BandFormat(samples, first, count, wide, buf) : p3BandFormat(samples, first, count, buf);
+            if ((long long)n != offsets[b + 1] - offsets[b] || outFileWriteAt(file, offsets[b], buf, n) != 0) {
+                local_failed = 1;
+            }
+        }
+        free(buf);
+        if (local_failed) {
+            #pragma omp atomic write
+            failed = 1;
+        }
+    }
+
+    // 5. һ fsync ر
+    failed |= outFileClose(file) != 0;
+    free(offsets);
+    return failed ? -1 : total;
+}
+
+#endif
\ No newline at end of file
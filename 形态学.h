@@ -0,0 +1,397 @@
+/**
+ * ̬ѧνṹԪصĸʴ͡㣬Ҷƽ밴λĶֵͼʵ
+ *
+ * ṹԪΪ (2*rx+1) x (2*ry+1) ľΣɷֽΪȺһάС/ֵͼⲻ
+ * ʴʱΪֵʱΪСֵԵĴֻȡͼڲ֡
+ *  = ȡȡͼʴȡʵֶֻдһСֵ/λ롣
+ *
+ * Ҷƽ棺van Herk/Gil-WermanһгɳΪ k=2r+1 ĶΣڷֱǰ׺Сͺ׺С
+ * һǡÿΣΪ ׺[x]  ǰ׺[x+2r] ĽСߣÿ 3 αȽϣ뾶޹ء
+ * һÿδ MORPH_STRIP Ужһͬǰ׺/׺ڲѭ
+ *
+ * ֵͼPBM P4 İλʽ sobelԵ.c  BitMaskڲÿ 64 һ֣
+ * һΰλ봦 64 ء m ġȫ 1 m/2 Ľλ뱶õ
+ *  [x-r, x+r] Ϊ m 2r+1  2 ݣ串ǣÿ O(log r) 㡣
+ * ÷
+ *   morphPlane(plane, width, height, rx, ry, MORPH_CLOSE);                // ԭش int ƽ
+ *   morphMaskBits(mask.bits, mask.stride, width, height, 1, 1, MORPH_OPEN);  // ԭش P4 λͼ
+ */
+#ifndef MORPHOLOGY_H
+#define MORPHOLOGY_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MORPH_STRIP 64  // һͬʱ
+
+typedef enum {
+    MORPH_ERODE = 0,
+    MORPH_DILATE,
+    MORPH_OPEN,   // ȸʴͣȥСڽṹԪص㡢ϸ
+    MORPH_CLOSE   // ٸʴСڽṹԪصİ졢Ͽ
+} MorphOp;
+
+/**
+ * ȡ㣨erode / dilate / open / close
+ * @return 㣬ֲʶʱΪ -1
+ */
+static inline int morphOpByName(const char* name) {
+    static const char* names[] = { "erode", "dilate", "open", "close" };
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static inline int morphMin(int a, int b) {
+    return a < b ? a : b;
+}
+
+static inline int morphBands(int count) {
+    int bands = 1;
+#ifdef _OPENMP
+    bands = omp_get_max_threads();
+#endif
+    return bands < count ? bands : count;
+}
+
+//========== Ҷƽ棨van Herk/Gil-Werman ==========
+
+/**
+ * һԭ󴰿 [x-r, x+r]  sign*ֵ Сֵٳ˻ signsign=-1 ֵ
+ * @param pgh width+2r  int Ĺ
+ */
+static inline void morphRow(int* row, int width, int r, int sign, int* p, int* g, int* h) {
+    int k = 2 * r + 1;
+    int n = width + 2 * r;
+    for (int i = 0; i < n; i++) {
+        p[i] = (i >= r && i < r + width) ? sign * row[i - r] : INT_MAX;
+    }
+    for (int s = 0; s < n; s += k) {
+        int e = s + k < n ? s + k : n;
+        g[s] = p[s];
+        for (int i = s + 1; i < e; i++) {
+            g[i] = morphMin(g[i - 1], p[i]);
+        }
+        h[e - 1] = p[e - 1];
+        for (int i = e - 2; i >= s; i--) {
+            h[i] = morphMin(h[i + 1], p[i]);
+        }
+    }
+    for (int x = 0; x < width; x++) {
+        row[x] = sign * morphMin(h[x], g[x + 2 * r]);
+    }
+}
+
+/**
+ * ȡߺ i е count У signͼΪ INT_MAX
+ */
+static inline void morphColumnLoad(const int* plane, int width, int height, int r, int sign, int i, int x0, int count, int* out) {
+    if (i < r || i >= r + height) {
+        for (int c = 0; c < count; c++) {
+            out[c] = INT_MAX;
+        }
+        return;
+    }
+    const int* src = plane + (size_t)(i - r) * width + x0;
+    #pragma omp simd
+    for (int c = 0; c < count; c++) {
+        out[c] = sign * src[c];
+    }
+}
+
+/**
+ * һ飺 [x0, x0+count) ԭ󴰿 [y-r, y+r] Сֵsign ͬ morphRow
+ * @param gh (height+2r)*MORPH_STRIP  int Ĺ
+ */
+static inline void morphColumns(int* plane, int width, int height, int r, int sign, int x0, int count, int* g, int* h) {
+    int k = 2 * r + 1;
+    int n = height + 2 * r;
+    for (int s = 0; s < n; s += k) {
+        int e = s + k < n ? s + k : n;
+        morphColumnLoad(plane, width, height, r, sign, s, x0, count, g + (size_t)s * MORPH_STRIP);
+        for (int i = s + 1; i < e; i++) {
+            int* gi = g + (size_t)i * MORPH_STRIP;
+            morphColumnLoad(plane, width, height, r, sign, i, x0, count, gi);
+            #pragma omp simd
+            for (int c = 0; c < count; c++) {
+                gi[c] = morphMin(gi[c - MORPH_STRIP], gi[c]);
+            }
+        }
+        morphColumnLoad(plane, width, height, r, sign, e - 1, x0, count, h + (size_t)(e - 1) * MORPH_STRIP);
+        for (int i = e - 2; i >= s; i--) {
+            int* hi = h + (size_t)i * MORPH_STRIP;
+            morphColumnLoad(plane, width, height, r, sign, i, x0, count, hi);
+            #pragma omp simd
+            for (int c = 0; c < count; c++) {
+                hi[c] = morphMin(hi[c + MORPH_STRIP], hi[c]);
+            }
+        }
+    }
+    for (int y = 0; y < height; y++) {
+        const int* hy = h + (size_t)y * MORPH_STRIP;
+        const int* gy = g + (size_t)(y + 2 * r) * MORPH_STRIP;
+        int* dst = plane + (size_t)y * width + x0;
+        #pragma omp simd
+        for (int c = 0; c < count; c++) {
+            dst[c] = sign * morphMin(hy[c], gy[c]);
+        }
+    }
+}
+
+/**
+ * Ҷƽԭظʴsign=1ͣsign=-1
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int morphPlanePass(int* plane, int width, int height, int rx, int ry, int sign) {
+    int failed = 0;
+    if (rx > 0) {
+        int bands = morphBands(height);
+        #pragma omp parallel for schedule(static) reduction(|:failed)
+        for (int b = 0; b < bands; b++) {
+            int n = width + 2 * rx;
+            int* work = (int*)malloc(sizeof(int) * 3 * n);
+            if (work == NULL) {
+                failed = 1;
+                continue;
+            }
+            int y0 = (int)((long long)height * b / bands);
+            int y1 = (int)((long long)height * (b + 1) / bands);
+            for (int y = y0; y < y1; y++) {
+                morphRow(plane + (size_t)y * width, width, rx, sign, work, work + n, work + 2 * n);
+            }
+            free(work);
+        }
+    }
+    if (ry > 0 && !failed) {
+        int strips = (width + MORPH_STRIP - 1) / MORPH_STRIP;
+        int bands = morphBands(strips);
+        #pragma omp parallel for schedule(static) reduction(|:failed)
+        for (int b = 0; b < bands; b++) {
+            size_t n = (size_t)(height + 2 * ry) * MORPH_STRIP;
+            int* work = (int*)malloc(sizeof(int) * 2 * n);
+            if (work == NULL) {
+                failed = 1;
+                continue;
+            }
+            int s0 = (int)((long long)strips * b / bands);
+            int s1 = (int)((long long)strips * (b + 1) / bands);
+            for (int s = s0; s < s1; s++) {
+                int x0 = s * MORPH_STRIP;
+                int count = width - x0 < MORPH_STRIP ? width - x0 : MORPH_STRIP;
+                morphColumns(plane, width, height, ry, sign, x0, count, work, work + n);
+            }
+            free(work);
+        }
+    }
+    return failed ? -1 : 0;
+}
+
+/**
+ * Ҷƽԭ̬ѧ
+ * @param planewidth*height Ǹ
+ * @param rxryṹԪΪ (2*rx+1) x (2*ry+1)Ϊ 0 ʱ÷򲻴
+ * @param opMORPH_ERODE / MORPH_DILATE / MORPH_OPEN / MORPH_CLOSE
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int morphPlane(int* plane, int width, int height, int rx, int ry, MorphOp op) {
+    if (plane == NULL || width <= 0 || height <= 0 || rx < 0 || ry < 0) {
+        return -1;
+    }
+    int first = (op == MORPH_ERODE || op == MORPH_OPEN) ? 1 : -1;
+    if (morphPlanePass(plane, width, height, rx, ry, first) != 0) {
+        return -1;
+    }
+    if (op == MORPH_OPEN || op == MORPH_CLOSE) {
+        return morphPlanePass(plane, width, height, rx, ry, -first);
+    }
+    return 0;
+}
+
+//========== λĶֵͼ ==========
+
+#define MORPH_ONES (~0ULL)
+
+/**
+ * λ posΪȡ 64 أ洢ΧΪȫ 1
+ */
+static inline unsigned long long morphBits64(const unsigned long long* row, int words, long long pos) {
+    long long q = pos >= 0 ? pos / 64 : -((-pos + 63) / 64);
+    int b = (int)(pos - q * 64);
+    unsigned long long lo = (q >= 0 && q < words) ? row[q] : MORPH_ONES;
+    if (b == 0) {
+        return lo;
+    }
+    unsigned long long hi = (q + 1 >= 0 && q + 1 < words) ? row[q + 1] : MORPH_ONES;
+    return (lo << b) | (hi >> (64 - b));
+}
+
+/**
+ * һԭظʴdst[x] = [x-r, x+r] ȫΪ 1
+ * @param runwords ֵĹ桰x ߹ m ȫΪ 1
+ */
+static inline void morphBitsRow(unsigned long long* row, int words, int r, unsigned long long* run) {
+    int k = 2 * r + 1;
+    long long m = 1;
+    memcpy(run, row, sizeof(unsigned long long) * words);
+    while (2 * m <= k) {
+        for (int j = words - 1; j >= 0; j--) {  // ֻߣԭظ
+            run[j] &= morphBits64(run, words, (long long)j * 64 - m);
+        }
+        m *= 2;
+    }
+    for (int j = 0; j < words; j++) {
+        long long x = (long long)j * 64;
+        row[j] = morphBits64(run, words, x - r + m - 1) & morphBits64(run, words, x + r);
+    }
+}
+
+/**
+ * λʴһ飻invert=1 ʱȡ
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int morphMaskPass(unsigned char* bits, int stride, int width, int height, int rx, int ry, int invert) {
+    int words = (width + rx + 63) / 64;  // ұ߶ rx أҶ˲洢Χ
+    int rows = height + ry;
+    size_t count = (size_t)words * rows;
+    unsigned long long* a = (unsigned long long*)malloc(sizeof(unsigned long long) * count * (ry > 0 ? 3 : 1));
+    if (a == NULL) {
+        return -1;
+    }
+    unsigned long long flip = invert ? MORPH_ONES : 0;
+    int tail = width % 64;
+    int used = (width + 7) / 8;
+
+    // 1. 룺ÿ 8 ֽƴһ֣λ󣩣ͼȫ 1
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < rows; y++) {
+        unsigned long long* row = a + (size_t)y * words;
+        if (y >= height) {
+            for (int j = 0; j < words; j++) {
+                row[j] = MORPH_ONES;
+            }
+            continue;
+        }
+        const unsigned char* src = bits + (size_t)y * stride;
+        for (int j = 0; j < words; j++) {
+            unsigned long long v = 0;
+            for (int t = 0; t < 8; t++) {
+                int i = j * 8 + t;
+                v = (v << 8) | (i < used ? src[i] : 0);
+            }
+            v ^= flip;
+            if (j * 64 + 64 > width) {
+                v |= j * 64 >= width ? MORPH_ONES : MORPH_ONES >> tail;
+            }
+            row[j] = v;
+        }
+    }
+
+    // 2. 
+    int failed = 0;
+    if (rx > 0) {
+        int bands = morphBands(height);
+        #pragma omp parallel for schedule(static) reduction(|:failed)
+        for (int b = 0; b < bands; b++) {
+            unsigned long long* run = (unsigned long long*)malloc(sizeof(unsigned long long) * words);
+            if (run == NULL) {
+                failed = 1;
+                continue;
+            }
+            int y0 = (int)((long long)height * b / bands);
+            int y1 = (int)((long long)height * (b + 1) / bands);
+            for (int y = y0; y < y1; y++) {
+                morphBitsRow(a + (size_t)y * words, words, rx, run);
+            }
+            free(run);
+        }
+    }
+
+    // 3. аλ룬ʱ黺彻棬мɲ
+    unsigned long long* result = a;
+    if (ry > 0 && !failed) {
+        int k = 2 * ry + 1;
+        int m = 1;
+        unsigned long long* run = a + count;
+        unsigned long long* next = a + 2 * count;
+        memcpy(run, a, sizeof(unsigned long long) * count);
+        while (2 * m <= k) {
+            #pragma omp parallel for schedule(static)
+            for (int y = 0; y < rows; y++) {
+                unsigned long long* dst = next + (size_t)y * words;
+                const unsigned long long* cur = run + (size_t)y * words;
+                if (y < m) {
+                    memcpy(dst, cur, sizeof(unsigned long long) * words);
+                    continue;
+                }
+                const unsigned long long* above = run + (size_t)(y - m) * words;
+                #pragma omp simd
+                for (int j = 0; j < words; j++) {
+                    dst[j] = cur[j] & above[j];
+                }
+            }
+            unsigned long long* t = run;
+            run = next;
+            next = t;
+            m *= 2;
+        }
+        #pragma omp parallel for schedule(static)
+        for (int y = 0; y < height; y++) {
+            const unsigned long long* top = run + (size_t)(y - ry + m - 1) * words;
+            const unsigned long long* bottom = run + (size_t)(y + ry) * words;
+            unsigned long long* dst = next + (size_t)y * words;
+            #pragma omp simd
+            for (int j = 0; j < words; j++) {
+                dst[j] = top[j] & bottom[j];
+            }
+        }
+        result = next;
+    }
+
+    // 4. дأβλ 0
+    if (!failed) {
+        #pragma omp parallel for schedule(static)
+        for (int y = 0; y < height; y++) {
+            const unsigned long long* row = result + (size_t)y * words;
+            unsigned char* dst = bits + (size_t)y * stride;
+            for (int i = 0; i < used; i++) {
+                unsigned long long v = row[i / 8] ^ flip;
+                dst[i] = (unsigned char)(v >> (56 - 8 * (i % 8)));
+            }
+            if (width % 8 != 0) {
+                dst[used - 1] &= (unsigned char)(0xFF << (8 - width % 8));
+            }
+        }
+    }
+    free(a);
+    return failed ? -1 : 0;
+}
+
+/**
+ * λĶֵͼԭ̬ѧ㣨1=ǰ
+ * @param bitsÿ stride ֽڣλβλΪ 0
+ * @param rxryṹԪΪ (2*rx+1) x (2*ry+1)Ϊ 0 ʱ÷򲻴
+ * @param opMORPH_ERODE / MORPH_DILATE / MORPH_OPEN / MORPH_CLOSE
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int morphMaskBits(unsigned char* bits, int stride, int width, int height, int rx, int ry, MorphOp op) {
+    if (bits == NULL || width <= 0 || height <= 0 || stride < (width + 7) / 8 || rx < 0 || ry < 0) {
+        return -1;
+    }
+    int first = (op == MORPH_ERODE || op == MORPH_OPEN) ? 0 : 1;
+    if (morphMaskPass(bits, stride, width, height, rx, ry, first) != 0) {
+        return -1;
+    }
+    if (op == MORPH_OPEN || op == MORPH_CLOSE) {
+        return morphMaskPass(bits, stride, width, height, rx, ry, !first);
+    }
+    return 0;
+}
+
+#endif
\ No newline at end of file
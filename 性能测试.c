@@ -0,0 +1,1039 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include ".h"
+#include "ɫת.h"
+#include ".h"
+#include "˹ģ.h"
+
+// ؽṹ壨RGBͨ
+typedef struct {
+    int r;
+    int g;
+    int b;
+} Pixel;
+
+// PPMͼṹ
+typedef struct {
+    int width;    // ͼ
+    int height;   // ͼ߶
+    int max_val;  // ֵ
+    Pixel* data;  // 
+} PPM;
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_CROP_OUT_OF_BOUNDS,
+    ERR_BAD_ARGUMENT,
+    ERR_REGRESSION
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PPM P3ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "󣺲ü򳬳ͼ߽",
+    "вϷ",
+    "ȳ˻"
+};
+
+// Գߴ磨xߣĬϲܣ --sizes all 
+typedef struct {
+    int width;
+    int height;
+} BenchSize;
+
+const BenchSize ALL_SIZES[] = {
+    { 256, 256 },
+    { 512, 512 },
+    { 1024, 1024 },
+    { 2048, 2048 },
+    { 4096, 4096 },
+    { 7680, 4320 }  // 8K
+};
+const int ALL_SIZES_COUNT = sizeof(ALL_SIZES) / sizeof(ALL_SIZES[0]);
+const int DEFAULT_SIZES_COUNT = 4;
+
+// Խ
+typedef struct {
+    char name[32];
+    int width;
+    int height;
+    int reps;
+    double mean_ns;      // ƽʱ
+    double stddev_ns;    // ׼
+    double min_ns;       // һ
+    double ns_per_pixel; // ƽÿغʱ
+    double mb_per_s;     // ƽ
+} BenchResult;
+
+/**
+ * ͷPPMͼĶ̬ڴ
+ */
+void freePPM(PPM* ppm) {
+    if (ppm != NULL && ppm->data != NULL) {
+        free(ppm->data);
+        ppm->data = NULL;
+    }
+}
+
+/**
+ * ȡPPM P3ʽͼ sobelԵ.c еʵһ£
+ * @param filenameļ·
+ * @param ppmPPMṹ壨ǰ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readPPM(const char* filename, PPM* ppm) {
+    ppm->width = 0;
+    ppm->height = 0;
+    ppm->max_val = 0;
+    ppm->data = NULL;
+
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    char format[4];
+    if (fscanf(file, "%3s", format) != 1 || strcmp(format, "P3") != 0) {
+        fclose(file);
+        return ERR_WRONG_FORMAT;
+    }
+
+    char ch;
+    while ((ch = fgetc(file)) == '#') {
+        while (fgetc(file) != '\n');
+    }
+    ungetc(ch, file);
+
+    if (fscanf(file, "%d%d%d", &ppm->width, &ppm->height, &ppm->max_val) != 3) {
+        fclose(file);
+        return ERR_FILE_BROKEN;
+    }
+
+    if (ppm->width <= 0 || ppm->height <= 0 || ppm->max_val <= 0 || ppm->max_val > 255) {
+        fclose(file);
+        return ERR_ILLEGAL_SIZE;
+    }
+
+    ppm->data = (Pixel*)malloc(sizeof(Pixel) * ppm->width * ppm->height);
+    if (ppm->data == NULL) {
+        fclose(file);
+        return ERR_MEMORY_ALLOC;
+    }
+
+    for (int i = 0; i < ppm->width * ppm->height; i++) {
+        if (fscanf(file, "%d%d%d", &ppm->data[i].r, &ppm->data[i].g, &ppm->data[i].b) != 3) {
+            freePPM(ppm);
+            fclose(file);
+            return ERR_FILE_BROKEN;
+        }
+    }
+
+    fclose(file);
+    return SUCCESS;
+}
+
+/**
+ * PPM P3ʽͼ sobelԵ.c еʵһ£
+ * @param filenameļ·
+ * @param ppmPPMͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writePPM(const char* filename, const PPM* ppm) {
+    if (filename == NULL || ppm == NULL || ppm->data == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+
+    if (fprintf(file, "P3\n") < 0 ||
+        fprintf(file, "%d %d\n", ppm->width, ppm->height) < 0 ||
+        fprintf(file, "%d\n", ppm->max_val) < 0) {
+        fclose(file);
+        return ERR_WRITE_FAILED;
+    }
+
+    for (int i = 0; i < ppm->width * ppm->height; i++) {
+        if (fprintf(file, "%d %d %d ", ppm->data[i].r, ppm->data[i].g, ppm->data[i].b) < 0) {
+            fclose(file);
+            return ERR_WRITE_FAILED;
+        }
+        if ((i + 1) % 3 == 0) {
+            fprintf(file, "\n");
+        }
+    }
+
+    fclose(file);
+    return SUCCESS;
+}
+
+/**
+ * ΪͼͬС
+ */
+ErrorCode allocLike(const PPM* in, PPM* out, int width, int height) {
+    out->width = width;
+    out->height = height;
+    out->max_val = in->max_val;
+    out->data = (Pixel*)malloc(sizeof(Pixel) * width * height);
+    if (out->data == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+//========== ںеʵֱһ£õͷļֱӵͬһݴ룬Ϊʽ ==========
+
+/**
+ * ࣨ.c
+ */
+ErrorCode kernelInvert(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    (void)param;
+    ErrorCode ret = allocLike(in, out, in->width, in->height);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    for (int i = 0; i < in->width * in->height; i++) {
+        out->data[i].r = in->max_val - in->data[i].r;
+        out->data[i].g = in->max_val - in->data[i].g;
+        out->data[i].b = in->max_val - in->data[i].b;
+    }
+    return SUCCESS;
+}
+
+/**
+ * ҶȻҶȻ.cͨƽɫת.h
+ * ҶȻ.c ͨ PGMҶƽд out ǰ width*height  int
+ */
+ErrorCode kernelGray(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    (void)param;
+    ErrorCode ret = allocLike(in, out, in->width, in->height);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    colorToGrayWide((const int*)in->data, (int*)out->data, (size_t)in->width * in->height, LUMA_AVERAGE);
+    return SUCCESS;
+}
+
+/**
+ * תãͼת.c
+ */
+ErrorCode kernelTranspose(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    (void)param;
+    int width = in->width;
+    int height = in->height;
+    ErrorCode ret = allocLike(in, out, height, width);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            out->data[y + x * height] = in->data[x + y * width];
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * üͼü.cõܸ 1/8м 3/4
+ */
+ErrorCode kernelCrop(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    (void)param;
+    int x0 = in->width / 8;
+    int y0 = in->height / 8;
+    int cropW = in->width - 2 * x0;
+    int cropH = in->height - 2 * y0;
+    ErrorCode ret = allocLike(in, out, cropW, cropH);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    for (int y = 0; y < cropH; y++) {
+        for (int x = 0; x < cropW; x++) {
+            out->data[x + y * cropW] = in->data[(x0 + x) + (y0 + y) * in->width];
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ˹ģ˹ģ.c˹ģ.hģȡͼ
+ * @param paramģ뾶
+ */
+ErrorCode kernelBlur(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    ErrorCode ret = allocLike(in, out, in->width, in->height);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    if (blurRegion((const int*)in->data, in->width, in->height, 0, 0, in->width - 1, in->height - 1, param, (int*)out->data) != 0) {
+        freePPM(out);
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+// sobelԵ.c  Sobel 
+static const int SOBEL_GX[9] = { -1, 0, 1, -2, 0, 2, -1, 0, 1 };
+static const int SOBEL_GY[9] = { -1, -2, -1, 0, 0, 0, 1, 2, 1 };
+
+/**
+ * SobelԵ⣨sobelԵ.cBT.601 Ҷȣɫת.h 0 ߺþ GxGy
+ * ֵֵٰ߿ú
+ * @param paramԵֵ
+ */
+ErrorCode kernelSobel(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    int width = in->width;
+    int height = in->height;
+    if (width < 3 || height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    size_t count = (size_t)width * height;
+    unsigned char* gray = (unsigned char*)malloc(count);
+    int* gx = (int*)malloc(sizeof(int) * count);
+    int* gy = (int*)malloc(sizeof(int) * count);
+    ErrorCode ret = (gray == NULL || gx == NULL || gy == NULL) ? ERR_MEMORY_ALLOC : allocLike(in, out, width, height);
+    if (ret == SUCCESS) {
+        out->max_val = 255;
+        colorToGray((const int*)in->data, gray, count, LUMA_BT601);
+        for (size_t i = 0; i < count; i++) {
+            gx[i] = gray[i];
+        }
+        PaddedPlane plane;
+        ConvKernel kx, ky;
+        convKernelInit(&kx, 3, SOBEL_GX, 1);
+        convKernelInit(&ky, 3, SOBEL_GY, 1);
+        if (padPlane(&plane, gx, width, height, 1) != 0) {
+            ret = ERR_MEMORY_ALLOC;
+        }
+        else {
+            int failed = convPadded(&plane, gx, &kx) != 0 || convPadded(&plane, gy, &ky) != 0;
+            freePadded(&plane);
+            ret = failed ? ERR_MEMORY_ALLOC : SUCCESS;
+        }
+    }
+    if (ret == SUCCESS) {
+        for (int y = 1; y < height - 1; y++) {
+            for (int x = 1; x < width - 1; x++) {
+                int idx = x + y * width;
+                double magnitude = sqrt((double)(gx[idx] * gx[idx] + gy[idx] * gy[idx]));
+                int edge = (magnitude >= param) ? 255 : 0;
+                out->data[idx].r = edge;
+                out->data[idx].g = edge;
+                out->data[idx].b = edge;
+            }
+        }
+        Pixel black = { 0, 0, 0 };
+        for (int x = 0; x < width; x++) {
+            out->data[x] = black;
+            out->data[x + (height - 1) * width] = black;
+        }
+        for (int y = 1; y < height - 1; y++) {
+            out->data[y * width] = black;
+            out->data[width - 1 + y * width] = black;
+        }
+    }
+    else {
+        freePPM(out);
+    }
+    free(gray);
+    free(gx);
+    free(gy);
+    return ret;
+}
+
+/**
+ * Ƭ׻ϣͼ.cͼߴͬ
+ */
+ErrorCode kernelBlend(const PPM* in1, const PPM* in2, PPM* out, int param) {
+    (void)param;
+    int outWidth = (in1->width > in2->width) ? in1->width : in2->width;
+    int outHeight = (in1->height > in2->height) ? in1->height : in2->height;
+    int maxVal = (in1->max_val > in2->max_val) ? in1->max_val : in2->max_val;
+    ErrorCode ret = allocLike(in1, out, outWidth, outHeight);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    out->max_val = maxVal;
+    for (int y = 0; y < outHeight; y++) {
+        for (int x = 0; x < outWidth; x++) {
+            int inImg1 = (x < in1->width && y < in1->height);
+            int inImg2 = (x < in2->width && y < in2->height);
+            Pixel* dst = &out->data[x + y * outWidth];
+            if (inImg1 && inImg2) {
+                const Pixel* p1 = &in1->data[x + y * in1->width];
+                const Pixel* p2 = &in2->data[x + y * in2->width];
+                dst->r = (p1->r * p2->r) / maxVal;
+                dst->g = (p1->g * p2->g) / maxVal;
+                dst->b = (p1->b * p2->b) / maxVal;
+            }
+            else if (inImg1) {
+                *dst = in1->data[x + y * in1->width];
+            }
+            else if (inImg2) {
+                *dst = in2->data[x + y * in2->width];
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ţͼü.c.h߸һ룬param Ϊ˲
+ */
+ErrorCode kernelResize(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    ErrorCode ret = allocLike(in, out, (in->width + 1) / 2, (in->height + 1) / 2);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    if (resizeImage((const int*)in->data, in->width, in->height, (int*)out->data, out->width, out->height,
+        3, in->max_val, (ResizeFilter)param, 2) != 0) {
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+/**
+ * С߸ 1/8ʽС˲
+ */
+ErrorCode kernelResizeEighth(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    ErrorCode ret = allocLike(in, out, (in->width + 7) / 8, (in->height + 7) / 8);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    if (resizeImage((const int*)in->data, in->width, in->height, (int*)out->data, out->width, out->height,
+        3, in->max_val, (ResizeFilter)param, 2) != 0) {
+        return ERR_MEMORY_ALLOC;
+    }
+    return SUCCESS;
+}
+
+/**
+ * ţãÿάÿȨأdouble롢
+ *  kernelResize Ľ 1룩
+ */
+ErrorCode kernelResizeNaive(const PPM* in, const PPM* unused, PPM* out, int param) {
+    (void)unused;
+    ResizeFilter filter = (ResizeFilter)param;
+    ErrorCode ret = allocLike(in, out, (in->width + 1) / 2, (in->height + 1) / 2);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    double sx = (double)in->width / out->width;
+    double sy = (double)in->height / out->height;
+    double fsx = sx > 1.0 ? sx : 1.0;
+    double fsy = sy > 1.0 ? sy : 1.0;
+    double support_x = resizeSupport(filter) * fsx;
+    double support_y = resizeSupport(filter) * fsy;
+    for (int y = 0; y < out->height; y++) {
+        for (int x = 0; x < out->width; x++) {
+            double cx = (x + 0.5) * sx;
+            double cy = (y + 0.5) * sy;
+            int x0 = (int)floor(cx - support_x + 0.5);
+            int x1 = (int)floor(cx + support_x + 0.5);
+            int y0 = (int)floor(cy - support_y + 0.5);
+            int y1 = (int)floor(cy + support_y + 0.5);
+            x0 = x0 > 0 ? x0 : 0;
+            y0 = y0 > 0 ? y0 : 0;
+            x1 = x1 < in->width ? x1 : in->width;
+            y1 = y1 < in->height ? y1 : in->height;
+            double r = 0.0, g = 0.0, b = 0.0, total = 0.0;
+            for (int yy = y0; yy < y1; yy++) {
+                for (int xx = x0; xx < x1; xx++) {
+                    double w = resizeWeight(filter, (xx + 0.5 - cx) / fsx) * resizeWeight(filter, (yy + 0.5 - cy) / fsy);
+                    const Pixel* p = &in->data[xx + yy * in->width];
+                    r += w * p->r;
+                    g += w * p->g;
+                    b += w * p->b;
+                    total += w;
+                }
+            }
+            int v[3] = { (int)floor(r / total + 0.5), (int)floor(g / total + 0.5), (int)floor(b / total + 0.5) };
+            for (int c = 0; c < 3; c++) {
+                v[c] = v[c] < 0 ? 0 : (v[c] > in->max_val ? in->max_val : v[c]);
+            }
+            out->data[x + y * out->width].r = v[0];
+            out->data[x + y * out->width].g = v[1];
+            out->data[x + y * out->width].b = v[2];
+        }
+    }
+    return SUCCESS;
+}
+
+//========== ʱͳ ==========
+
+/**
+ * ʱӣλ
+ */
+double nowNs() {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+/**
+ * ÿκʱ
+ * @param samplesÿκʱ룩
+ * @param pixelsÿδ ns/أ
+ * @param bytesÿζдֽ MB/s
+ */
+void summarize(BenchResult* res, const double* samples, int reps, double pixels, double bytes) {
+    if (reps <= 0) {
+        return;
+    }
+    double sum = 0.0;
+    double min = samples[0];
+    for (int i = 0; i < reps; i++) {
+        sum += samples[i];
+        if (samples[i] < min) {
+            min = samples[i];
+        }
+    }
+    double mean = sum / reps;
+    double var = 0.0;
+    for (int i = 0; i < reps; i++) {
+        var += (samples[i] - mean) * (samples[i] - mean);
+    }
+    var = (reps > 1) ? var / (reps - 1) : 0.0;
+
+    res->reps = reps;
+    res->mean_ns = mean;
+    res->stddev_ns = sqrt(var);
+    res->min_ns = min;
+    res->ns_per_pixel = mean / pixels;
+    res->mb_per_s = (bytes / (1024.0 * 1024.0)) / (mean / 1e9);
+}
+
+/**
+ * ɺϳɲͼƽӼͼκ֤SobelбԵ
+ * @param seedӣͬһɵͼȫͬ
+ */
+ErrorCode makeSynthetic(PPM* ppm, int width, int height, unsigned int seed) {
+    ppm->width = width;
+    ppm->height = height;
+    ppm->max_val = 255;
+    ppm->data = (Pixel*)malloc(sizeof(Pixel) * width * height);
+    if (ppm->data == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    unsigned int state = seed * 2654435761u + 1;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            state = state * 1103515245u + 12345u;
+            int noise = (int)((state >> 16) & 31) - 16;
+            int base_r = x * 255 / width;
+            int base_g = y * 255 / height;
+            int base_b = ((x / 32 + y / 32) & 1) ? 200 : 40;  // ̸ǿԵ
+            int r = base_r + noise;
+            int g = base_g + noise;
+            int b = base_b + noise;
+            Pixel* p = &ppm->data[x + y * width];
+            p->r = r < 0 ? 0 : (r > 255 ? 255 : r);
+            p->g = g < 0 ? 0 : (g > 255 ? 255 : g);
+            p->b = b < 0 ? 0 : (b > 255 ? 255 : b);
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ȡļСֽڣʧܷ0
+ */
+double fileSize(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        return 0.0;
+    }
+    fseek(file, 0, SEEK_END);
+    double size = (double)ftell(file);
+    fclose(file);
+    return size;
+}
+
+//==========  ==========
+
+typedef ErrorCode (*KernelFunc)(const PPM* in1, const PPM* in2, PPM* out, int param);
+
+typedef struct {
+    const char* name;
+    KernelFunc func;
+    int param;
+    int needs_second;  // ǷҪڶ루ϣ
+} KernelCase;
+
+const KernelCase KERNEL_CASES[] = {
+    { "gray",      kernelGray,      0,  0 },
+    { "invert",    kernelInvert,    0,  0 },
+    { "transpose", kernelTranspose, 0,  0 },
+    { "crop",      kernelCrop,      0,  0 },
+    { "blur_r1",   kernelBlur,      1,  0 },
+    { "blur_r3",   kernelBlur,      3,  0 },
+    { "blur_r5",   kernelBlur,      5,  0 },
+    { "sobel",     kernelSobel,     50, 0 },
+    { "blend",     kernelBlend,     0,  1 },
+    { "resize_naive_bicubic", kernelResizeNaive,  RESIZE_BICUBIC,  0 },
+    { "resize_bilinear",      kernelResize,       RESIZE_BILINEAR, 0 },
+    { "resize_bicubic",       kernelResize,       RESIZE_BICUBIC,  0 },
+    { "resize_lanczos",       kernelResize,       RESIZE_LANCZOS3, 0 },
+    { "resize_lanczos_8x",    kernelResizeEighth, RESIZE_LANCZOS3, 0 }
+};
+const int KERNEL_CASES_COUNT = sizeof(KERNEL_CASES) / sizeof(KERNEL_CASES[0]);
+
+/**
+ * ƹˣfilter Ϊջ name  filter ʱ
+ */
+int selected(const char* name, const char* filter) {
+    return filter == NULL || strstr(name, filter) != NULL;
+}
+
+/**
+ * ʱһں
+ * °ںʵʶд Pixel ֽ㣨 + ʱ룩
+ */
+ErrorCode benchKernel(const KernelCase* kc, const PPM* in1, const PPM* in2, int reps, BenchResult* res) {
+    double* samples = (double*)calloc(reps, sizeof(double));
+    if (samples == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    PPM out;
+    memset(&out, 0, sizeof(PPM));
+    double bytes = 0.0;
+    for (int i = 0; i < reps; i++) {
+        double t0 = nowNs();
+        ErrorCode ret = kc->func(in1, in2, &out, kc->param);
+        double t1 = nowNs();
+        if (ret != SUCCESS) {
+            free(samples);
+            freePPM(&out);
+            return ret;
+        }
+        samples[i] = t1 - t0;
+        bytes = (double)sizeof(Pixel) * ((double)in1->width * in1->height + (double)out.width * out.height);
+        if (kc->needs_second) {
+            bytes += (double)sizeof(Pixel) * in2->width * in2->height;
+        }
+        freePPM(&out);
+    }
+    strncpy(res->name, kc->name, sizeof(res->name) - 1);
+    res->name[sizeof(res->name) - 1] = '\0';
+    res->width = in1->width;
+    res->height = in1->height;
+    summarize(res, samples, reps, (double)in1->width * in1->height, bytes);
+    free(samples);
+    return SUCCESS;
+}
+
+/**
+ * ʱP3д°ļֽ
+ */
+ErrorCode benchIO(const PPM* img, const char* tmp_path, int reps, BenchResult* write_res, BenchResult* read_res) {
+    double* samples = (double*)calloc(reps, sizeof(double));
+    if (samples == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    double pixels = (double)img->width * img->height;
+
+    for (int i = 0; i < reps; i++) {
+        double t0 = nowNs();
+        ErrorCode ret = writePPM(tmp_path, img);
+        double t1 = nowNs();
+        if (ret != SUCCESS) {
+            free(samples);
+            return ret;
+        }
+        samples[i] = t1 - t0;
+    }
+    double bytes = fileSize(tmp_path);
+    strcpy(write_res->name, "p3_write");
+    write_res->width = img->width;
+    write_res->height = img->height;
+    summarize(write_res, samples, reps, pixels, bytes);
+
+    for (int i = 0; i < reps; i++) {
+        PPM parsed;
+        double t0 = nowNs();
+        ErrorCode ret = readPPM(tmp_path, &parsed);
+        double t1 = nowNs();
+        freePPM(&parsed);
+        if (ret != SUCCESS) {
+            free(samples);
+            return ret;
+        }
+        samples[i] = t1 - t0;
+    }
+    strcpy(read_res->name, "p3_parse");
+    read_res->width = img->width;
+    read_res->height = img->height;
+    summarize(read_res, samples, reps, pixels, bytes);
+
+    remove(tmp_path);
+    free(samples);
+    return SUCCESS;
+}
+
+//========== ߶Ա ==========
+
+void printHeader() {
+    printf("%-20s %11s %5s %12s %10s %10s %10s\n",
+        "", "ߴ", "", "ƽ(ms)", "׼%", "ns/", "MB/s");
+}
+
+void printResult(const BenchResult* res) {
+    char size[32];
+    sprintf(size, "%dx%d", res->width, res->height);
+    printf("%-20s %11s %5d %12.3f %10.2f %10.3f %10.1f\n",
+        res->name, size, res->reps, res->mean_ns / 1e6,
+        res->mean_ns > 0 ? res->stddev_ns * 100.0 / res->mean_ns : 0.0,
+        res->ns_per_pixel, res->mb_per_s);
+}
+
+/**
+ * дJSONÿ¼ռһУ --baseline 
+ */
+ErrorCode writeJSON(const char* filename, const BenchResult* results, int count) {
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* res = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"reps\": %d, "
+            "\"mean_ns\": %.1f, \"stddev_ns\": %.1f, \"min_ns\": %.1f, "
+            "\"ns_per_pixel\": %.4f, \"mb_per_s\": %.2f}%s\n",
+            res->name, res->width, res->height, res->reps,
+            res->mean_ns, res->stddev_ns, res->min_ns,
+            res->ns_per_pixel, res->mb_per_s, (i + 1 < count) ? "," : "");
+    }
+    int failed = fprintf(file, "  ]\n}\n") < 0;
+    fclose(file);
+    return failed ? ERR_WRITE_FAILED : SUCCESS;
+}
+
+/**
+ * ȡJSONwriteJSON ʽ
+ * @param out飨÷ free
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readBaseline(const char* filename, BenchResult** out, int* count) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    int capacity = 64;
+    *count = 0;
+    *out = (BenchResult*)malloc(sizeof(BenchResult) * capacity);
+    if (*out == NULL) {
+        fclose(file);
+        return ERR_MEMORY_ALLOC;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        BenchResult res;
+        memset(&res, 0, sizeof(BenchResult));
+        const char* start = strstr(line, "{\"name\"");
+        if (start == NULL) {
+            continue;
+        }
+        if (sscanf(start, "{\"name\": \"%31[^\"]\", \"width\": %d, \"height\": %d, \"reps\": %d, "
+            "\"mean_ns\": %lf, \"stddev_ns\": %lf, \"min_ns\": %lf, "
+            "\"ns_per_pixel\": %lf, \"mb_per_s\": %lf",
+            res.name, &res.width, &res.height, &res.reps,
+            &res.mean_ns, &res.stddev_ns, &res.min_ns,
+            &res.ns_per_pixel, &res.mb_per_s) != 9) {
+            free(*out);
+            *out = NULL;
+            fclose(file);
+            return ERR_FILE_BROKEN;
+        }
+        if (*count == capacity) {
+            capacity *= 2;
+            BenchResult* grown = (BenchResult*)realloc(*out, sizeof(BenchResult) * capacity);
+            if (grown == NULL) {
+                free(*out);
+                *out = NULL;
+                fclose(file);
+                return ERR_MEMORY_ALLOC;
+            }
+            *out = grown;
+        }
+        (*out)[(*count)++] = res;
+    }
+    fclose(file);
+    return SUCCESS;
+}
+
+/**
+ * Ա ns/
+ *  thresholdٷֱȣҳ߱׼ʱΪ˻
+ * @return ˻
+ */
+int compareBaseline(const BenchResult* results, int count, const BenchResult* base, int base_count, double threshold) {
+    int regressions = 0;
+    printf("\n߶Աȣֵ %.1f%%\n", threshold);
+    printf("%-20s %11s %12s %12s %9s\n", "", "ߴ", "ns/", "ǰns/", "仯%");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* cur = &results[i];
+        const BenchResult* old = NULL;
+        for (int j = 0; j < base_count; j++) {
+            if (strcmp(base[j].name, cur->name) == 0 &&
+                base[j].width == cur->width && base[j].height == cur->height) {
+                old = &base[j];
+                break;
+            }
+        }
+        if (old == NULL || old->ns_per_pixel <= 0.0) {
+            continue;
+        }
+        char size[32];
+        sprintf(size, "%dx%d", cur->width, cur->height);
+        double delta = (cur->ns_per_pixel - old->ns_per_pixel) * 100.0 / old->ns_per_pixel;
+        double noise = 2.0 * old->stddev_ns;
+        int slower = delta > threshold && (cur->mean_ns - old->mean_ns) > noise;
+        printf("%-20s %11s %12.3f %12.3f %+8.1f%s\n", cur->name, size,
+            old->ns_per_pixel, cur->ns_per_pixel, delta, slower ? "  <-- ˻" : "");
+        regressions += slower;
+    }
+    return regressions;
+}
+
+/**
+ *  --sizes "all" 򶺺ŷָı߳ 256,1024߳ 8k ʾ 7680x4320
+ */
+int parseSizes(const char* arg, BenchSize* sizes, int max_count) {
+    if (strcmp(arg, "all") == 0) {
+        for (int i = 0; i < ALL_SIZES_COUNT && i < max_count; i++) {
+            sizes[i] = ALL_SIZES[i];
+        }
+        return ALL_SIZES_COUNT < max_count ? ALL_SIZES_COUNT : max_count;
+    }
+    int count = 0;
+    const char* p = arg;
+    while (*p != '\0' && count < max_count) {
+        if (strncmp(p, "8k", 2) == 0 || strncmp(p, "8K", 2) == 0) {
+            sizes[count].width = 7680;
+            sizes[count].height = 4320;
+            p += 2;
+        }
+        else {
+            char* end;
+            long n = strtol(p, &end, 10);
+            if (end == p || n < 3 || n > 65536) {
+                return -1;
+            }
+            sizes[count].width = (int)n;
+            sizes[count].height = (int)n;
+            p = end;
+        }
+        count++;
+        if (*p == ',') {
+            p++;
+        }
+        else if (*p != '\0') {
+            return -1;
+        }
+    }
+    return count;
+}
+
+void printUsage(const char* prog) {
+    printf("÷%s [ѡ]\n", prog);
+    printf("  --sizes LIST      Գߴ磬ŷָı߳ 8kall ʾ 256~8K ȫĬ 256,512,1024,2048\n");
+    printf("  --reps N          ÿظĬ 5\n");
+    printf("  --filter NAME     ֻư NAME  blurp3\n");
+    printf("  --json FILE       дJSONļ\n");
+    printf("  --baseline FILE   ֮ǰJSON߶Ա\n");
+    printf("  --threshold PCT   ˻жֵٷֱȣĬ 10\n");
+    printf("  --tmp FILE        P3дʹõʱļĬ bench_tmp.ppm\n");
+}
+
+/**
+ * ɺϳͼʱ
+ */
+int main(int argc, char* argv[]) {
+    // 1. Ĭϲ
+    BenchSize sizes[16];
+    int size_count = DEFAULT_SIZES_COUNT;
+    for (int i = 0; i < size_count; i++) {
+        sizes[i] = ALL_SIZES[i];
+    }
+    int reps = 5;
+    const char* filter = NULL;
+    const char* json_path = NULL;
+    const char* baseline_path = NULL;
+    const char* tmp_path = "bench_tmp.ppm";
+    double threshold = 10.0;
+
+    // 2. 
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--sizes") == 0 && has_value) {
+            size_count = parseSizes(argv[++i], sizes, 16);
+        }
+        else if (strcmp(argv[i], "--reps") == 0 && has_value) {
+            reps = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && has_value) {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && has_value) {
+            json_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && has_value) {
+            baseline_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && has_value) {
+            threshold = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tmp") == 0 && has_value) {
+            tmp_path = argv[++i];
+        }
+        else {
+            printUsage(argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+    }
+    if (size_count <= 0 || reps <= 0) {
+        printf("%s\n", error_messages[ERR_BAD_ARGUMENT]);
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+
+    // 3. ߴʱ
+    int capacity = size_count * (KERNEL_CASES_COUNT + 2);
+    BenchResult* results = (BenchResult*)malloc(sizeof(BenchResult) * capacity);
+    if (results == NULL) {
+        printf("%s\n", error_messages[ERR_MEMORY_ALLOC]);
+        return ERR_MEMORY_ALLOC;
+    }
+    int count = 0;
+    printHeader();
+    for (int s = 0; s < size_count; s++) {
+        PPM img1, img2;
+        memset(&img1, 0, sizeof(PPM));
+        memset(&img2, 0, sizeof(PPM));
+        ErrorCode ret = makeSynthetic(&img1, sizes[s].width, sizes[s].height, 1);
+        if (ret == SUCCESS) {
+            ret = makeSynthetic(&img2, sizes[s].width, sizes[s].height, 2);
+        }
+        if (ret != SUCCESS) {
+            printf("%s\n", error_messages[ret]);
+            freePPM(&img1);
+            freePPM(&img2);
+            free(results);
+            return ret;
+        }
+
+        if (selected("p3_write", filter) || selected("p3_parse", filter)) {
+            BenchResult write_res, read_res;
+            ret = benchIO(&img1, tmp_path, reps, &write_res, &read_res);
+            if (ret != SUCCESS) {
+                printf("%s\n", error_messages[ret]);
+                freePPM(&img1);
+                freePPM(&img2);
+                free(results);
+                return ret;
+            }
+            if (selected("p3_write", filter)) {
+                results[count++] = write_res;
+                printResult(&write_res);
+            }
+            if (selected("p3_parse", filter)) {
+                results[count++] = read_res;
+                printResult(&read_res);
+            }
+        }
+
+        for (int k = 0; k < KERNEL_CASES_COUNT; k++) {
+            if (!selected(KERNEL_CASES[k].name, filter)) {
+                continue;
+            }
+            ret = benchKernel(&KERNEL_CASES[k], &img1, &img2, reps, &results[count]);
+            if (ret != SUCCESS) {
+                printf("%s: %s\n", KERNEL_CASES[k].name, error_messages[ret]);
+                freePPM(&img1);
+                freePPM(&img2);
+                free(results);
+                return ret;
+            }
+            printResult(&results[count]);
+            count++;
+        }
+        freePPM(&img1);
+        freePPM(&img2);
+    }
+
+    // 4. 
+    if (json_path != NULL) {
+        ErrorCode ret = writeJSON(json_path, results, count);
+        if (ret != SUCCESS) {
+            printf("%s\n", error_messages[ret]);
+            free(results);
+            return ret;
+        }
+        printf("ѱ棺%s\n", json_path);
+    }
+
+    // 5. ߶Ա
+    int exit_code = SUCCESS;
+    if (baseline_path != NULL) {
+        BenchResult* base = NULL;
+        int base_count = 0;
+        ErrorCode ret = readBaseline(baseline_path, &base, &base_count);
+        if (ret != SUCCESS) {
+            printf("%s\n", error_messages[ret]);
+            free(results);
+            return ret;
+        }
+        int regressions = compareBaseline(results, count, base, base_count, threshold);
+        if (regressions > 0) {
+            printf("%s%d \n", error_messages[ERR_REGRESSION], regressions);
+            exit_code = ERR_REGRESSION;
+        }
+        free(base);
+    }
+
+    free(results);
+    return exit_code;
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+/**
+ * ͳƣȡ//д׶μں˵ĺʱ
+ *
+ * ڿ PPM_STATSĬ 0
+ *   رʱ STATS_* չΪ䣬κο
+ *   ʱ /DPPM_STATS=1MSVC -DPPM_STATS=1gccá
+ * ú֧в STATS_INIT ȡߣӰԼĲ
+ *   --stats          ʱӡ׶λ
+ *   --trace FILE     д Chrome trace JSONchrome://tracing  Perfetto 򿪣
+ *
+ * ÷
+ *   STATS_BEGIN(span, "read");            // һ׶
+ *   ... STATS_BYTES_READ(n); STATS_ALLOC(n); ...
+ *   STATS_END(span, width * height);      // رս׶β¼
+ * ֽǵǰڲ򿪵Ľ׶ϣڴ水 STATS_ALLOC / STATS_FREE ǵǰֵֵ
+ * ߳ʣ׶οʼʱȡһ OpenMP ̳߳ÿ̵߳ CPU ʱ䣬ֵ֮Ϊæµʱ䣬
+ *  = æµʱ / (ǽӺʱ * omp_get_max_threads())дȴʱæµʱ䣬
+ * ߳ڲȴʱ롣׶ڲ򿪺͹رգ߶ˣ
+ */
+#ifndef PPM_STATS_H
+#define PPM_STATS_H
+
+#ifndef PPM_STATS
+#define PPM_STATS 0
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#if PPM_STATS
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define STATS_MAX_SPANS 256    // ¼Ľ׶ټ¼
+#define STATS_MAX_DEPTH 16     // Ƕײ
+#define STATS_MAX_THREADS 256  // ͳ CPU ʱ߳
+
+// ׶εļ¼
+typedef struct {
+    const char* name;
+    int depth;          // Ƕײ0=㣩
+    double start_ns;    // ԳĿʼʱ
+    double dur_ns;      // ǽӺʱ
+    double pixels;      // 
+    double bytes_in;    // ȡֽ
+    double bytes_out;   // дֽ
+    int threads;        // ߳omp_get_max_threads
+    double busy_ns;     // ߳ CPU ʱ֮
+} StatsSpan;
+
+static struct {
+    int print_summary;
+    const char* trace_path;
+    double origin_ns;
+    StatsSpan spans[STATS_MAX_SPANS];
+    int span_count;
+    int stack[STATS_MAX_DEPTH];
+    int depth;
+    double cpu_start[STATS_MAX_DEPTH];  // ׶οʼʱ̵߳ CPU ʱ֮
+    double alloc_current;
+    double alloc_peak;
+} g_stats;
+
+/**
+ * ʱӣλ
+ */
+static inline double statsNowNs(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+/**
+ * ǰ̵߳ CPU ʱ䣬λ
+ */
+static inline double statsThreadCpuNs(void) {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) {
+        return 0.0;
+    }
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return ((double)k.QuadPart + (double)u.QuadPart) * 100.0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+/**
+ * ̳߳ÿ̵߳ CPU ʱ֮ͣһںͬСĲ̸߳ȡԼģ
+ * @param threads߳
+ */
+static inline double statsPoolCpuNs(int* threads) {
+    *threads = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel()) {
+        double cpu[STATS_MAX_THREADS];
+        int n = omp_get_max_threads();
+        n = n < STATS_MAX_THREADS ? n : STATS_MAX_THREADS;
+        memset(cpu, 0, sizeof(cpu));
+        #pragma omp parallel num_threads(n)
+        {
+            int t = omp_get_thread_num();
+            if (t < STATS_MAX_THREADS) {
+                cpu[t] = statsThreadCpuNs();
+            }
+        }
+        double sum = 0.0;
+        for (int t = 0; t < n; t++) {
+            sum += cpu[t];
+        }
+        *threads = n;
+        return sum;
+    }
+#endif
+    return statsThreadCpuNs();
+}
+
+/**
+ * ȡ --stats / --trace FILE ʼʱ
+ */
+static inline void statsInit(int* argc, char* argv[]) {
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.origin_ns = statsNowNs();
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            g_stats.print_summary = 1;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < *argc) {
+            g_stats.trace_path = argv[++i];
+        }
+        else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+}
+
+/**
+ * һ׶
+ * @return ׶αţʱ -1֮ĵû
+ */
+static inline int statsBegin(const char* name) {
+    if (g_stats.span_count >= STATS_MAX_SPANS || g_stats.depth >= STATS_MAX_DEPTH) {
+        return -1;
+    }
+    int id = g_stats.span_count++;
+    StatsSpan* span = &g_stats.spans[id];
+    memset(span, 0, sizeof(StatsSpan));
+    span->name = name;
+    span->depth = g_stats.depth;
+    g_stats.cpu_start[g_stats.depth] = statsPoolCpuNs(&span->threads);
+    g_stats.stack[g_stats.depth++] = id;
+    span->start_ns = statsNowNs() - g_stats.origin_ns;
+    return id;
+}
+
+/**
+ * رһ׶
+ * @param pixelsý׶δ
+ */
+static inline void statsEnd(int id, double pixels) {
+    if (id < 0) {
+        return;
+    }
+    StatsSpan* span = &g_stats.spans[id];
+    span->dur_ns = statsNowNs() - g_stats.origin_ns - span->start_ns;
+    span->pixels = pixels;
+    if (g_stats.depth > 0 && g_stats.stack[g_stats.depth - 1] == id) {
+        g_stats.depth--;
+        int threads;
+        double busy = statsPoolCpuNs(&threads) - g_stats.cpu_start[g_stats.depth];
+        span->busy_ns = busy > 0.0 ? busy : 0.0;
+    }
+}
+
+/**
+ * дֽǵǰڲ׶
+ */
+static inline void statsAddBytes(double bytes_in, double bytes_out) {
+    if (g_stats.depth == 0) {
+        return;
+    }
+    StatsSpan* span = &g_stats.spans[g_stats.stack[g_stats.depth - 1]];
+    span->bytes_in += bytes_in;
+    span->bytes_out += bytes_out;
+}
+
+/**
+ * ¼ڴ䣨ʾͷţ
+ */
+static inline void statsAlloc(double bytes) {
+    g_stats.alloc_current += bytes;
+    if (g_stats.alloc_current > g_stats.alloc_peak) {
+        g_stats.alloc_peak = g_stats.alloc_current;
+    }
+}
+
+/**
+ * ӡ׶λ
+ */
+static inline void statsPrintSummary(FILE* out) {
+    double total_ns = statsNowNs() - g_stats.origin_ns;
+    fprintf(out, "\n===== ͳ =====\n");
+    fprintf(out, "%-20s %10s %12s %10s %10s %10s %8s %8s\n",
+        "׶", "ʱ(ms)", "", "ns/", "(MB)", "д(MB)", "߳", "");
+    for (int i = 0; i < g_stats.span_count; i++) {
+        const StatsSpan* span = &g_stats.spans[i];
+        char name[64];
+        snprintf(name, sizeof(name), "%*s%s", span->depth * 2, "", span->name);
+        double util = (span->dur_ns > 0.0) ? span->busy_ns / (span->dur_ns * span->threads) : 0.0;
+        util = util < 1.0 ? util : 1.0;  // CPU ʱ䰴ʱӽļƣ̽׶οԳǽ
+        fprintf(out, "%-20s %10.3f %12.0f %10.2f %10.2f %10.2f %8d %7.1f%%\n",
+            name, span->dur_ns / 1e6, span->pixels,
+            span->pixels > 0.0 ? span->dur_ns / span->pixels : 0.0,
+            span->bytes_in / (1024.0 * 1024.0), span->bytes_out / (1024.0 * 1024.0),
+            span->threads, util * 100.0);
+    }
+    fprintf(out, "ܺʱ%.3f msڴֵ%.2f MB\n",
+        total_ns / 1e6, g_stats.alloc_peak / (1024.0 * 1024.0));
+}
+
+/**
+ * д Chrome trace JSON¼ ph=Xʱ䵥λΪ΢룩
+ * @return 0=ɹ
+ */
+static inline int statsWriteTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return -1;
+    }
+    fprintf(file, "{\"traceEvents\": [\n");
+    for (int i = 0; i < g_stats.span_count; i++) {
+        const StatsSpan* span = &g_stats.spans[i];
+        fprintf(file, "  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+            "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"pixels\": %.0f, "
+            "\"bytes_in\": %.0f, \"bytes_out\": %.0f, \"threads\": %d, \"busy_us\": %.3f}},\n",
+            span->name, span->start_ns / 1e3, span->dur_ns / 1e3, span->pixels,
+            span->bytes_in, span->bytes_out, span->threads, span->busy_ns / 1e3);
+    }
+    fprintf(file, "  {\"name\": \"alloc_peak\", \"ph\": \"C\", \"pid\": 1, \"tid\": 1, "
+        "\"ts\": %.3f, \"args\": {\"bytes\": %.0f}}\n",
+        (statsNowNs() - g_stats.origin_ns) / 1e3, g_stats.alloc_peak);
+    int failed = fprintf(file, "]}\n") < 0;
+    fclose(file);
+    return failed ? -1 : 0;
+}
+
+/**
+ * Ҫ trace
+ */
+static inline void statsFinish(void) {
+    if (g_stats.print_summary) {
+        statsPrintSummary(stdout);
+    }
+    if (g_stats.trace_path != NULL && statsWriteTrace(g_stats.trace_path) != 0) {
+        fprintf(stderr, "棺trace ļдʧܣ%s\n", g_stats.trace_path);
+    }
+}
+
+#define STATS_INIT(argc, argv)          statsInit(&(argc), (argv))
+#define STATS_FINISH()                  statsFinish()
+#define STATS_BEGIN(span, name)         int span = statsBegin(name)
+#define STATS_END(span, pixels)         statsEnd((span), (double)(pixels))
+#define STATS_BYTES_READ(n)             statsAddBytes((double)(n), 0.0)
+#define STATS_BYTES_WRITTEN(n)          statsAddBytes(0.0, (double)(n))
+#define STATS_ALLOC(n)                  statsAlloc((double)(n))
+#define STATS_FREE(n)                   statsAlloc(-(double)(n))
+
+#else
+
+/**
+ * δͳʱȡ --stats / --trace ʾҪ±
+ */
+static inline void statsInitDisabled(int* argc, char* argv[]) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--trace") == 0) {
+            fprintf(stderr, "ʾ%s Ҫ PPM_STATS=1 룬κ\n", argv[i]);
+            if (strcmp(argv[i], "--trace") == 0 && i + 1 < *argc) {
+                i++;
+            }
+        }
+        else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+}
+
+#define STATS_INIT(argc, argv)          statsInitDisabled(&(argc), (argv))
+#define STATS_FINISH()                  ((void)0)
+#define STATS_BEGIN(span, name)         ((void)0)
+#define STATS_END(span, pixels)         ((void)0)
+#define STATS_BYTES_READ(n)             ((void)0)
+#define STATS_BYTES_WRITTEN(n)          ((void)0)
+#define STATS_ALLOC(n)                  ((void)0)
+#define STATS_FREE(n)                   ((void)0)
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,522 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ɫת.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <time.h>
+#endif
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_CROP_OUT_OF_BOUNDS,
+    ERR_BAD_ARGUMENT
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PPM P3/P6ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "󣺲ü򳬳ͼ߽",
+    "вϷ"
+};
+
+// ĸʽϢ
+typedef struct {
+    int width;
+    int height;
+    int max_val;
+    int binary;  // 1=P60=P3
+} StreamHeader;
+
+//========== ʱ ==========
+
+double nowMs(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e3 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+#endif
+}
+
+double g_start_ms;
+double g_first_row_ms = -1.0;  // һдʱ
+
+//========== 룺 stdinн ==========
+
+static unsigned char g_in_buf[1 << 16];
+static size_t g_in_pos = 0;
+static size_t g_in_len = 0;
+
+int inByte(void) {
+    if (g_in_pos == g_in_len) {
+        g_in_len = fread(g_in_buf, 1, sizeof(g_in_buf), stdin);
+        g_in_pos = 0;
+        if (g_in_len == 0) {
+            return EOF;
+        }
+    }
+    return g_in_buf[g_in_pos++];
+}
+
+/**
+ * ȡһǸհ # עͣԵһָ
+ * @return 0=ɹ-1=ʧ
+ */
+int inNumber(int* value) {
+    int ch = inByte();
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = inByte();
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = inByte();
+    }
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    int v = 0;
+    while (ch >= '0' && ch <= '9') {
+        if (v > 100000000) {
+            return -1;
+        }
+        v = v * 10 + (ch - '0');
+        ch = inByte();
+    }
+    *value = v;
+    return 0;
+}
+
+/**
+ * ͷP6 ͷһֺĵհѱ inNumber Ե
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readHeader(StreamHeader* header) {
+    if (inByte() != 'P') {
+        return ERR_WRONG_FORMAT;
+    }
+    int kind = inByte();
+    if (kind != '3' && kind != '6') {
+        return ERR_WRONG_FORMAT;
+    }
+    header->binary = kind == '6';
+    if (inNumber(&header->width) != 0 || inNumber(&header->height) != 0 || inNumber(&header->max_val) != 0) {
+        return ERR_FILE_BROKEN;
+    }
+    if (header->width <= 0 || header->height <= 0 || header->max_val <= 0 || header->max_val > 65535) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * һأÿ r,g,b  int
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readRow(const StreamHeader* header, int* row) {
+    int n = header->width * 3;
+    if (header->binary) {
+        int wide = header->max_val > 255;  // 16 λ
+        for (int i = 0; i < n; i++) {
+            int hi = inByte();
+            if (hi == EOF) {
+                return ERR_FILE_BROKEN;
+            }
+            if (wide) {
+                int lo = inByte();
+                if (lo == EOF) {
+                    return ERR_FILE_BROKEN;
+                }
+                hi = (hi << 8) | lo;
+            }
+            row[i] = hi;
+        }
+    }
+    else {
+        for (int i = 0; i < n; i++) {
+            if (inNumber(&row[i]) != 0) {
+                return ERR_FILE_BROKEN;
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (row[i] > header->max_val) {
+            return ERR_FILE_BROKEN;
+        }
+    }
+    return SUCCESS;
+}
+
+//========== иʽдˢ ==========
+
+static char* g_out_line = NULL;  // һеĸʽ
+int g_out_format = -1;           // ʽ-1=ͬ0=P31=P6
+
+ErrorCode writeHeader(const StreamHeader* header) {
+    int binary = g_out_format >= 0 ? g_out_format : header->binary;
+    if (printf("%s\n%d %d\n%d\n", binary ? "P6" : "P3", header->width, header->height, header->max_val) < 0) {
+        return ERR_WRITE_FAILED;
+    }
+    // һÿ 5 λ + ոӻ
+    g_out_line = (char*)malloc((size_t)header->width * 3 * 6 + 2);
+    return g_out_line == NULL ? ERR_MEMORY_ALLOC : SUCCESS;
+}
+
+ErrorCode writeRow(const StreamHeader* header, const int* row) {
+    int n = header->width * 3;
+    size_t len = 0;
+    if (g_out_format >= 0 ? g_out_format : header->binary) {
+        for (int i = 0; i < n; i++) {
+            if (header->max_val > 255) {
+                g_out_line[len++] = (char)(row[i] >> 8);
+            }
+            g_out_line[len++] = (char)row[i];
+        }
+    }
+    else {
+        //  writePPM ͬŲ"r g b " Уÿĩβ
+        for (int i = 0; i < n; i++) {
+            char digits[8];
+            int v = row[i], k = 0;
+            do {
+                digits[k++] = (char)('0' + v % 10);
+                v /= 10;
+            } while (v > 0);
+            while (k > 0) {
+                g_out_line[len++] = digits[--k];
+            }
+            g_out_line[len++] = ' ';
+        }
+        g_out_line[len++] = '\n';
+    }
+    if (fwrite(g_out_line, 1, len, stdout) != len || fflush(stdout) != 0) {
+        return ERR_WRITE_FAILED;
+    }
+    if (g_first_row_ms < 0.0) {
+        g_first_row_ms = nowMs();
+    }
+    return SUCCESS;
+}
+
+//========== в ==========
+
+/**
+ *  / ҶȻһһУ뼴д
+ */
+ErrorCode streamPointOp(StreamHeader* header, int gray) {
+    int* row = (int*)malloc(sizeof(int) * header->width * 3);
+    if (row == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = writeHeader(header);
+    for (int y = 0; y < header->height && ret == SUCCESS; y++) {
+        ret = readRow(header, row);
+        if (ret != SUCCESS) {
+            break;
+        }
+        for (int x = 0; x < header->width; x++) {
+            int* p = row + x * 3;
+            if (gray) {
+                p[0] = p[1] = p[2] = (p[0] + p[1] + p[2]) / 3;
+            }
+            else {
+                p[0] = header->max_val - p[0];
+                p[1] = header->max_val - p[1];
+                p[2] = header->max_val - p[2];
+            }
+        }
+        ret = writeRow(header, row);
+    }
+    free(row);
+    return ret;
+}
+
+/**
+ * ü֮ǰֻһкٶʣ
+ */
+ErrorCode streamCrop(StreamHeader* header, int x0, int y0, int w, int h) {
+    if (x0 < 0 || y0 < 0 || w <= 0 || h <= 0 || x0 + w > header->width || y0 + h > header->height) {
+        return ERR_CROP_OUT_OF_BOUNDS;
+    }
+    StreamHeader out = *header;
+    out.width = w;
+    out.height = h;
+    int* row = (int*)malloc(sizeof(int) * header->width * 3);
+    if (row == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = writeHeader(&out);
+    for (int y = 0; y < y0 + h && ret == SUCCESS; y++) {
+        ret = readRow(header, row);
+        if (ret == SUCCESS && y >= y0) {
+            ret = writeRow(&out, row + x0 * 3);
+        }
+    }
+    free(row);
+    return ret;
+}
+
+/**
+ * Sobel 3 лҶȵĻδڣ y+1 к󼴿 y 
+ * ͬ sobelԵ.c BT.601 Ҷȣɫת.húڣֵ 255
+ */
+ErrorCode streamSobel(StreamHeader* header, int threshold) {
+    if (header->max_val > 255 || header->width < 3 || header->height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    int width = header->width;
+    StreamHeader out = *header;
+    out.max_val = 255;
+    int* row = (int*)malloc(sizeof(int) * width * 3);
+    unsigned char* gray = (unsigned char*)malloc((size_t)width * 3);
+    if (row == NULL || gray == NULL) {
+        free(row);
+        free(gray);
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = writeHeader(&out);
+    long t2 = (long)threshold * threshold;
+    for (int y = 0; y < header->height && ret == SUCCESS; y++) {
+        ret = readRow(header, row);
+        if (ret != SUCCESS) {
+            break;
+        }
+        unsigned char* g = gray + (size_t)(y % 3) * width;
+        colorToGray(row, g, width, LUMA_BT601);
+        if (y == 0) {
+            memset(row, 0, sizeof(int) * width * 3);
+            ret = writeRow(&out, row);  //  0 Ǳ߿
+            continue;
+        }
+        if (y < 2) {
+            continue;
+        }
+        //  y-1 
+        const unsigned char* u = gray + (size_t)((y - 2) % 3) * width;
+        const unsigned char* m = gray + (size_t)((y - 1) % 3) * width;
+        const unsigned char* d = g;
+        row[0] = row[1] = row[2] = 0;
+        for (int x = 1; x < width - 1; x++) {
+            int gx = (u[x + 1] - u[x - 1]) + 2 * (m[x + 1] - m[x - 1]) + (d[x + 1] - d[x - 1]);
+            int gy = (d[x - 1] + 2 * d[x] + d[x + 1]) - (u[x - 1] + 2 * u[x] + u[x + 1]);
+            int edge = ((long)gx * gx + (long)gy * gy >= t2) ? 255 : 0;
+            row[x * 3] = row[x * 3 + 1] = row[x * 3 + 2] = edge;
+        }
+        row[(width - 1) * 3] = row[(width - 1) * 3 + 1] = row[(width - 1) * 3 + 2] = 0;
+        ret = writeRow(&out, row);
+    }
+    if (ret == SUCCESS) {
+        memset(row, 0, sizeof(int) * width * 3);
+        ret = writeRow(&out, row);  // һǱ߿
+    }
+    free(row);
+    free(gray);
+    return ret;
+}
+
+double weight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+/**
+ * ˹ģ 2R+1 еĻδڣ y+R к󼴿 y 
+ * ͬ ˹ģ.csigma=5Խذɫƣ㰴 int ضۼӣԭ
+ */
+ErrorCode streamBlur(StreamHeader* header, int radius, int x1, int y1, int x2, int y2) {
+    int width = header->width;
+    int height = header->height;
+    int side = 2 * radius + 1;
+    int* window = (int*)malloc(sizeof(int) * width * 3 * side);
+    int* out_row = (int*)malloc(sizeof(int) * width * 3);
+    double* table = (double*)malloc(sizeof(double) * side * side);
+    if (window == NULL || out_row == NULL || table == NULL) {
+        free(window);
+        free(out_row);
+        free(table);
+        return ERR_MEMORY_ALLOC;
+    }
+    double sum_weight = 0.0;
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dy = -radius; dy <= radius; dy++) {
+            table[(dx + radius) * side + (dy + radius)] = weight(5.0, dx, dy, &sum_weight);
+        }
+    }
+
+    ErrorCode ret = writeHeader(header);
+    int read_rows = 0;
+    for (int y = 0; y < height && ret == SUCCESS; y++) {
+        // 봰ڣҪ y+R УһУ
+        while (read_rows <= y + radius && read_rows < height && ret == SUCCESS) {
+            ret = readRow(header, window + (size_t)(read_rows % side) * width * 3);
+            read_rows++;
+        }
+        if (ret != SUCCESS) {
+            break;
+        }
+        const int* center = window + (size_t)(y % side) * width * 3;
+        for (int x = 0; x < width; x++) {
+            int* d = out_row + x * 3;
+            if (!(x1 <= x && x <= x2 && y1 <= y && y <= y2)) {
+                d[0] = center[x * 3];
+                d[1] = center[x * 3 + 1];
+                d[2] = center[x * 3 + 2];
+                continue;
+            }
+            int r = 0, g = 0, b = 0;
+            const double* wt = table;
+            for (int i = x - radius; i <= x + radius; i++) {
+                for (int j = y - radius; j <= y + radius; j++, wt++) {
+                    if (i < 0 || j < 0 || i >= width || j >= height) {
+                        continue;  // BLACK
+                    }
+                    const int* s = window + ((size_t)(j % side) * width + i) * 3;
+                    r += *wt * s[0];
+                    g += *wt * s[1];
+                    b += *wt * s[2];
+                }
+            }
+            d[0] = (int)(r / sum_weight);
+            d[1] = (int)(g / sum_weight);
+            d[2] = (int)(b / sum_weight);
+        }
+        ret = writeRow(header, out_row);
+    }
+    free(window);
+    free(out_row);
+    free(table);
+    return ret;
+}
+
+//==========  ==========
+
+void printUsage(const char* prog) {
+    fprintf(stderr, "÷%s <> [] [--p3|--p6] [--report] < .ppm > .ppm\n", prog);
+    fprintf(stderr, "  invert                     \n");
+    fprintf(stderr, "  gray                       ҶȻRGB ƽ\n");
+    fprintf(stderr, "  crop X Y W H               ü\n");
+    fprintf(stderr, "  sobel T                    SobelԵ⣬ֵ T\n");
+    fprintf(stderr, "  blur R [X1 Y1 X2 Y2]       ˹ģֻģ\n");
+    fprintf(stderr, "ʽĬͬ--report  stderr ӡӳܺʱ\n");
+}
+
+/**
+ * stdin  -> д -> ÿод stdout
+ * ڴֻռڵļУԷŽܵ
+ *   cat man.ppm | ʽ crop 50 50 500 750 | ʽ sobel 50 > edge.ppm
+ */
+int main(int argc, char* argv[]) {
+    g_start_ms = nowMs();
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    // 1. 
+    int force_format = -1;
+    int report = 0;
+    int params[5] = { 0, 0, 0, 0, 0 };
+    int param_count = 0;
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    const char* op = argv[1];
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--p3") == 0) {
+            force_format = 0;
+        }
+        else if (strcmp(argv[i], "--p6") == 0) {
+            force_format = 1;
+        }
+        else if (strcmp(argv[i], "--report") == 0) {
+            report = 1;
+        }
+        else if (param_count < 5) {
+            params[param_count++] = atoi(argv[i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+    }
+    int valid = (strcmp(op, "invert") == 0 && param_count == 0) ||
+        (strcmp(op, "gray") == 0 && param_count == 0) ||
+        (strcmp(op, "crop") == 0 && param_count == 4) ||
+        (strcmp(op, "sobel") == 0 && param_count == 1 && params[0] >= 0 && params[0] <= 255) ||
+        (strcmp(op, "blur") == 0 && (param_count == 1 || param_count == 5) && params[0] >= 0 && params[0] <= 64);
+    if (!valid) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+
+    // 2. ͷ
+    StreamHeader header;
+    ErrorCode ret = readHeader(&header);
+    g_out_format = force_format;
+
+    // 3. д
+    if (ret == SUCCESS) {
+        if (strcmp(op, "invert") == 0) {
+            ret = streamPointOp(&header, 0);
+        }
+        else if (strcmp(op, "gray") == 0) {
+            ret = streamPointOp(&header, 1);
+        }
+        else if (strcmp(op, "crop") == 0) {
+            ret = streamCrop(&header, params[0], params[1], params[2], params[3]);
+        }
+        else if (strcmp(op, "sobel") == 0) {
+            ret = streamSobel(&header, params[0]);
+        }
+        else if (param_count == 5) {
+            ret = streamBlur(&header, params[0], params[1], params[2], params[3], params[4]);
+        }
+        else {
+            ret = streamBlur(&header, params[0], 0, 0, header.width - 1, header.height - 1);
+        }
+    }
+    free(g_out_line);
+
+    if (ret != SUCCESS) {
+        fprintf(stderr, "%s\n", error_messages[ret]);
+        return ret;
+    }
+    if (report) {
+        fprintf(stderr, "ӳ %.2f msܺʱ %.2f ms\n", g_first_row_ms - g_start_ms, nowMs() - g_start_ms);
+    }
+    return SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,806 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ɫת.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_BAD_ARGUMENT,
+    ERR_THREAD
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PPM P3/P6ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "вϷ",
+    "̴߳ʧ"
+};
+
+#define MAX_WORKERS 64
+
+//========== ߳ԭWindows  Win32 pthread ==========
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Cond;
+typedef HANDLE Thread;
+#define THREAD_FUNC(name) DWORD WINAPI name(LPVOID arg)
+#define THREAD_RETURN return 0
+void mutexInit(Mutex* m) { InitializeCriticalSection(m); }
+void mutexDestroy(Mutex* m) { DeleteCriticalSection(m); }
+void mutexLock(Mutex* m) { EnterCriticalSection(m); }
+void mutexUnlock(Mutex* m) { LeaveCriticalSection(m); }
+void condInit(Cond* c) { InitializeConditionVariable(c); }
+void condDestroy(Cond* c) { (void)c; }
+void condWait(Cond* c, Mutex* m) { SleepConditionVariableCS(c, m, INFINITE); }
+void condSignal(Cond* c) { WakeConditionVariable(c); }
+void condBroadcast(Cond* c) { WakeAllConditionVariable(c); }
+int threadStart(Thread* t, LPTHREAD_START_ROUTINE fn, void* arg) {
+    *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *t == NULL ? -1 : 0;
+}
+void threadJoin(Thread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+int cpuCount(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+#else
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Cond;
+typedef pthread_t Thread;
+#define THREAD_FUNC(name) void* name(void* arg)
+#define THREAD_RETURN return NULL
+void mutexInit(Mutex* m) { pthread_mutex_init(m, NULL); }
+void mutexDestroy(Mutex* m) { pthread_mutex_destroy(m); }
+void mutexLock(Mutex* m) { pthread_mutex_lock(m); }
+void mutexUnlock(Mutex* m) { pthread_mutex_unlock(m); }
+void condInit(Cond* c) { pthread_cond_init(c, NULL); }
+void condDestroy(Cond* c) { pthread_cond_destroy(c); }
+void condWait(Cond* c, Mutex* m) { pthread_cond_wait(c, m); }
+void condSignal(Cond* c) { pthread_cond_signal(c); }
+void condBroadcast(Cond* c) { pthread_cond_broadcast(c); }
+int threadStart(Thread* t, void* (*fn)(void*), void* arg) {
+    return pthread_create(t, NULL, fn, arg) == 0 ? 0 : -1;
+}
+void threadJoin(Thread t) {
+    pthread_join(t, NULL);
+}
+int cpuCount(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+#endif
+
+double nowMs(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e3 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+#endif
+}
+
+//========== ȡ ==========
+
+typedef struct {
+    FILE* file;
+    unsigned char buf[1 << 16];
+    size_t pos;
+    size_t len;
+} Reader;
+
+int readerByte(Reader* rd) {
+    if (rd->pos == rd->len) {
+        rd->len = fread(rd->buf, 1, sizeof(rd->buf), rd->file);
+        rd->pos = 0;
+        if (rd->len == 0) {
+            return EOF;
+        }
+    }
+    return rd->buf[rd->pos++];
+}
+
+/**
+ * ȡһǸհ # עͣԵһָ
+ * @return 0=ɹ-1=ʧ
+ */
+int readerNumber(Reader* rd, int* value) {
+    int ch = readerByte(rd);
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = readerByte(rd);
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = readerByte(rd);
+    }
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    int v = 0;
+    while (ch >= '0' && ch <= '9') {
+        if (v > 100000000) {
+            return -1;
+        }
+        v = v * 10 + (ch - '0');
+        ch = readerByte(rd);
+    }
+    *value = v;
+    return 0;
+}
+
+//========== ˮ ==========
+
+// һд halo Уֻб
+typedef struct {
+    int index;     // д
+    int y0;        // ʼ
+    int rows;      // 
+    int in_y0;     // ʼУ haloõͼڣ
+    int in_rows;   // 
+    int* in;       // in_rows * width * 3
+    int* out;      // rows * width * 3
+} Job;
+
+// нУʱѹʱ
+typedef struct {
+    Job** items;
+    int capacity;
+    int head;
+    int count;
+    int closed;
+} JobQueue;
+
+typedef enum { OP_INVERT, OP_GRAY, OP_SOBEL, OP_BLUR } Operation;
+
+typedef struct {
+    // ͼ
+    int width;
+    int height;
+    int max_val;
+    int binary;
+    int out_max_val;
+    Operation op;
+    int threshold;
+    int radius;
+    int box[4];
+    double* table;
+    double sum_weight;
+    int halo;
+    int band;
+    int workers;
+
+    // I/O
+    Reader* reader;
+    FILE* output;
+
+    // ͬһСɲ
+    Mutex lock;
+    Cond queue_not_empty;
+    Cond queue_not_full;
+    Cond done_ready;
+    Cond slot_free;
+    JobQueue queue;
+    Job** done;          //  index % max_inflight ɵд
+    int max_inflight;    // ͬʱڵдޣڴޣ
+    int inflight;
+    int total_bands;     // ǰΪ -1
+    ErrorCode error;
+
+    // ׶æµʱ
+    double decode_busy;
+    double worker_busy[MAX_WORKERS];
+    double encode_busy;
+    double decode_wait;  // ѹȴʱ
+} Pipeline;
+
+void setError(Pipeline* pl, ErrorCode err) {
+    mutexLock(&pl->lock);
+    if (pl->error == SUCCESS) {
+        pl->error = err;
+    }
+    condBroadcast(&pl->queue_not_empty);
+    condBroadcast(&pl->queue_not_full);
+    condBroadcast(&pl->done_ready);
+    condBroadcast(&pl->slot_free);
+    mutexUnlock(&pl->lock);
+}
+
+void freeJob(Job* job) {
+    if (job != NULL) {
+        free(job->in);
+        free(job->out);
+        free(job);
+    }
+}
+
+//========== ںˣд ==========
+
+double weight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+/**
+ * һдԭһ
+ */
+void processJob(const Pipeline* pl, Job* job) {
+    int width = pl->width;
+    int height = pl->height;
+    size_t stride = (size_t)width * 3;
+    if (pl->op == OP_INVERT || pl->op == OP_GRAY) {
+        for (int y = job->y0; y < job->y0 + job->rows; y++) {
+            const int* s = job->in + (size_t)(y - job->in_y0) * stride;
+            int* d = job->out + (size_t)(y - job->y0) * stride;
+            for (int x = 0; x < width; x++) {
+                if (pl->op == OP_GRAY) {
+                    d[x * 3] = d[x * 3 + 1] = d[x * 3 + 2] = (s[x * 3] + s[x * 3 + 1] + s[x * 3 + 2]) / 3;
+                }
+                else {
+                    d[x * 3] = pl->max_val - s[x * 3];
+                    d[x * 3 + 1] = pl->max_val - s[x * 3 + 1];
+                    d[x * 3 + 2] = pl->max_val - s[x * 3 + 2];
+                }
+            }
+        }
+    }
+    else if (pl->op == OP_SOBEL) {
+        // ȰתҶȣ BT.601ͬ sobelԵ.cú
+        unsigned char* gray = (unsigned char*)malloc((size_t)job->in_rows * width);
+        if (gray == NULL) {
+            memset(job->out, 0, sizeof(int) * job->rows * stride);
+            return;
+        }
+        colorToGray(job->in, gray, (size_t)job->in_rows * width, LUMA_BT601);
+        long t2 = (long)pl->threshold * pl->threshold;
+        for (int y = job->y0; y < job->y0 + job->rows; y++) {
+            int* d = job->out + (size_t)(y - job->y0) * stride;
+            if (y == 0 || y == height - 1) {
+                memset(d, 0, sizeof(int) * stride);
+                continue;
+            }
+            const unsigned char* m = gray + (size_t)(y - job->in_y0) * width;
+            const unsigned char* u = m - width;
+            const unsigned char* dn = m + width;
+            d[0] = d[1] = d[2] = 0;
+            for (int x = 1; x < width - 1; x++) {
+                int gx = (u[x + 1] - u[x - 1]) + 2 * (m[x + 1] - m[x - 1]) + (dn[x + 1] - dn[x - 1]);
+                int gy = (dn[x - 1] + 2 * dn[x] + dn[x + 1]) - (u[x - 1] + 2 * u[x] + u[x + 1]);
+                int edge = ((long)gx * gx + (long)gy * gy >= t2) ? 255 : 0;
+                d[x * 3] = d[x * 3 + 1] = d[x * 3 + 2] = edge;
+            }
+            d[(width - 1) * 3] = d[(width - 1) * 3 + 1] = d[(width - 1) * 3 + 2] = 0;
+        }
+        free(gray);
+    }
+    else {
+        int radius = pl->radius;
+        const int* box = pl->box;
+        for (int y = job->y0; y < job->y0 + job->rows; y++) {
+            const int* center = job->in + (size_t)(y - job->in_y0) * stride;
+            int* d = job->out + (size_t)(y - job->y0) * stride;
+            for (int x = 0; x < width; x++) {
+                if (!(box[0] <= x && x <= box[2] && box[1] <= y && y <= box[3])) {
+                    d[x * 3] = center[x * 3];
+                    d[x * 3 + 1] = center[x * 3 + 1];
+                    d[x * 3 + 2] = center[x * 3 + 2];
+                    continue;
+                }
+                int r = 0, g = 0, b = 0;
+                const double* wt = pl->table;
+                for (int i = x - radius; i <= x + radius; i++) {
+                    for (int j = y - radius; j <= y + radius; j++, wt++) {
+                        if (i < 0 || j < 0 || i >= width || j >= height) {
+                            continue;  // BLACK
+                        }
+                        const int* s = job->in + ((size_t)(j - job->in_y0) * width + i) * 3;
+                        r += *wt * s[0];
+                        g += *wt * s[1];
+                        b += *wt * s[2];
+                    }
+                }
+                d[x * 3] = (int)(r / pl->sum_weight);
+                d[x * 3 + 1] = (int)(g / pl->sum_weight);
+                d[x * 3 + 2] = (int)(b / pl->sum_weight);
+            }
+        }
+    }
+}
+
+//========== ׶ ==========
+
+/**
+ * ̣߳д루 haloн
+ * дص 2*halo дһĩβĸȡظ
+ */
+THREAD_FUNC(decoderThread) {
+    Pipeline* pl = (Pipeline*)arg;
+    size_t stride = (size_t)pl->width * 3;
+    int* carry = NULL;           // һĩβ 2*halo 
+    int carry_y0 = 0, carry_rows = 0;
+    if (pl->halo > 0) {
+        carry = (int*)malloc(sizeof(int) * stride * 2 * pl->halo);
+        if (carry == NULL) {
+            setError(pl, ERR_MEMORY_ALLOC);
+        }
+    }
+    int next_row = 0;            // һдк
+    int index = 0;
+    for (int y0 = 0; y0 < pl->height; y0 += pl->band, index++) {
+        // ѹ;дﵽʱȴд
+        double wait_start = nowMs();
+        mutexLock(&pl->lock);
+        while (pl->inflight >= pl->max_inflight && pl->error == SUCCESS) {
+            condWait(&pl->slot_free, &pl->lock);
+        }
+        int stop = pl->error != SUCCESS;
+        if (!stop) {
+            pl->inflight++;
+        }
+        mutexUnlock(&pl->lock);
+        double start = nowMs();
+        pl->decode_wait += start - wait_start;
+        if (stop) {
+            break;
+        }
+
+        Job* job = (Job*)calloc(1, sizeof(Job));
+        if (job == NULL) {
+            setError(pl, ERR_MEMORY_ALLOC);
+            break;
+        }
+        job->index = index;
+        job->y0 = y0;
+        job->rows = pl->height - y0 < pl->band ? pl->height - y0 : pl->band;
+        job->in_y0 = y0 - pl->halo > 0 ? y0 - pl->halo : 0;
+        int in_end = y0 + job->rows + pl->halo < pl->height ? y0 + job->rows + pl->halo : pl->height;
+        job->in_rows = in_end - job->in_y0;
+        job->in = (int*)malloc(sizeof(int) * stride * job->in_rows);
+        job->out = (int*)malloc(sizeof(int) * stride * job->rows);
+        if (job->in == NULL || job->out == NULL) {
+            freeJob(job);
+            setError(pl, ERR_MEMORY_ALLOC);
+            break;
+        }
+
+        // ѽдӸƣд
+        ErrorCode ret = SUCCESS;
+        for (int y = job->in_y0; y < in_end && ret == SUCCESS; y++) {
+            int* row = job->in + (size_t)(y - job->in_y0) * stride;
+            if (y < next_row) {
+                memcpy(row, carry + (size_t)(y - carry_y0) * stride, sizeof(int) * stride);
+                continue;
+            }
+            if (pl->binary) {
+                for (size_t i = 0; i < stride; i++) {
+                    int hi = readerByte(pl->reader);
+                    if (pl->max_val > 255 && hi != EOF) {
+                        int lo = readerByte(pl->reader);
+                        hi = lo == EOF ? EOF : (hi << 8) | lo;
+                    }
+                    if (hi == EOF) {
+                        ret = ERR_FILE_BROKEN;
+                        break;
+                    }
+                    row[i] = hi;
+                }
+            }
+            else {
+                for (size_t i = 0; i < stride; i++) {
+                    if (readerNumber(pl->reader, &row[i]) != 0 || row[i] > pl->max_val) {
+                        ret = ERR_FILE_BROKEN;
+                        break;
+                    }
+                }
+            }
+            next_row = y + 1;
+        }
+        if (ret != SUCCESS) {
+            freeJob(job);
+            setError(pl, ret);
+            break;
+        }
+        if (pl->halo > 0) {
+            carry_rows = job->in_rows < 2 * pl->halo ? job->in_rows : 2 * pl->halo;
+            carry_y0 = in_end - carry_rows;
+            memcpy(carry, job->in + (size_t)(carry_y0 - job->in_y0) * stride, sizeof(int) * stride * carry_rows);
+        }
+        pl->decode_busy += nowMs() - start;
+
+        mutexLock(&pl->lock);
+        while (pl->queue.count == pl->queue.capacity && pl->error == SUCCESS) {
+            condWait(&pl->queue_not_full, &pl->lock);
+        }
+        if (pl->error != SUCCESS) {
+            mutexUnlock(&pl->lock);
+            freeJob(job);
+            break;
+        }
+        pl->queue.items[(pl->queue.head + pl->queue.count) % pl->queue.capacity] = job;
+        pl->queue.count++;
+        condSignal(&pl->queue_not_empty);
+        mutexUnlock(&pl->lock);
+    }
+
+    mutexLock(&pl->lock);
+    pl->total_bands = index;
+    pl->queue.closed = 1;
+    condBroadcast(&pl->queue_not_empty);
+    condBroadcast(&pl->done_ready);
+    mutexUnlock(&pl->lock);
+    free(carry);
+    THREAD_RETURN;
+}
+
+typedef struct {
+    Pipeline* pl;
+    int id;
+} WorkerArg;
+
+/**
+ * ̣߳Ӷȡдɲۣɣ
+ */
+THREAD_FUNC(workerThread) {
+    WorkerArg* wa = (WorkerArg*)arg;
+    Pipeline* pl = wa->pl;
+    for (;;) {
+        mutexLock(&pl->lock);
+        while (pl->queue.count == 0 && !pl->queue.closed && pl->error == SUCCESS) {
+            condWait(&pl->queue_not_empty, &pl->lock);
+        }
+        if (pl->queue.count == 0 || pl->error != SUCCESS) {
+            mutexUnlock(&pl->lock);
+            break;
+        }
+        Job* job = pl->queue.items[pl->queue.head];
+        pl->queue.head = (pl->queue.head + 1) % pl->queue.capacity;
+        pl->queue.count--;
+        condSignal(&pl->queue_not_full);
+        mutexUnlock(&pl->lock);
+
+        double start = nowMs();
+        processJob(pl, job);
+        pl->worker_busy[wa->id] += nowMs() - start;
+
+        mutexLock(&pl->lock);
+        pl->done[job->index % pl->max_inflight] = job;
+        condBroadcast(&pl->done_ready);
+        mutexUnlock(&pl->lock);
+    }
+    THREAD_RETURN;
+}
+
+/**
+ * ̣߳д˳ʽддͷ;
+ */
+THREAD_FUNC(encoderThread) {
+    Pipeline* pl = (Pipeline*)arg;
+    size_t stride = (size_t)pl->width * 3;
+    // P3 һÿ 5 λ + ոӻ
+    char* text = (char*)malloc(stride * 6 * pl->band + pl->band);
+    if (text == NULL) {
+        setError(pl, ERR_MEMORY_ALLOC);
+        THREAD_RETURN;
+    }
+    for (int next = 0;; next++) {
+        mutexLock(&pl->lock);
+        Job* job;
+        while (((job = pl->done[next % pl->max_inflight]) == NULL || job->index != next) &&
+            pl->error == SUCCESS && !(pl->total_bands >= 0 && next >= pl->total_bands)) {
+            condWait(&pl->done_ready, &pl->lock);
+        }
+        if (pl->error != SUCCESS || job == NULL || job->index != next) {
+            mutexUnlock(&pl->lock);
+            break;
+        }
+        pl->done[next % pl->max_inflight] = NULL;
+        mutexUnlock(&pl->lock);
+
+        double start = nowMs();
+        size_t len = 0;
+        size_t n = stride * job->rows;
+        if (pl->binary) {
+            for (size_t i = 0; i < n; i++) {
+                if (pl->out_max_val > 255) {
+                    text[len++] = (char)(job->out[i] >> 8);
+                }
+                text[len++] = (char)job->out[i];
+            }
+        }
+        else {
+            for (size_t i = 0; i < n; i++) {
+                char digits[8];
+                int v = job->out[i], k = 0;
+                do {
+                    digits[k++] = (char)('0' + v % 10);
+                    v /= 10;
+                } while (v > 0);
+                while (k > 0) {
+                    text[len++] = digits[--k];
+                }
+                text[len++] = ' ';
+                if ((i + 1) % stride == 0) {
+                    text[len++] = '\n';
+                }
+            }
+        }
+        int failed = fwrite(text, 1, len, pl->output) != len;
+        freeJob(job);
+        pl->encode_busy += nowMs() - start;
+        if (failed) {
+            setError(pl, ERR_WRITE_FAILED);
+            break;
+        }
+
+        mutexLock(&pl->lock);
+        pl->inflight--;
+        condSignal(&pl->slot_free);
+        mutexUnlock(&pl->lock);
+    }
+    free(text);
+    THREAD_RETURN;
+}
+
+//==========  ==========
+
+void printUsage(const char* prog) {
+    printf("÷%s <> <.ppm|-> <.ppm|-> [] [--threads N] [--band ROWS] [--queue N]\n", prog);
+    printf("  invert | gray | sobel T | blur R [X1 Y1 X2 Y2]\n");
+    printf("롢׶βУ߳ -> н -> N ߳ -> ߳\n");
+}
+
+int main(int argc, char* argv[]) {
+    // 1. 
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    Pipeline pl;
+    memset(&pl, 0, sizeof(Pipeline));
+    const char* op = argv[1];
+    const char* input_path = argv[2];
+    const char* output_path = argv[3];
+    int params[5] = { 0, 0, 0, 0, 0 };
+    int param_count = 0;
+    int queue_capacity = 0;
+    pl.workers = cpuCount();
+    pl.band = 64;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            pl.workers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--band") == 0 && i + 1 < argc) {
+            pl.band = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            queue_capacity = atoi(argv[++i]);
+        }
+        else if (param_count < 5) {
+            params[param_count++] = atoi(argv[i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return ERR_BAD_ARGUMENT;
+        }
+    }
+    int valid = pl.workers >= 1 && pl.workers <= MAX_WORKERS && pl.band >= 1 && queue_capacity >= 0;
+    if (strcmp(op, "invert") == 0 && param_count == 0) {
+        pl.op = OP_INVERT;
+    }
+    else if (strcmp(op, "gray") == 0 && param_count == 0) {
+        pl.op = OP_GRAY;
+    }
+    else if (strcmp(op, "sobel") == 0 && param_count == 1 && params[0] >= 0 && params[0] <= 255) {
+        pl.op = OP_SOBEL;
+        pl.threshold = params[0];
+        pl.halo = 1;
+    }
+    else if (strcmp(op, "blur") == 0 && (param_count == 1 || param_count == 5) && params[0] >= 0 && params[0] <= 64) {
+        pl.op = OP_BLUR;
+        pl.radius = params[0];
+        pl.halo = params[0];
+    }
+    else {
+        valid = 0;
+    }
+    if (!valid) {
+        printUsage(argv[0]);
+        return ERR_BAD_ARGUMENT;
+    }
+    // ĬΪ߳ 2 ; =  + ÿ߳һ + ȴһ
+    if (queue_capacity == 0) {
+        queue_capacity = 2 * pl.workers;
+    }
+    pl.max_inflight = queue_capacity + 2 * pl.workers + 2;
+
+    // 2. ļͷ
+    static Reader reader;
+    reader.file = strcmp(input_path, "-") == 0 ? stdin : fopen(input_path, "rb");
+    if (reader.file == NULL) {
+        printf("%s\n", error_messages[ERR_FILE_NOT_FOUND]);
+        return ERR_FILE_NOT_FOUND;
+    }
+    pl.reader = &reader;
+    ErrorCode ret = SUCCESS;
+    int kind = 0;
+    if (readerByte(&reader) != 'P' || ((kind = readerByte(&reader)) != '3' && kind != '6')) {
+        ret = ERR_WRONG_FORMAT;
+    }
+    else if (readerNumber(&reader, &pl.width) != 0 || readerNumber(&reader, &pl.height) != 0 ||
+        readerNumber(&reader, &pl.max_val) != 0) {
+        ret = ERR_FILE_BROKEN;
+    }
+    else if (pl.width <= 0 || pl.height <= 0 || pl.max_val <= 0 || pl.max_val > 65535 ||
+        (pl.op == OP_SOBEL && (pl.max_val > 255 || pl.width < 3 || pl.height < 3))) {
+        ret = ERR_ILLEGAL_SIZE;
+    }
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        if (reader.file != stdin) {
+            fclose(reader.file);
+        }
+        return ret;
+    }
+    pl.binary = kind == '6';
+    pl.out_max_val = pl.op == OP_SOBEL ? 255 : pl.max_val;
+    if (pl.op == OP_BLUR) {
+        int side = 2 * pl.radius + 1;
+        pl.table = (double*)malloc(sizeof(double) * side * side);
+        if (pl.table == NULL) {
+            printf("%s\n", error_messages[ERR_MEMORY_ALLOC]);
+            return ERR_MEMORY_ALLOC;
+        }
+        for (int dx = -pl.radius; dx <= pl.radius; dx++) {
+            for (int dy = -pl.radius; dy <= pl.radius; dy++) {
+                pl.table[(dx + pl.radius) * side + (dy + pl.radius)] = weight(5.0, dx, dy, &pl.sum_weight);
+            }
+        }
+        if (param_count == 5) {
+            memcpy(pl.box, params + 1, sizeof(pl.box));
+        }
+        else {
+            pl.box[0] = 0;
+            pl.box[1] = 0;
+            pl.box[2] = pl.width - 1;
+            pl.box[3] = pl.height - 1;
+        }
+    }
+    pl.output = strcmp(output_path, "-") == 0 ? stdout : fopen(output_path, "wb");
+    if (pl.output == NULL ||
+        fprintf(pl.output, "%s\n%d %d\n%d\n", pl.binary ? "P6" : "P3", pl.width, pl.height, pl.out_max_val) < 0) {
+        printf("%s\n", error_messages[ERR_WRITE_FAILED]);
+        free(pl.table);
+        return ERR_WRITE_FAILED;
+    }
+
+    // 3. ׶
+    mutexInit(&pl.lock);
+    condInit(&pl.queue_not_empty);
+    condInit(&pl.queue_not_full);
+    condInit(&pl.done_ready);
+    condInit(&pl.slot_free);
+    pl.queue.capacity = queue_capacity;
+    pl.queue.items = (Job**)calloc(queue_capacity, sizeof(Job*));
+    pl.done = (Job**)calloc(pl.max_inflight, sizeof(Job*));
+    pl.total_bands = -1;
+    if (pl.queue.items == NULL || pl.done == NULL) {
+        pl.error = ERR_MEMORY_ALLOC;
+    }
+
+    double wall_start = nowMs();
+    Thread decoder, encoder, workers[MAX_WORKERS];
+    WorkerArg worker_args[MAX_WORKERS];
+    int started = 0;
+    int decoder_started = 0, encoder_started = 0;
+    if (pl.error == SUCCESS) {
+        decoder_started = threadStart(&decoder, decoderThread, &pl) == 0;
+        encoder_started = threadStart(&encoder, encoderThread, &pl) == 0;
+        for (; started < pl.workers; started++) {
+            worker_args[started].pl = &pl;
+            worker_args[started].id = started;
+            if (threadStart(&workers[started], workerThread, &worker_args[started]) != 0) {
+                break;
+            }
+        }
+        if (!decoder_started || !encoder_started || started == 0) {
+            setError(&pl, ERR_THREAD);
+        }
+    }
+    if (decoder_started) {
+        threadJoin(decoder);
+    }
+    for (int i = 0; i < started; i++) {
+        threadJoin(workers[i]);
+    }
+    if (encoder_started) {
+        threadJoin(encoder);
+    }
+    double wall = nowMs() - wall_start;
+
+    // 4. ʱд
+    for (int i = 0; i < pl.queue.count; i++) {
+        freeJob(pl.queue.items[(pl.queue.head + i) % pl.queue.capacity]);
+    }
+    for (int i = 0; i < pl.max_inflight && pl.done != NULL; i++) {
+        freeJob(pl.done[i]);
+    }
+    free(pl.queue.items);
+    free(pl.done);
+    free(pl.table);
+    if (reader.file != stdin) {
+        fclose(reader.file);
+    }
+    ret = pl.error;
+    if (pl.output != stdout) {
+        if (fclose(pl.output) != 0 && ret == SUCCESS) {
+            ret = ERR_WRITE_FAILED;
+        }
+    }
+    else if (fflush(stdout) != 0 && ret == SUCCESS) {
+        ret = ERR_WRITE_FAILED;
+    }
+    condDestroy(&pl.queue_not_empty);
+    condDestroy(&pl.queue_not_full);
+    condDestroy(&pl.done_ready);
+    condDestroy(&pl.slot_free);
+    mutexDestroy(&pl.lock);
+    if (ret != SUCCESS) {
+        fprintf(stderr, "%s\n", error_messages[ret]);
+        return ret;
+    }
+
+    // 5. ׶ʣæµʱ / ǽʱ䣩д stderrstdout ͼ
+    double worker_total = 0.0;
+    for (int i = 0; i < started; i++) {
+        worker_total += pl.worker_busy[i];
+    }
+    fprintf(stderr, "%-16s %12s %10s\n", "׶", "æµ(ms)", "");
+    fprintf(stderr, "%-16s %12.1f %9.1f%%\n", "", pl.decode_busy, 100.0 * pl.decode_busy / wall);
+    char label[32];
+    snprintf(label, sizeof(label), " x%d", started);
+    fprintf(stderr, "%-16s %12.1f %9.1f%%\n", label, worker_total, 100.0 * worker_total / (wall * started));
+    fprintf(stderr, "%-16s %12.1f %9.1f%%\n", "", pl.encode_busy, 100.0 * pl.encode_busy / wall);
+    fprintf(stderr, "ǽ %.1f ms׶δ֮ %.1f msѹȴ %.1f ms\n",
+        wall, pl.decode_busy + worker_total / started + pl.encode_busy, pl.decode_wait);
+    return SUCCESS;
+}
\ No newline at end of file
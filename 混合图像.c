@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "ͳ.h"
+#include ".h"
 
 // ؽṹ
 typedef struct {
@@ -54,7 +56,9 @@ void* safeMalloc(size_t size) {
     void* ptr = malloc(size);
     if (!ptr) {
         throwError(ERR_MEMORY_ALLOC);
+        return ptr;
     }
+    STATS_ALLOC(size);
     return ptr;
 }
 
@@ -100,6 +104,7 @@ void readPPM(const char* path, PPM* ppm) {
         for (int x = 0; x < width; x++) {
             if (fscanf(file, "%d %d %d", &r, &g, &b) != 3) {
                 fclose(file);
+                STATS_FREE(sizeof(Pixel) * width * height);
                 free(ppm->data);
                 ppm->data = NULL;
                 throwError(ERR_FILE_BROKEN);
@@ -116,6 +121,7 @@ void readPPM(const char* path, PPM* ppm) {
         }
     }
 
+    STATS_BYTES_READ(ftell(file));
     fclose(file);
 }
 
@@ -154,6 +160,7 @@ void handle() {
     if (checkError()) return;
 
     // ش
+    STATS_BEGIN(kernel_span, "multiplyBlend");
     for (int y = 0; y < outHeight; y++) {
         for (int x = 0; x < outWidth; x++) {
             // 鵱ǰǷͼķΧ
@@ -177,6 +184,7 @@ void handle() {
             // ϲߵΪߴǽϴǸ
         }
     }
+    STATS_END(kernel_span, outWidth * outHeight);
 }
 
 // дϺͼ
@@ -207,12 +215,14 @@ void write() {
     if (flag) {
         throwError(ERR_FAILED_TO_WRITE);
     }
+    STATS_BYTES_WRITTEN(ftell(file));
     fclose(file);
 }
 
 // ͷͼڴ
 void freePPM(PPM* ppm) {
     if (ppm->data) {
+        STATS_FREE(sizeof(Pixel) * ppm->width * ppm->height);
         free(ppm->data);
         ppm->data = NULL;
     }
@@ -231,39 +241,63 @@ const char* getErrorMsg() {
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    STATS_INIT(argc, argv);
+    RESULT_CACHE_INIT(argc, argv);
+
+    // ݶûʱֱȡĽ --cache DIR 
+    ResultKey cache_key;
+    resultKeyInit(&cache_key, "multiplyBlend");
+    resultKeyAddFile(&cache_key, READ_PATH_1);
+    resultKeyAddFile(&cache_key, READ_PATH_2);
+    if (resultCacheFetch(&cache_key, WRITE_PATH)) {
+        STATS_FINISH();
+        return 0;
+    }
+
+    STATS_BEGIN(read_span, "read");
     read();
+    STATS_END(read_span, inPPM_1.width * inPPM_1.height + inPPM_2.width * inPPM_2.height);
     if (checkError()) {
         printf("ȡͼʧ: %s\n", getErrorMsg());
         freePPM(&inPPM_1);
         freePPM(&inPPM_2);
+        STATS_FINISH();
         return ERR_STATE;
     }
 
+    STATS_BEGIN(handle_span, "handle");
     handle();
+    STATS_END(handle_span, outPPM.width * outPPM.height);
     if (checkError()) {
         printf("ͼʧ: %s\n", getErrorMsg());
         freePPM(&inPPM_1);
         freePPM(&inPPM_2);
         freePPM(&outPPM);
+        STATS_FINISH();
         return ERR_STATE;
     }
 
+    STATS_BEGIN(write_span, "write");
     write();
+    STATS_END(write_span, outPPM.width * outPPM.height);
     if (checkError()) {
         printf("дͼʧ: %s\n", getErrorMsg());
         freePPM(&inPPM_1);
         freePPM(&inPPM_2);
         freePPM(&outPPM);
+        STATS_FINISH();
         return ERR_STATE;
     }
 
     printf("ͼϳɹѱ: %s\n", WRITE_PATH);
+    resultCacheStore(&cache_key, WRITE_PATH);
 
     // ͷڴ
     freePPM(&inPPM_1);
     freePPM(&inPPM_2);
     freePPM(&outPPM);
 
+    STATS_FINISH();
     return 0;
 }
\ No newline at end of file
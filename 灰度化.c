@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "ͳ.h"
+#include "ɫת.h"
 
 //TYPE BEGIN
 typedef struct {
@@ -17,11 +19,19 @@ typedef struct {
 	int colorset;
 	Pixel* data;
 } PPM;
+
+// ͨҶͼÿֻһֵ
+typedef struct {
+	int width;
+	int height;
+	int colorset;
+	int* data;
+} PGM;
 //TYPE END
 
 //VAR BEGIN
 const char* READ_PATH = "C:\\code\\apple.ppm";
-const char* WRITE_PATH = "C:\\code\\(ҶȻ)apple.ppm";
+const char* WRITE_PATH = "C:\\code\\(ҶȻ)apple.pgm";
 
 int ERR_STATE = 0;
 
@@ -30,11 +40,12 @@ enum {
 	ERR_WRONG_FORMAT_HEADER,
 	ERR_ILLEGAL_SIZE,
 	ERR_FILE_BROKEN,
-	ERR_FAILED_TO_WRITE
+	ERR_FAILED_TO_WRITE,
+	ERR_BAD_ARGUMENT
 };
 
 PPM inPPM;
-PPM outPPM;
+PGM outPGM;
 //VAR END
 
 //FCUNTION BEGIN
@@ -67,6 +78,7 @@ void read() {
 	inPPM.height = height;
 	inPPM.colorset = colorset;
 	inPPM.data = malloc(sizeof(Pixel) * width * height);
+	STATS_ALLOC(sizeof(Pixel) * width * height);
 	int r, g, b;
 	for (int y = 0; y < height; y++) {
 		for (int x = 0; x < width; x++) {
@@ -81,6 +93,7 @@ void read() {
 			}
 		}
 	}
+	STATS_BYTES_READ(ftell(stdin));
 	fclose(stdin);
 }
 
@@ -94,54 +107,61 @@ void write() {
 		return;
 	}
 	int flag = 0;
-	flag |= 0 >= fprintf(file, "P3\n");
-	flag |= 0 >= fprintf(file, "%d %d\n", outPPM.width, outPPM.height);
-	flag |= 0 >= fprintf(file, "%d\n", outPPM.colorset);
-	int N = outPPM.width * outPPM.height;
+	flag |= 0 >= fprintf(file, "P2\n");
+	flag |= 0 >= fprintf(file, "%d %d\n", outPGM.width, outPGM.height);
+	flag |= 0 >= fprintf(file, "%d\n", outPGM.colorset);
+	int N = outPGM.width * outPGM.height;
 	for (int i = 0; i < N; i++) {
-		flag |= 0 >= fprintf(file, "%d\n", outPPM.data[i].r);
-		flag |= 0 >= fprintf(file, "%d\n", outPPM.data[i].g);
-		flag |= 0 >= fprintf(file, "%d\n", outPPM.data[i].b);
+		flag |= 0 >= fprintf(file, "%d\n", outPGM.data[i]);
 	}
 	if (flag) {
 		throwError(ERR_FAILED_TO_WRITE);
 		return;
 	}
 	fflush(file);
+	STATS_BYTES_WRITTEN(ftell(file));
 	fclose(file);
 }
 
-Pixel invert(Pixel* source, int colorset) {
-	Pixel p;
-	int gray = 0;
-	gray = (source->r + source->g + source->b)/3;
-	p.r = gray;
-	p.g = gray;
-	p.b = gray;
-	return p;
-}
-
-void handle() {
+void handle(LumaStandard standard) {
 	if (checkError()) {
 		return;
 	}
 	int width = inPPM.width;
 	int height = inPPM.height;
-	outPPM.width = width;
-	outPPM.height = height;
-	outPPM.colorset = inPPM.colorset;
-	outPPM.data = malloc(sizeof(Pixel) * width * height);
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			outPPM.data[x + y * width] = invert(inPPM.data + x + y * width, inPPM.colorset);
-		}
-	}
+	outPGM.width = width;
+	outPGM.height = height;
+	outPGM.colorset = inPPM.colorset;
+	outPGM.data = malloc(sizeof(int) * width * height);
+	STATS_ALLOC(sizeof(int) * width * height);
+	STATS_BEGIN(kernel_span, "gray");
+	colorToGrayWide((const int*)inPPM.data, outPGM.data, (size_t)width * height, standard);
+	STATS_END(kernel_span, width * height);
 }
 //FUNCTION END
 
-int main() {
+int main(int argc, char* argv[]) {
+	STATS_INIT(argc, argv);
+	// ѡҶȹʽ averageĬϣ(r+g+b)/3bt601bt709
+	LumaStandard standard = LUMA_AVERAGE;
+	if (argc > 1) {
+		int found = lumaStandardByName(argv[1]);
+		if (found < 0) {
+			printf("÷%s [average|bt601|bt709]\n", argv[0]);
+			STATS_FINISH();
+			return ERR_BAD_ARGUMENT;
+		}
+		standard = (LumaStandard)found;
+	}
+	STATS_BEGIN(read_span, "read");
 	read();
-	handle();
+	STATS_END(read_span, inPPM.width * inPPM.height);
+	STATS_BEGIN(handle_span, "handle");
+	handle(standard);
+	STATS_END(handle_span, outPGM.width * outPGM.height);
+	STATS_BEGIN(write_span, "write");
 	write();
+	STATS_END(write_span, outPGM.width * outPGM.height);
+	STATS_FINISH();
 	return ERR_STATE;
 }
\ No newline at end of file
@@ -0,0 +1,472 @@
+#define _CRT_SECURE_NO_WARNINGS 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ͳ.h"
+#include "ɫת.h"
+
+/**
+ * ͨҶ̣ҶȻ  ˹ģ  Sobel  ֵȫÿ 1 ֽ
+ *  P3/P6 ʱֻڶʱһ RGBҶȣɫת.hĬ sobelԵ.c ͬ BT.601
+ * --luma ѡ average / bt709 P2/P5 ʱֱӶ룻мչ RGBΪ PGMĬ P5--p2 ı
+ * ÷Ҷ <> <.pgm> [--luma ʽ] [--blur R] [--sobel] [--threshold T] [--p2]
+ * 谴Ĺ̶˳ִУδָĲ
+ */
+
+// ͨҶͼ
+typedef struct {
+    int width;            // ͼ
+    int height;           // ͼ߶
+    int max_val;          // ֵ 255
+    unsigned char* data;  // width*height 
+} GrayImage;
+
+// ö
+typedef enum {
+    SUCCESS = 0,
+    ERR_FILE_NOT_FOUND,
+    ERR_WRONG_FORMAT,
+    ERR_ILLEGAL_SIZE,
+    ERR_MEMORY_ALLOC,
+    ERR_FILE_BROKEN,
+    ERR_WRITE_FAILED,
+    ERR_BAD_ARGUMENT
+} ErrorCode;
+
+// ȫִϢӳ
+const char* error_messages[] = {
+    "ɹ",
+    "ļδҵ",
+    "󣺲PGM P2/P5  PPM P3/P6 ʽ",
+    "ͼߴֵϷ",
+    "ڴʧ",
+    "ļ",
+    "дļʧ",
+    "вϷ"
+};
+
+//========== ȡ ==========
+
+typedef struct {
+    FILE* file;
+    unsigned char buf[1 << 16];
+    size_t pos;
+    size_t len;
+    double total;  // Ѷֽ
+} Reader;
+
+int readerByte(Reader* rd) {
+    if (rd->pos == rd->len) {
+        rd->len = fread(rd->buf, 1, sizeof(rd->buf), rd->file);
+        rd->pos = 0;
+        rd->total += rd->len;
+        if (rd->len == 0) {
+            return EOF;
+        }
+    }
+    return rd->buf[rd->pos++];
+}
+
+/**
+ * ȡһǸհ # עͣԵһָ
+ * @return 0=ɹ-1=ʧ
+ */
+int readerNumber(Reader* rd, int* value) {
+    int ch = readerByte(rd);
+    while (ch != EOF) {
+        if (ch == '#') {
+            while (ch != EOF && ch != '\n') {
+                ch = readerByte(rd);
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ch = readerByte(rd);
+    }
+    if (ch < '0' || ch > '9') {
+        return -1;
+    }
+    int v = 0;
+    while (ch >= '0' && ch <= '9') {
+        if (v > 100000000) {
+            return -1;
+        }
+        v = v * 10 + (ch - '0');
+        ch = readerByte(rd);
+    }
+    *value = v;
+    return 0;
+}
+
+//========== д ==========
+
+/**
+ * ͷŻҶͼĶ̬ڴ
+ */
+void freeGray(GrayImage* img) {
+    if (img != NULL && img->data != NULL) {
+        STATS_FREE((size_t)img->width * img->height);
+        free(img->data);
+        img->data = NULL;
+    }
+}
+
+/**
+ * Ҷͼ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode allocGray(GrayImage* img, int width, int height, int max_val) {
+    img->width = width;
+    img->height = height;
+    img->max_val = max_val;
+    img->data = (unsigned char*)malloc((size_t)width * height);
+    if (img->data == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    STATS_ALLOC((size_t)width * height);
+    return SUCCESS;
+}
+
+/**
+ * ҶͼP2/P5 ֱӶ룬P3/P6 ʱתΪҶȣֻתһΣ
+ * @param filenameļ·
+ * @param imgҶͼǰ
+ * @param standardRGB ĻҶȹʽ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode readGray(const char* filename, GrayImage* img, LumaStandard standard) {
+    memset(img, 0, sizeof(GrayImage));
+    static Reader rd;
+    memset(&rd, 0, sizeof(Reader));
+    rd.file = fopen(filename, "rb");
+    if (rd.file == NULL) {
+        return ERR_FILE_NOT_FOUND;
+    }
+    int kind = 0;
+    int width, height, max_val;
+    ErrorCode ret = SUCCESS;
+    if (readerByte(&rd) != 'P' || ((kind = readerByte(&rd)) != '2' && kind != '3' && kind != '5' && kind != '6')) {
+        ret = ERR_WRONG_FORMAT;
+    }
+    else if (readerNumber(&rd, &width) != 0 || readerNumber(&rd, &height) != 0 || readerNumber(&rd, &max_val) != 0) {
+        ret = ERR_FILE_BROKEN;
+    }
+    else if (width <= 0 || height <= 0 || max_val <= 0 || max_val > 255) {
+        ret = ERR_ILLEGAL_SIZE;
+    }
+    else {
+        ret = allocGray(img, width, height, max_val);
+    }
+    if (ret != SUCCESS) {
+        fclose(rd.file);
+        return ret;
+    }
+
+    int channels = (kind == '3' || kind == '6') ? 3 : 1;
+    int binary = kind == '5' || kind == '6';
+    int* row = (int*)malloc(sizeof(int) * width * channels);
+    if (row == NULL) {
+        ret = ERR_MEMORY_ALLOC;
+    }
+    for (int y = 0; y < height && ret == SUCCESS; y++) {
+        for (int i = 0; i < width * channels; i++) {
+            if (binary) {
+                row[i] = readerByte(&rd);
+                if (row[i] == EOF) {
+                    ret = ERR_FILE_BROKEN;
+                    break;
+                }
+            }
+            else if (readerNumber(&rd, &row[i]) != 0) {
+                ret = ERR_FILE_BROKEN;
+                break;
+            }
+        }
+        if (ret != SUCCESS) {
+            break;
+        }
+        unsigned char* dst = img->data + (size_t)y * width;
+        if (channels == 1) {
+            for (int x = 0; x < width; x++) {
+                dst[x] = (unsigned char)row[x];
+            }
+        }
+        else {
+            colorToGray(row, dst, (size_t)width, standard);
+        }
+    }
+    free(row);
+    STATS_BYTES_READ(rd.total);
+    fclose(rd.file);
+    if (ret != SUCCESS) {
+        freeGray(img);
+    }
+    return ret;
+}
+
+/**
+ * Ϊ PGM
+ * @param filenameļ·
+ * @param imgҶͼ
+ * @param binary1=P5ÿ 1 ֽڣ0=P2ıÿжӦͼһУ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode writePGM(const char* filename, const GrayImage* img, int binary) {
+    if (filename == NULL || img == NULL || img->data == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        return ERR_WRITE_FAILED;
+    }
+    int failed = fprintf(file, "%s\n%d %d\n%d\n", binary ? "P5" : "P2", img->width, img->height, img->max_val) < 0;
+    if (binary) {
+        size_t n = (size_t)img->width * img->height;
+        failed |= fwrite(img->data, 1, n, file) != n;
+    }
+    else {
+        // ÿ "255 "һһд
+        char* line = (char*)malloc((size_t)img->width * 4 + 2);
+        failed |= line == NULL;
+        for (int y = 0; y < img->height && !failed; y++) {
+            const unsigned char* row = img->data + (size_t)y * img->width;
+            char* p = line;
+            for (int x = 0; x < img->width; x++) {
+                int v = row[x];
+                if (v >= 100) {
+                    *p++ = (char)('0' + v / 100);
+                }
+                if (v >= 10) {
+                    *p++ = (char)('0' + v / 10 % 10);
+                }
+                *p++ = (char)('0' + v % 10);
+                *p++ = x + 1 < img->width ? ' ' : '\n';
+            }
+            failed |= fwrite(line, 1, (size_t)(p - line), file) != (size_t)(p - line);
+        }
+        free(line);
+    }
+    if (!failed) {
+        STATS_BYTES_WRITTEN(ftell(file));
+    }
+    failed |= fclose(file) != 0;
+    return failed ? ERR_WRITE_FAILED : SUCCESS;
+}
+
+//========== Ҷ ==========
+
+// Ȩأ ˹ģ.c ͬ
+double weight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+/**
+ * ˹ģͨȡʽ ˹ģ.c һ£ͼⰴ 0 ƣ
+ * @param inҶͼ
+ * @param outҶͼǰ
+ * @param radiusģ뾶
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode grayBlur(const GrayImage* in, GrayImage* out, int radius) {
+    int width = in->width;
+    int height = in->height;
+    int side = 2 * radius + 1;
+    double* table = (double*)malloc(sizeof(double) * side * side);
+    if (table == NULL) {
+        return ERR_MEMORY_ALLOC;
+    }
+    ErrorCode ret = allocGray(out, width, height, in->max_val);
+    if (ret != SUCCESS) {
+        free(table);
+        return ret;
+    }
+    double sum_weight = 0.0;
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dy = -radius; dy <= radius; dy++) {
+            table[(dx + radius) * side + (dy + radius)] = weight(5.0, dx, dy, &sum_weight);
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        unsigned char* dst = out->data + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int v = 0;
+            const double* wt = table;
+            for (int i = x - radius; i <= x + radius; i++) {
+                for (int j = y - radius; j <= y + radius; j++, wt++) {
+                    if (i < 0 || j < 0 || i >= width || j >= height) {
+                        continue;  // ͼⰴɫ
+                    }
+                    v += *wt * in->data[(size_t)j * width + i];  // ԭʵһÿۼӺضΪ
+                }
+            }
+            dst[x] = (unsigned char)(int)(v / sum_weight);
+        }
+    }
+    free(table);
+    return SUCCESS;
+}
+
+/**
+ * Sobelݶȷֵֵͨȡص 255߽Ϊ 0
+ * ͬһֵֵʱ sobelԵ.c  sqrt(gx*gx+gy*gy) >= ֵ ͬ
+ * @param inҶͼ 3x3
+ * @param outֵͼǰ
+ * @return 루SUCCESS=ɹ
+ */
+ErrorCode graySobel(const GrayImage* in, GrayImage* out) {
+    int width = in->width;
+    int height = in->height;
+    if (width < 3 || height < 3) {
+        return ERR_ILLEGAL_SIZE;
+    }
+    ErrorCode ret = allocGray(out, width, height, 255);
+    if (ret != SUCCESS) {
+        return ret;
+    }
+    memset(out->data, 0, (size_t)width);
+    memset(out->data + (size_t)(height - 1) * width, 0, (size_t)width);
+    for (int y = 1; y < height - 1; y++) {
+        const unsigned char* p0 = in->data + (size_t)(y - 1) * width;
+        const unsigned char* p1 = p0 + width;
+        const unsigned char* p2 = p1 + width;
+        unsigned char* dst = out->data + (size_t)y * width;
+        dst[0] = 0;
+        dst[width - 1] = 0;
+        for (int x = 1; x < width - 1; x++) {
+            int gx = (p0[x + 1] - p0[x - 1]) + 2 * (p1[x + 1] - p1[x - 1]) + (p2[x + 1] - p2[x - 1]);
+            int gy = (p2[x - 1] + 2 * p2[x] + p2[x + 1]) - (p0[x - 1] + 2 * p0[x] + p0[x + 1]);
+            int magnitude = (int)sqrt((double)(gx * gx + gy * gy));
+            dst[x] = (unsigned char)(magnitude > 255 ? 255 : magnitude);
+        }
+    }
+    return SUCCESS;
+}
+
+/**
+ * ֵֵԭأСֵΪֵΪ 0
+ */
+void grayThreshold(GrayImage* img, int threshold) {
+    size_t n = (size_t)img->width * img->height;
+    unsigned char high = (unsigned char)img->max_val;
+    for (size_t i = 0; i < n; i++) {
+        img->data[i] = img->data[i] >= threshold ? high : 0;
+    }
+}
+
+void printUsage(const char* prog) {
+    printf("÷%s <.ppm|.pgm> <.pgm> [--luma average|bt601|bt709] [--blur R] [--sobel] [--threshold T] [--p2]\n", prog);
+    printf("   ҶȻ  ģ  Sobel  ֵ ˳ִУδָĲ\n");
+}
+
+/**
+ * ̿
+ */
+int main(int argc, char* argv[]) {
+    STATS_INIT(argc, argv);
+
+    // 1. 
+    if (argc < 3) {
+        printUsage(argv[0]);
+        STATS_FINISH();
+        return ERR_BAD_ARGUMENT;
+    }
+    const char* input_path = argv[1];
+    const char* output_path = argv[2];
+    int radius = -1;
+    int sobel = 0;
+    int threshold = -1;
+    int binary = 1;
+    int luma = LUMA_BT601;
+    int valid = 1;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--luma") == 0 && i + 1 < argc) {
+            luma = lumaStandardByName(argv[++i]);
+            valid &= luma >= 0;
+        }
+        else if (strcmp(argv[i], "--blur") == 0 && i + 1 < argc) {
+            radius = atoi(argv[++i]);
+            valid &= radius >= 0 && radius <= 64;
+        }
+        else if (strcmp(argv[i], "--sobel") == 0) {
+            sobel = 1;
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atoi(argv[++i]);
+            valid &= threshold >= 0 && threshold <= 255;
+        }
+        else if (strcmp(argv[i], "--p2") == 0) {
+            binary = 0;
+        }
+        else {
+            valid = 0;
+        }
+    }
+    if (!valid) {
+        printUsage(argv[0]);
+        STATS_FINISH();
+        return ERR_BAD_ARGUMENT;
+    }
+
+    // 2. 루RGB תɻҶȣ
+    GrayImage img, next;
+    memset(&next, 0, sizeof(GrayImage));
+    STATS_BEGIN(read_span, "read");
+    ErrorCode ret = readGray(input_path, &img, (LumaStandard)luma);
+    STATS_END(read_span, img.width * img.height);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        STATS_FINISH();
+        return ret;
+    }
+    printf("ȡɹ%dx%d أֵ%d\n", img.width, img.height, img.max_val);
+
+    // 3. ģ
+    if (radius >= 0) {
+        STATS_BEGIN(blur_span, "blur");
+        ret = grayBlur(&img, &next, radius);
+        STATS_END(blur_span, img.width * img.height);
+        if (ret == SUCCESS) {
+            freeGray(&img);
+            img = next;
+        }
+    }
+
+    // 4. Sobel
+    if (sobel && ret == SUCCESS) {
+        STATS_BEGIN(sobel_span, "sobel");
+        ret = graySobel(&img, &next);
+        STATS_END(sobel_span, img.width * img.height);
+        if (ret == SUCCESS) {
+            freeGray(&img);
+            img = next;
+        }
+    }
+
+    // 5. ֵ
+    if (threshold >= 0 && ret == SUCCESS) {
+        STATS_BEGIN(threshold_span, "threshold");
+        grayThreshold(&img, threshold);
+        STATS_END(threshold_span, img.width * img.height);
+    }
+
+    // 6. 
+    if (ret == SUCCESS) {
+        STATS_BEGIN(write_span, "write");
+        ret = writePGM(output_path, &img, binary);
+        STATS_END(write_span, img.width * img.height);
+    }
+    freeGray(&img);
+    if (ret != SUCCESS) {
+        printf("%s\n", error_messages[ret]);
+        STATS_FINISH();
+        return ret;
+    }
+    printf("ɹ%s\n", output_path);
+    STATS_FINISH();
+    return SUCCESS;
+}
\ No newline at end of file
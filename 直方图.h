@@ -0,0 +1,264 @@
+/**
+ * ֱͼ߳˽еֱͼͳƣϲԭӲOtsu Զֵ⻯ CLAHE
+ *
+ * ˽ֱͼÿ߳һݣhistPrivateAllocѭ histSlot ȡ߳Ƿֱۼӣ
+ * ѭ histMerge ӡҶȡRGBͨһ꣩ histPlanes ͳƣ
+ * ݶȷֵҪͬһģ÷Լѭͬ sobelԵ.c --otsu
+ * Otsuȡ䷽ֵ t[0, t) Ϊ[t, bins) Ϊǰ sobel  >= ֵ һ£
+ * ⻯ CLAHE ֻɲұһдأ
+ *   - ⻯ͼһűۼƷֲ쵽 0~ֵ
+ *   - CLAHEͼֳ tiles_x * tiles_y 飬ֱͼ clip ƽ߶ȽضĲ־̯
+ *      bins/ ĲΧϣһű
+ *     ÿΧ 4 ı֮˫Բֵ֮޽ӷ
+ * ÷
+ *   histPlanes(img.plane, 3, count, 256, hist);    // hist[c*256 + v]
+ *   int t = histOtsu(hist, 256);
+ *   histEqualizeLut(hist, 256, count, 255, lut);  histApplyLut(plane, count, lut);
+ *   histClahe(plane, width, height, 255, 8, 8, 2.0);
+ */
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//========== ߳˽ֱͼ ==========
+
+/**
+ * ÿ߳һݡȫ 0 ֱͼ
+ * @param slots
+ * @return NULL=ڴ治
+ */
+static inline long long* histPrivateAlloc(int bins, int* slots) {
+    *slots = 1;
+#ifdef _OPENMP
+    *slots = omp_get_max_threads();
+#endif
+    return (long long*)calloc((size_t)*slots * bins, sizeof(long long));
+}
+
+/**
+ * ǰ̵߳һ
+ */
+static inline long long* histSlot(long long* priv, int bins) {
+#ifdef _OPENMP
+    return priv + (size_t)omp_get_thread_num() * bins;
+#else
+    (void)bins;
+    return priv;
+#endif
+}
+
+/**
+ * ̵ֱ߳ͼӵ histԭݣ
+ */
+static inline void histMerge(const long long* priv, int slots, int bins, long long* hist) {
+    memset(hist, 0, sizeof(long long) * bins);
+    for (int s = 0; s < slots; s++) {
+        const long long* h = priv + (size_t)s * bins;
+        for (int i = 0; i < bins; i++) {
+            hist[i] += h[i];
+        }
+    }
+}
+
+/**
+ * ͳƽֱͼͨһꣻص [0, bins-1]
+ * @param hist channels*bins  c ͨ hist[c*bins] 
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int histPlanes(int* const* planes, int channels, size_t count, int bins, long long* hist) {
+    int slots;
+    int total = channels * bins;
+    long long* priv = histPrivateAlloc(total, &slots);
+    if (priv == NULL) {
+        return -1;
+    }
+    #pragma omp parallel for schedule(static)
+    for (long long i0 = 0; i0 < (long long)count; i0 += 4096) {
+        long long* h = histSlot(priv, total);
+        long long i1 = i0 + 4096 < (long long)count ? i0 + 4096 : (long long)count;
+        for (int c = 0; c < channels; c++) {
+            const int* p = planes[c];
+            long long* hc = h + (size_t)c * bins;
+            for (long long i = i0; i < i1; i++) {
+                int v = p[i] < 0 ? 0 : (p[i] < bins ? p[i] : bins - 1);
+                hc[v]++;
+            }
+        }
+    }
+    histMerge(priv, slots, total, hist);
+    free(priv);
+    return 0;
+}
+
+//========== Զֵ ==========
+
+/**
+ * Otsu ֵʹ [0, t)  [t, bins) ䷽
+ * @return t1 ~ bins-1ֻһȡֵʱظֵ + 1ȫΪ
+ */
+static inline int histOtsu(const long long* hist, int bins) {
+    double total = 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < bins; i++) {
+        total += (double)hist[i];
+        sum += (double)i * hist[i];
+    }
+    double w0 = 0.0;
+    double sum0 = 0.0;
+    double best = -1.0;
+    int best_t = 1;
+    int last = 0;
+    for (int t = 1; t < bins; t++) {
+        w0 += (double)hist[t - 1];
+        sum0 += (double)(t - 1) * hist[t - 1];
+        last = hist[t - 1] > 0 ? t - 1 : last;
+        double w1 = total - w0;
+        if (w0 == 0.0 || w1 == 0.0) {
+            continue;
+        }
+        double diff = sum0 / w0 - (sum - sum0) / w1;
+        double between = w0 * w1 * diff * diff;
+        if (between > best) {
+            best = between;
+            best_t = t;
+        }
+    }
+    if (best < 0.0) {
+        last = hist[bins - 1] > 0 ? bins - 1 : last;
+        return last + 1 < bins ? last + 1 : bins - 1;
+    }
+    return best_t;
+}
+
+//========== ұ ==========
+
+/**
+ * ⻯ұۼƷֲ죬ֵӳΪ 0ӳΪ max_val
+ * @param lut bins 
+ */
+static inline void histEqualizeLut(const long long* hist, int bins, long long count, int max_val, int* lut) {
+    long long cdf_min = 0;
+    for (int i = 0; i < bins && cdf_min == 0; i++) {
+        cdf_min = hist[i];
+    }
+    long long cdf = 0;
+    for (int i = 0; i < bins; i++) {
+        cdf += hist[i];
+        long long range = count - cdf_min;
+        lut[i] = range > 0 ? (int)(((cdf - cdf_min) * max_val + range / 2) / range) : i;
+        lut[i] = lut[i] < 0 ? 0 : lut[i];
+    }
+}
+
+/**
+ * дһƽ棨 0 ~ -1 ֮ڣ
+ */
+static inline void histApplyLut(int* plane, size_t count, const int* lut) {
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < (long long)count; i++) {
+        plane[i] = lut[plane[i]];
+    }
+}
+
+/**
+ * CLAHEƶԱȶȵķֿӦ⻯ԭأ
+ * @param max_valΪ 0 ~ max_val
+ * @param tiles_xtiles_yֿԲӦ߳
+ * @param clipض߶Ϊÿƽÿ clip >= 1ԽԱȶԽǿ
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int histClahe(int* plane, int width, int height, int max_val, int tiles_x, int tiles_y, double clip) {
+    if (tiles_x < 1 || tiles_y < 1 || tiles_x > width || tiles_y > height || clip < 1.0 || max_val < 1) {
+        return -1;
+    }
+    int bins = max_val + 1;
+    int tile_count = tiles_x * tiles_y;
+    int* luts = (int*)malloc(sizeof(int) * (size_t)tile_count * bins);
+    if (luts == NULL) {
+        return -1;
+    }
+
+    // 1. 鲢Уֱͼڵ̣߳Ȼ˽У-> ض̯ -> ұ
+    int failed = 0;
+    #pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+    for (int t = 0; t < tile_count; t++) {
+        long long* hist = (long long*)calloc(bins, sizeof(long long));
+        if (hist == NULL) {
+            failed = 1;
+            continue;
+        }
+        int tx = t % tiles_x;
+        int ty = t / tiles_x;
+        int x0 = (int)((long long)width * tx / tiles_x);
+        int x1 = (int)((long long)width * (tx + 1) / tiles_x);
+        int y0 = (int)((long long)height * ty / tiles_y);
+        int y1 = (int)((long long)height * (ty + 1) / tiles_y);
+        long long area = (long long)(x1 - x0) * (y1 - y0);
+        for (int y = y0; y < y1; y++) {
+            const int* row = plane + (size_t)y * width;
+            for (int x = x0; x < x1; x++) {
+                hist[row[x]]++;
+            }
+        }
+        long long limit = (long long)(clip * area / bins);
+        limit = limit > 1 ? limit : 1;
+        long long excess = 0;
+        for (int i = 0; i < bins; i++) {
+            if (hist[i] > limit) {
+                excess += hist[i] - limit;
+                hist[i] = limit;
+            }
+        }
+        //  rest  bins/rest Ĳ i  1 ҽ (i+1)*rest/bins  i*rest/bins 󣩣
+        // ȫͶ˵ĸӣ16 λʱ area/bins  1excess ȫڵͶֱӽֵ
+        long long share = excess / bins;
+        long long rest = excess % bins;
+        int* lut = luts + (size_t)t * bins;
+        long long cdf = 0;
+        for (int i = 0; i < bins; i++) {
+            long long extra = (i + 1) * rest / bins - i * rest / bins;
+            cdf += hist[i] + share + extra;
+            lut[i] = (int)((cdf * max_val + area / 2) / area);
+        }
+        free(hist);
+    }
+    if (failed) {
+        free(luts);
+        return -1;
+    }
+
+    // 2. ÿΧ 4 Ĳұ֮˫ԲֵΪֵڵ㣩
+    double tile_w = (double)width / tiles_x;
+    double tile_h = (double)height / tiles_y;
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        double fy = (y + 0.5) / tile_h - 0.5;
+        int ty0 = fy < 0.0 ? 0 : (int)fy;
+        ty0 = ty0 < tiles_y - 1 ? ty0 : tiles_y - 1;
+        int ty1 = ty0 + 1 < tiles_y ? ty0 + 1 : ty0;
+        double ay = fy - ty0;
+        ay = ay < 0.0 ? 0.0 : (ay > 1.0 ? 1.0 : ay);
+        int* row = plane + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            double fx = (x + 0.5) / tile_w - 0.5;
+            int tx0 = fx < 0.0 ? 0 : (int)fx;
+            tx0 = tx0 < tiles_x - 1 ? tx0 : tiles_x - 1;
+            int tx1 = tx0 + 1 < tiles_x ? tx0 + 1 : tx0;
+            double ax = fx - tx0;
+            ax = ax < 0.0 ? 0.0 : (ax > 1.0 ? 1.0 : ax);
+            int v = row[x];
+            double top = (1.0 - ax) * luts[((size_t)ty0 * tiles_x + tx0) * bins + v] + ax * luts[((size_t)ty0 * tiles_x + tx1) * bins + v];
+            double bottom = (1.0 - ax) * luts[((size_t)ty1 * tiles_x + tx0) * bins + v] + ax * luts[((size_t)ty1 * tiles_x + tx1) * bins + v];
+            row[x] = (int)((1.0 - ay) * top + ay * bottom + 0.5);
+        }
+    }
+    free(luts);
+    return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,201 @@
+/**
+ * ͼsummed-area tableεĺ͡ƽ O(1) ѯʽģֲֵ/ֵÿش봰ڴС޹
+ *
+ * sum Ϊ (width+1)*(height+1)  64 λsum[y][x] Ϊ x*y ֮ͣ 0 С 0 Ϊ 0
+ * ͼ 65535  16 λأ͡ƽҲ
+ * һɣۼǰ׺ͣټһеıֵ˳ʡ
+ * ̣߳-fopenmpʱдУ
+ *   1. дڵһеϷȫΪ 0
+ *   2. ˳ذÿдһвǰһһеֵÿֻһУ
+ *   3. двмǰһһ
+ * ÷
+ *   IntegralImage ii;
+ *   integralBuild(&ii, plane, width, height, 1);        // 1=ͬʱƽͱ
+ *   long long s = integralSum(&ii, x0, y0, x1, y1);     // [x0, x1) x [y0, y1)
+ *   integralFree(&ii);
+ */
+#ifndef INTEGRAL_IMAGE_H
+#define INTEGRAL_IMAGE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define INTEGRAL_BAND_ROWS 64  // нʱÿд
+
+typedef struct {
+    int width;
+    int height;
+    long long* sum;  // (width+1)*(height+1)
+    long long* sq;   // ƽͱͬϣδʱΪ NULL
+} IntegralImage;
+
+static inline void integralFree(IntegralImage* ii) {
+    free(ii->sum);
+    free(ii->sq);
+    ii->sum = NULL;
+    ii->sq = NULL;
+}
+
+/**
+ *  [first, last) еıfirst еһе 0
+ */
+static inline void integralBuildRows(IntegralImage* ii, const int* src, int first, int last) {
+    size_t stride = (size_t)ii->width + 1;
+    for (int y = first; y < last; y++) {
+        const int* in = src + (size_t)y * ii->width;
+        long long* row = ii->sum + (y + 1) * stride;
+        const long long* up = y == first ? NULL : row - stride;
+        long long* sq_row = ii->sq != NULL ? ii->sq + (y + 1) * stride : NULL;
+        long long run = 0;
+        long long sq_run = 0;
+        row[0] = 0;
+        for (int x = 0; x < ii->width; x++) {
+            run += in[x];
+            row[x + 1] = up != NULL ? up[x + 1] + run : run;
+        }
+        if (sq_row != NULL) {
+            const long long* sq_up = y == first ? NULL : sq_row - stride;
+            sq_row[0] = 0;
+            for (int x = 0; x < ii->width; x++) {
+                sq_run += (long long)in[x] * in[x];
+                sq_row[x + 1] = sq_up != NULL ? sq_up[x + 1] + sq_run : sq_run;
+            }
+        }
+    }
+}
+
+// row[x] += carry[x]
+static inline void integralAddRow(long long* row, const long long* carry, int n) {
+    for (int x = 0; x < n; x++) {
+        row[x] += carry[x];
+    }
+}
+
+/**
+ * ͼ
+ * @param srcwidth*height ƽ
+ * @param with_squares1=ͬʱƽͱֲã
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int integralBuild(IntegralImage* ii, const int* src, int width, int height, int with_squares) {
+    ii->width = width;
+    ii->height = height;
+    size_t stride = (size_t)width + 1;
+    size_t total = stride * ((size_t)height + 1);
+    ii->sum = (long long*)malloc(sizeof(long long) * total);
+    ii->sq = with_squares ? (long long*)malloc(sizeof(long long) * total) : NULL;
+    if (ii->sum == NULL || (with_squares && ii->sq == NULL)) {
+        integralFree(ii);
+        return -1;
+    }
+    memset(ii->sum, 0, sizeof(long long) * stride);
+    if (ii->sq != NULL) {
+        memset(ii->sq, 0, sizeof(long long) * stride);
+    }
+    int bands = (height + INTEGRAL_BAND_ROWS - 1) / INTEGRAL_BAND_ROWS;
+
+    // 1. д
+    #pragma omp parallel for schedule(static)
+    for (int b = 0; b < bands; b++) {
+        int first = b * INTEGRAL_BAND_ROWS;
+        int last = first + INTEGRAL_BAND_ROWS < height ? first + INTEGRAL_BAND_ROWS : height;
+        integralBuildRows(ii, src, first, last);
+    }
+
+    // 2. ˳ÿдһУе last У
+    for (int b = 1; b < bands; b++) {
+        int first = b * INTEGRAL_BAND_ROWS;
+        int last = first + INTEGRAL_BAND_ROWS < height ? first + INTEGRAL_BAND_ROWS : height;
+        integralAddRow(ii->sum + last * stride, ii->sum + first * stride, width + 1);
+        if (ii->sq != NULL) {
+            integralAddRow(ii->sq + last * stride, ii->sq + first * stride, width + 1);
+        }
+    }
+
+    // 3. мǰһһ
+    #pragma omp parallel for schedule(static)
+    for (int b = 1; b < bands; b++) {
+        int first = b * INTEGRAL_BAND_ROWS;
+        int last = first + INTEGRAL_BAND_ROWS < height ? first + INTEGRAL_BAND_ROWS : height;
+        for (int y = first + 1; y < last; y++) {
+            integralAddRow(ii->sum + y * stride, ii->sum + first * stride, width + 1);
+            if (ii->sq != NULL) {
+                integralAddRow(ii->sq + y * stride, ii->sq + first * stride, width + 1);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ *  [x0, x1) x [y0, y1) ĺͣ 0~width0~height ڣ
+ */
+static inline long long integralSum(const IntegralImage* ii, int x0, int y0, int x1, int y1) {
+    size_t stride = (size_t)ii->width + 1;
+    const long long* top = ii->sum + y0 * stride;
+    const long long* bottom = ii->sum + y1 * stride;
+    return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+}
+
+/**
+ *  [x0, x1) x [y0, y1) ƽͣ轨ƽͱ
+ */
+static inline long long integralSqSum(const IntegralImage* ii, int x0, int y0, int x1, int y1) {
+    size_t stride = (size_t)ii->width + 1;
+    const long long* top = ii->sq + y0 * stride;
+    const long long* bottom = ii->sq + y1 * stride;
+    return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+}
+
+/**
+ * ʽģÿȡΪġ߳ 2*radius+1 Ĵͼڲֵƽֵ룩
+ * @param dstwidth*height 
+ */
+static inline void integralBoxFilter(const IntegralImage* ii, int* dst, int radius) {
+    int width = ii->width;
+    int height = ii->height;
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        int y0 = y - radius > 0 ? y - radius : 0;
+        int y1 = y + radius + 1 < height ? y + radius + 1 : height;
+        int* out = dst + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int x0 = x - radius > 0 ? x - radius : 0;
+            int x1 = x + radius + 1 < width ? x + radius + 1 : width;
+            long long area = (long long)(x1 - x0) * (y1 - y0);
+            out[x] = (int)((integralSum(ii, x0, y0, x1, y1) + area / 2) / area);
+        }
+    }
+}
+
+/**
+ * ֲֵ/ֵNiblackֵڴ ֵ + k * ׼ ҲС floor ʱΪ highΪ 0
+ * ͬ integralBoxFilterii  src Һƽͱ
+ * @param dstwidth*height  src ͬ
+ */
+static inline void integralLocalThreshold(const IntegralImage* ii, const int* src, int* dst, int radius, double k, int floor_value, int high) {
+    int width = ii->width;
+    int height = ii->height;
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        int y0 = y - radius > 0 ? y - radius : 0;
+        int y1 = y + radius + 1 < height ? y + radius + 1 : height;
+        const int* in = src + (size_t)y * width;
+        int* out = dst + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int x0 = x - radius > 0 ? x - radius : 0;
+            int x1 = x + radius + 1 < width ? x + radius + 1 : width;
+            double area = (double)(x1 - x0) * (y1 - y0);
+            double mean = integralSum(ii, x0, y0, x1, y1) / area;
+            double var = integralSqSum(ii, x0, y0, x1, y1) / area - mean * mean;
+            double limit = mean + k * sqrt(var > 0 ? var : 0);
+            out[x] = (in[x] > limit && in[x] >= floor_value) ? high : 0;
+        }
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,349 @@
+/**
+ * 棺ļݡûʱֱȡϴεļȡ//д
+ *
+ * ʱʱκιϣļ RESULT_CACHE_INIT ȡߣ
+ *   --cache DIR          Ŀ¼ʱ
+ *   --cache-size MB      ܴСޣĬ 512ʱδ̭
+ * ÷
+ *   ResultKey key;
+ *   resultKeyInit(&key, "sobel");
+ *   resultKeyAddFile(&key, input_path);           // ļȫֽ
+ *   resultKeyAddInt(&key, "threshold", 50);       // ÿӰĲ
+ *   if (resultCacheFetch(&key, output_path)) { ... Уд ... }
+ *   ... д ...
+ *   resultCacheStore(&key, output_path);
+ * Ŀ¼ index.txt ¼ۼ/δĿĴСʹţÿдӡ
+ */
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// ںʵָıʱ 1ʹɵĻȫʧЧ
+#define RESULT_CACHE_VERSION 2
+#define RESULT_CACHE_MAX_ENTRIES 4096
+
+typedef struct {
+    unsigned long long hash;
+    unsigned long long length;  // ϣֽ
+} ResultKey;
+
+typedef struct {
+    unsigned long long key;
+    double size;
+    unsigned long long last_used;
+} ResultEntry;
+
+static struct {
+    const char* dir;
+    double max_bytes;
+} g_result_cache;
+
+/**
+ * ȡ --cache DIR / --cache-size MB 
+ */
+static inline void resultCacheInit(int* argc, char* argv[]) {
+    g_result_cache.dir = NULL;
+    g_result_cache.max_bytes = 512.0 * 1024 * 1024;
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--cache") == 0 && i + 1 < *argc) {
+            g_result_cache.dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < *argc) {
+            g_result_cache.max_bytes = atof(argv[++i]) * 1024 * 1024;
+        }
+        else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+    if (g_result_cache.dir != NULL) {
+#ifdef _WIN32
+        _mkdir(g_result_cache.dir);
+#else
+        mkdir(g_result_cache.dir, 0755);
+#endif
+    }
+}
+
+//========== ϣÿδ 8 ֽڵĳ˷-λϣ ==========
+
+static inline unsigned long long resultHashMix(unsigned long long h, unsigned long long v) {
+    v *= 0x9E3779B97F4A7C15ULL;
+    v ^= v >> 29;
+    h = (h ^ v) * 0xBF58476D1CE4E5B9ULL;
+    return h ^ (h >> 32);
+}
+
+static inline void resultKeyAddBytes(ResultKey* key, const unsigned char* data, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        unsigned long long v;
+        memcpy(&v, data + i, 8);
+        key->hash = resultHashMix(key->hash, v);
+    }
+    unsigned long long tail = 0;
+    for (size_t j = 0; i + j < n; j++) {
+        tail |= (unsigned long long)data[i + j] << (8 * j);
+    }
+    key->hash = resultHashMix(key->hash, tail ^ ((unsigned long long)(n - i) << 56));
+    key->length += n;
+}
+
+static inline void resultKeyAddString(ResultKey* key, const char* s) {
+    resultKeyAddBytes(key, (const unsigned char*)s, strlen(s) + 1);
+}
+
+/**
+ * ʼһ + 汾
+ */
+static inline void resultKeyInit(ResultKey* key, const char* op) {
+    key->hash = 0x243F6A8885A308D3ULL;
+    key->length = 0;
+    if (g_result_cache.dir == NULL) {
+        return;
+    }
+    resultKeyAddString(key, op);
+    key->hash = resultHashMix(key->hash, RESULT_CACHE_VERSION);
+}
+
+/**
+ * һⲻͬײ
+ */
+static inline void resultKeyAddInt(ResultKey* key, const char* name, long long value) {
+    if (g_result_cache.dir == NULL) {
+        return;
+    }
+    resultKeyAddString(key, name);
+    key->hash = resultHashMix(key->hash, (unsigned long long)value);
+}
+
+/**
+ * ļȫֽڣļʱֻļĶȡᱨ
+ */
+static inline void resultKeyAddFile(ResultKey* key, const char* path) {
+    if (g_result_cache.dir == NULL) {
+        return;
+    }
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        resultKeyAddString(key, path);
+        return;
+    }
+    unsigned char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) {
+        resultKeyAddBytes(key, buf, n);
+    }
+    fclose(file);
+    key->hash = resultHashMix(key->hash, key->length);
+}
+
+//========== ļ ==========
+
+static inline void resultEntryPath(unsigned long long key, char* path, size_t size) {
+    snprintf(path, size, "%s/%016llx.bin", g_result_cache.dir, key);
+}
+
+/**
+ * һΪۼ/δУ֮ÿһĿ
+ * @return Ŀ
+ */
+static inline int resultReadIndex(ResultEntry* entries, unsigned long long* hits, unsigned long long* misses) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/index.txt", g_result_cache.dir);
+    *hits = 0;
+    *misses = 0;
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    int count = 0;
+    if (fscanf(file, "%llu %llu", hits, misses) == 2) {
+        while (count < RESULT_CACHE_MAX_ENTRIES &&
+            fscanf(file, "%llx %lf %llu", &entries[count].key, &entries[count].size, &entries[count].last_used) == 3) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static inline void resultWriteIndex(const ResultEntry* entries, int count, unsigned long long hits, unsigned long long misses) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/index.txt", g_result_cache.dir);
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return;
+    }
+    fprintf(file, "%llu %llu\n", hits, misses);
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%016llx %.0f %llu\n", entries[i].key, entries[i].size, entries[i].last_used);
+    }
+    fclose(file);
+}
+
+/**
+ * ļ
+ * @return Ƶֽʧܷ -1
+ */
+static inline double resultCopyFile(const char* from, const char* to) {
+    FILE* in = fopen(from, "rb");
+    if (in == NULL) {
+        return -1;
+    }
+    FILE* out = fopen(to, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return -1;
+    }
+    unsigned char buf[1 << 16];
+    size_t n;
+    double total = 0;
+    int failed = 0;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        if (fwrite(buf, 1, n, out) != n) {
+            failed = 1;
+            break;
+        }
+        total += n;
+    }
+    fclose(in);
+    failed |= fclose(out) != 0;
+    return failed ? -1 : total;
+}
+
+static inline void resultPrintRatio(unsigned long long hits, unsigned long long misses) {
+    unsigned long long total = hits + misses;
+    printf("棺 %llu Σδ %llu Σ %.1f%%\n",
+        hits, misses, total > 0 ? 100.0 * hits / total : 0.0);
+}
+
+static inline unsigned long long resultNextUse(const ResultEntry* entries, int count) {
+    unsigned long long next = 0;
+    for (int i = 0; i < count; i++) {
+        if (entries[i].last_used > next) {
+            next = entries[i].last_used;
+        }
+    }
+    return next + 1;
+}
+
+/**
+ * 黺棬ʱѻĽƵ·
+ * @return 1=Удã0=δлδ
+ */
+static inline int resultCacheFetch(const ResultKey* key, const char* output_path) {
+    if (g_result_cache.dir == NULL) {
+        return 0;
+    }
+    static ResultEntry entries[RESULT_CACHE_MAX_ENTRIES];
+    unsigned long long hits, misses;
+    int count = resultReadIndex(entries, &hits, &misses);
+    int hit = 0;
+    for (int i = 0; i < count; i++) {
+        if (entries[i].key == key->hash) {
+            char path[512];
+            resultEntryPath(key->hash, path, sizeof(path));
+            if (resultCopyFile(path, output_path) == entries[i].size) {
+                entries[i].last_used = resultNextUse(entries, count);
+                hit = 1;
+            }
+            else {
+                entries[i] = entries[--count];  // ļʧ𻵣δ
+            }
+            break;
+        }
+    }
+    if (hit) {
+        hits++;
+        resultPrintRatio(hits, misses);
+    }
+    else {
+        misses++;
+    }
+    resultWriteIndex(entries, count, hits, misses);
+    return hit;
+}
+
+/**
+ * ѸдĽ뻺棬ܴСʱ̭δõĿ
+ */
+static inline void resultCacheStore(const ResultKey* key, const char* output_path) {
+    if (g_result_cache.dir == NULL) {
+        return;
+    }
+    static ResultEntry entries[RESULT_CACHE_MAX_ENTRIES];
+    unsigned long long hits, misses;
+    int count = resultReadIndex(entries, &hits, &misses);
+    char path[512];
+    resultEntryPath(key->hash, path, sizeof(path));
+    double size = resultCopyFile(output_path, path);
+    if (size < 0 || size > g_result_cache.max_bytes) {
+        remove(path);
+        resultPrintRatio(hits, misses);
+        return;
+    }
+
+    int found = -1;
+    for (int i = 0; i < count; i++) {
+        if (entries[i].key == key->hash) {
+            found = i;
+        }
+    }
+    if (found < 0) {
+        if (count == RESULT_CACHE_MAX_ENTRIES) {
+            // Ŀޣڳδõһ
+            int oldest = 0;
+            for (int i = 1; i < count; i++) {
+                if (entries[i].last_used < entries[oldest].last_used) {
+                    oldest = i;
+                }
+            }
+            char old_path[512];
+            resultEntryPath(entries[oldest].key, old_path, sizeof(old_path));
+            remove(old_path);
+            entries[oldest] = entries[--count];
+        }
+        found = count++;
+    }
+    entries[found].key = key->hash;
+    entries[found].size = size;
+    entries[found].last_used = resultNextUse(entries, count);
+
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        total += entries[i].size;
+    }
+    while (total > g_result_cache.max_bytes && count > 1) {
+        int oldest = -1;
+        for (int i = 0; i < count; i++) {
+            if (i != found && (oldest < 0 || entries[i].last_used < entries[oldest].last_used)) {
+                oldest = i;
+            }
+        }
+        char old_path[512];
+        resultEntryPath(entries[oldest].key, old_path, sizeof(old_path));
+        remove(old_path);
+        total -= entries[oldest].size;
+        entries[oldest] = entries[--count];
+        if (found == count) {
+            found = oldest;
+        }
+    }
+    resultWriteIndex(entries, count, hits, misses);
+    resultPrintRatio(hits, misses);
+}
+
+#define RESULT_CACHE_INIT(argc, argv) resultCacheInit(&(argc), (argv))
+
+#endif
\ No newline at end of file
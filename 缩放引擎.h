@@ -0,0 +1,326 @@
+/**
+ * 棺ʽƽ˫ԡ˫Σa=-0.5Lanczos3 ز
+ *
+ * Ⱥһάزÿ resizeAxisInit ʱΪÿλ붨ϵ
+ * ϵ֮ǡΪ 1<<RESIZE_BITSÿλõϵͬĲ 0ţڲѭ̶
+ *   ÿض taps ˼ӣRGB ͨͬһۼӣֻһ
+ *        ϵ㡢x ڲдҪ start  gatherʵ 2 ϣ
+ *   ÿϵӦһУ˼
+ * ÿ룬һٽص 0~ֵأĹ
+ * ͼⲻȡֵԵֻͼڵ¹һ
+ * С reduce_gap*2 ķȰ f ʽƽf = С / reduce_gap
+ * ٶʣ² 2*reduce_gap Ĳ˲Сʱԭͼȡ˲޹ء
+ * ǰͨе int Pixel{int r, g, b} 鰴 int 顢channels=3 뼴ɣ
+ *  65535 ʱۼӣĹ壩 32 λ
+ * ÷
+ *   resizeImage((const int*)in.data, in.width, in.height, (int*)out.data, 640, 480, 3, 255, RESIZE_LANCZOS3, 2);
+ */
+#ifndef RESIZE_ENGINE_H
+#define RESIZE_ENGINE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RESIZE_BITS 14  // ϵĶλ
+
+typedef enum {
+    RESIZE_BOX = 0,   // ƽ
+    RESIZE_BILINEAR,  // 
+    RESIZE_BICUBIC,   // Keys ξa = -0.5
+    RESIZE_LANCZOS3   // sinc(x) * sinc(x/3)
+} ResizeFilter;
+
+/**
+ * ȡ˲box / bilinear / bicubic / lanczos
+ * @return ˲ֲʶʱ -1
+ */
+static inline int resizeFilterByName(const char* name) {
+    const char* names[] = { "box", "bilinear", "bicubic", "lanczos" };
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ˲ԭ߶µİ
+static inline double resizeSupport(ResizeFilter filter) {
+    const double support[] = { 0.5, 1.0, 2.0, 3.0 };
+    return support[filter];
+}
+
+static inline double resizeSinc(double x) {
+    const double pi = 3.14159265358979323846;
+    if (x == 0.0) {
+        return 1.0;
+    }
+    return sin(pi * x) / (pi * x);
+}
+
+static inline double resizeWeight(ResizeFilter filter, double x) {
+    double a = fabs(x);
+    switch (filter) {
+    case RESIZE_BOX:
+        return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+    case RESIZE_BILINEAR:
+        return a < 1.0 ? 1.0 - a : 0.0;
+    case RESIZE_BICUBIC:
+        if (a < 1.0) {
+            return (1.5 * a - 2.5) * a * a + 1.0;
+        }
+        return a < 2.0 ? ((-0.5 * a + 2.5) * a - 4.0) * a + 2.0 : 0.0;
+    default:
+        return a < 3.0 ? resizeSinc(a) * resizeSinc(a / 3.0) : 0.0;
+    }
+}
+
+// һϵ
+typedef struct {
+    int in_size;
+    int out_size;
+    int taps;      // ÿλõϵ
+    int* start;    // ÿλõĵһout_size start + taps  in_size
+    int* weights;  // out_size*taps i λõϵţweights[i * taps + k]
+} ResizeAxis;
+
+static inline void resizeAxisFree(ResizeAxis* a) {
+    free(a->start);
+    free(a->weights);
+    a->start = NULL;
+    a->weights = NULL;
+}
+
+/**
+ *  in_size -> out_size ϵСʱ˲չ
+ * @return 0=ɹ-1=ߴ粻Ϸڴ治
+ */
+static inline int resizeAxisInit(ResizeAxis* a, int in_size, int out_size, ResizeFilter filter) {
+    a->in_size = in_size;
+    a->out_size = out_size;
+    a->start = NULL;
+    a->weights = NULL;
+    if (in_size < 1 || out_size < 1) {
+        return -1;
+    }
+    double scale = (double)in_size / out_size;
+    double filter_scale = scale > 1.0 ? scale : 1.0;
+    double support = resizeSupport(filter) * filter_scale;
+    int taps = (int)ceil(support) * 2 + 1;
+    a->taps = taps < in_size ? taps : in_size;
+    a->start = (int*)malloc(sizeof(int) * out_size);
+    a->weights = (int*)calloc((size_t)a->taps * out_size, sizeof(int));
+    double* w = (double*)malloc(sizeof(double) * taps);
+    if (a->start == NULL || a->weights == NULL || w == NULL) {
+        free(w);
+        resizeAxisFree(a);
+        return -1;
+    }
+    for (int i = 0; i < out_size; i++) {
+        double center = (i + 0.5) * scale;
+        int lo = (int)floor(center - support + 0.5);
+        int hi = (int)floor(center + support + 0.5);
+        lo = lo > 0 ? lo : 0;
+        hi = hi < in_size ? hi : in_size;
+        int count = hi - lo < taps ? hi - lo : taps;
+        double total = 0.0;
+        for (int k = 0; k < count; k++) {
+            w[k] = resizeWeight(filter, (lo + k + 0.5 - center) / filter_scale);
+            total += w[k];
+        }
+        // Ƶ start + taps Խ磬ϵӦ
+        int start = lo + a->taps <= in_size ? lo : in_size - a->taps;
+        int offset = lo - start;
+        int sum = 0;
+        int largest = offset;
+        for (int k = 0; k < count && offset + k < a->taps; k++) {
+            int q = (int)floor(w[k] / total * (1 << RESIZE_BITS) + 0.5);
+            a->weights[(size_t)i * a->taps + offset + k] = q;
+            sum += q;
+            if (q > a->weights[(size_t)i * a->taps + largest]) {
+                largest = offset + k;
+            }
+        }
+        // ϵϣ֤ϵǡΪ 1<<RESIZE_BITSƽ̹ź󲻱䣩
+        a->weights[(size_t)i * a->taps + largest] += (1 << RESIZE_BITS) - sum;
+        a->start[i] = start;
+    }
+    free(w);
+    return 0;
+}
+
+// 룻max_val >= 0 ʱٽص 0~max_val
+static inline int resizeClamp(int acc, int max_val) {
+    int v = (acc + (1 << (RESIZE_BITS - 1))) >> RESIZE_BITS;
+    if (max_val < 0) {
+        return v;
+    }
+    return v < 0 ? 0 : (v > max_val ? max_val : v);
+}
+
+/**
+ * زһ
+ * @param ina->in_size أÿ channels 
+ * @param outa->out_size 
+ * @param max_val-1=ضϣ滹һ飩
+ */
+static inline void resizeRow(const ResizeAxis* a, const int* in, int* out, int channels, int max_val) {
+    int taps = a->taps;
+    for (int i = 0; i < a->out_size; i++) {
+        const int* w = a->weights + (size_t)i * taps;
+        const int* s = in + (size_t)a->start[i] * channels;
+        if (channels == 3) {
+            int r = 0, g = 0, b = 0;
+            for (int k = 0; k < taps; k++) {
+                r += w[k] * s[3 * k];
+                g += w[k] * s[3 * k + 1];
+                b += w[k] * s[3 * k + 2];
+            }
+            out[3 * i] = resizeClamp(r, max_val);
+            out[3 * i + 1] = resizeClamp(g, max_val);
+            out[3 * i + 2] = resizeClamp(b, max_val);
+            continue;
+        }
+        for (int c = 0; c < channels; c++) {
+            int v = 0;
+            #pragma omp simd reduction(+:v)
+            for (int k = 0; k < taps; k++) {
+                v += w[k] * s[k * channels + c];
+            }
+            out[i * channels + c] = resizeClamp(v, max_val);
+        }
+    }
+}
+
+/**
+ * ز y Уrows Ϊÿ len 
+ */
+static inline void resizeColumn(const ResizeAxis* a, const int* rows, int* out, int y, size_t len, int max_val, int* acc) {
+    memset(acc, 0, sizeof(int) * len);
+    for (int k = 0; k < a->taps; k++) {
+        int w = a->weights[(size_t)y * a->taps + k];
+        const int* s = rows + (size_t)(a->start[y] + k) * len;
+        if (w == 0) {
+            continue;
+        }
+        #pragma omp simd
+        for (size_t i = 0; i < len; i++) {
+            acc[i] += w * s[i];
+        }
+    }
+    for (size_t i = 0; i < len; i++) {
+        out[i] = resizeClamp(acc[i], max_val);
+    }
+}
+
+/**
+ * ʽСÿ fx*fy ȡƽ룩ҡ±߲һİʵƽ
+ * @param outceil(width/fx) * ceil(height/fy) 
+ */
+static inline void resizeReduce(const int* in, int width, int height, int* out, int fx, int fy, int channels) {
+    int out_width = (width + fx - 1) / fx;
+    int out_height = (height + fy - 1) / fy;
+    int row_len = out_width * channels;
+    for (int y = 0; y < out_height; y++) {
+        int y0 = y * fy;
+        int y1 = y0 + fy < height ? y0 + fy : height;
+        int* dst = out + (size_t)y * row_len;
+        memset(dst, 0, sizeof(int) * row_len);
+        // Ȱ fy мٰ fx ϲ
+        for (int yy = y0; yy < y1; yy++) {
+            const int* src = in + (size_t)yy * width * channels;
+            for (int x = 0; x < out_width; x++) {
+                int x0 = x * fx;
+                int x1 = x0 + fx < width ? x0 + fx : width;
+                for (int c = 0; c < channels; c++) {
+                    int sum = 0;
+                    for (int xx = x0; xx < x1; xx++) {
+                        sum += src[xx * channels + c];
+                    }
+                    dst[x * channels + c] += sum;
+                }
+            }
+        }
+        for (int x = 0; x < out_width; x++) {
+            int x0 = x * fx;
+            int area = ((x0 + fx < width ? x0 + fx : width) - x0) * (y1 - y0);
+            for (int c = 0; c < channels; c++) {
+                dst[x * channels + c] = (dst[x * channels + c] + area / 2) / area;
+            }
+        }
+    }
+}
+
+/**
+ * ţߴ綼ʱֱӸƣ
+ * @param inwidth*height أÿ channels 
+ * @param outout_width*out_height أǰ䣩
+ * @param max_valֵ 65535
+ * @param reduce_gap>0 ʱС 2*reduce_gap ķʽС0=ʼֻ˲
+ * @return 0=ɹ-1=ߴ粻Ϸڴ治
+ */
+static inline int resizeImage(const int* in, int width, int height, int* out, int out_width, int out_height,
+    int channels, int max_val, ResizeFilter filter, int reduce_gap) {
+    if (width < 1 || height < 1 || out_width < 1 || out_height < 1) {
+        return -1;
+    }
+    // 1. СķȺʽС
+    int fx = reduce_gap > 0 ? width / out_width / reduce_gap : 1;
+    int fy = reduce_gap > 0 ? height / out_height / reduce_gap : 1;
+    int* reduced = NULL;
+    if (fx >= 2 || fy >= 2) {
+        fx = fx > 1 ? fx : 1;
+        fy = fy > 1 ? fy : 1;
+        int rw = (width + fx - 1) / fx;
+        int rh = (height + fy - 1) / fy;
+        reduced = (int*)malloc(sizeof(int) * rw * rh * channels);
+        if (reduced == NULL) {
+            return -1;
+        }
+        resizeReduce(in, width, height, reduced, fx, fy, channels);
+        in = reduced;
+        width = rw;
+        height = rh;
+    }
+
+    // 2. ÿŵ out_width򲻱ʱֱд
+    size_t row_len = (size_t)out_width * channels;
+    const int* rows = in;
+    int* rows_buf = NULL;
+    int* acc = NULL;  // ۼӵһ
+    ResizeAxis ax, ay;
+    ax.start = ay.start = NULL;
+    ax.weights = ay.weights = NULL;
+    int failed = 0;
+    if (out_width != width) {
+        rows_buf = out_height != height ? (int*)malloc(sizeof(int) * row_len * height) : out;
+        rows = rows_buf;
+        failed = rows == NULL || resizeAxisInit(&ax, width, out_width, filter) != 0;
+        for (int y = 0; y < height && !failed; y++) {
+            resizeRow(&ax, in + (size_t)y * width * channels, rows_buf + (size_t)y * row_len, channels, out_height != height ? -1 : max_val);
+        }
+    }
+
+    // 3. ɺ
+    if (!failed && out_height != height) {
+        acc = (int*)malloc(sizeof(int) * row_len);
+        failed = acc == NULL || resizeAxisInit(&ay, height, out_height, filter) != 0;
+        for (int y = 0; y < out_height && !failed; y++) {
+            resizeColumn(&ay, rows, out + (size_t)y * row_len, y, row_len, max_val, acc);
+        }
+    }
+    else if (!failed && out_width == width) {
+        memcpy(out, in, sizeof(int) * row_len * height);
+    }
+    resizeAxisFree(&ax);
+    resizeAxisFree(&ay);
+    free(acc);
+    if (rows_buf != out) {
+        free(rows_buf);
+    }
+    free(reduced);
+    return failed ? -1 : 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+/**
+ * ɫתϵĻҶȣƽ / BT.601 / BT.709RGB<->YCbCrRGB<->HSV
+ *
+ * ǰ RGB е int Pixel{int r, g, b} 鰴 int 鴫뼴ɣ
+ * Ҷ YCbCr ѭûз֧ɱ SIMD չgcc Ҫ -O3 -O2 -ftree-vectorize
+ * x86 ټ -mavx2  -march=nativeSSE2 û 32 λ˷ֻ RGB->YCbCr 
+ *  -fopenmp / -fopenmp-simd ʱ omp simd ʾҲЧAVX2 »ҶȻֻһĺʱ൱
+ * HSV Ҫط֧Ϊʵ֡
+ * ҶȽȨضʽľȷضϣ
+ *   ƽ  (r+g+b)/3
+ *   BT.601 (299r+587g+114b)/1000
+ *   BT.709 (2126r+7152g+722b)/10000
+ * ԭ rgbToGray  double ںǡΪʱ 1Լ 0.02% 룩û
+ */
+#ifndef COLOR_CONVERT_H
+#define COLOR_CONVERT_H
+
+#include <stddef.h>
+
+typedef enum {
+    LUMA_AVERAGE = 0,  // (r+g+b)/3ҶȻ.c ԭĹʽ
+    LUMA_BT601,        // 0.299 0.587 0.114sobelԵ.c ԭĹʽ
+    LUMA_BT709         // 0.2126 0.7152 0.0722
+} LumaStandard;
+
+/**
+ * ȡҶȱ׼average / bt601 / bt709
+ * @return ׼ֲʶʱ -1
+ */
+static inline int lumaStandardByName(const char* name) {
+    const char* names[] = { "average", "bt601", "bt709" };
+    for (int i = 0; i < 3; i++) {
+        const char* a = names[i];
+        const char* b = name;
+        while (*a != '\0' && *a == *b) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//========== Ҷ ==========
+
+/**
+ * 8 λ0~255תҶȣ/3  /1000  32 λڵĳ˷λԸ÷Χڵ뾫ȷ
+ *   /3     = *683 >> 11           Ͳ 765
+ *   /1000  = (>>3) *33555 >> 22   Ͳ 255000
+ * /10000  32 λûоȷĳ˷λʽ
+ */
+static inline void colorToGray(const int* rgb, unsigned char* gray, size_t count, LumaStandard standard) {
+    if (standard == LUMA_AVERAGE) {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(rgb[3 * i] + rgb[3 * i + 1] + rgb[3 * i + 2]);
+            gray[i] = (unsigned char)((sum * 683u) >> 11);
+        }
+    }
+    else if (standard == LUMA_BT601) {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(299 * rgb[3 * i] + 587 * rgb[3 * i + 1] + 114 * rgb[3 * i + 2]);
+            gray[i] = (unsigned char)(((sum >> 3) * 33555u) >> 22);
+        }
+    }
+    else {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(2126 * rgb[3 * i] + 7152 * rgb[3 * i + 1] + 722 * rgb[3 * i + 2]);
+            gray[i] = (unsigned char)(sum / 10000u);
+        }
+    }
+}
+
+/**
+ * ͬ colorToGrayΪ RGB еֽڣֿ鴦.c Ƭ壩
+ */
+static inline void colorBytesToGray(const unsigned char* rgb, unsigned char* gray, size_t count, LumaStandard standard) {
+    if (standard == LUMA_AVERAGE) {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(rgb[3 * i] + rgb[3 * i + 1] + rgb[3 * i + 2]);
+            gray[i] = (unsigned char)((sum * 683u) >> 11);
+        }
+    }
+    else if (standard == LUMA_BT601) {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(299 * rgb[3 * i] + 587 * rgb[3 * i + 1] + 114 * rgb[3 * i + 2]);
+            gray[i] = (unsigned char)(((sum >> 3) * 33555u) >> 22);
+        }
+    }
+    else {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(2126 * rgb[3 * i] + 7152 * rgb[3 * i + 1] + 722 * rgb[3 * i + 2]);
+            gray[i] = (unsigned char)(sum / 10000u);
+        }
+    }
+}
+
+/**
+ * 16 λ0~65535תҶȣΪ intȨͲ 32 λ޷ų
+ * ѳɳ˷ȡλͬ
+ */
+static inline void colorToGrayWide(const int* rgb, int* gray, size_t count, LumaStandard standard) {
+    if (standard == LUMA_AVERAGE) {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = (unsigned int)(rgb[3 * i] + rgb[3 * i + 1] + rgb[3 * i + 2]);
+            gray[i] = (int)(sum / 3u);
+        }
+    }
+    else if (standard == LUMA_BT601) {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = 299u * (unsigned int)rgb[3 * i] + 587u * (unsigned int)rgb[3 * i + 1] + 114u * (unsigned int)rgb[3 * i + 2];
+            gray[i] = (int)(sum / 1000u);
+        }
+    }
+    else {
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            unsigned int sum = 2126u * (unsigned int)rgb[3 * i] + 7152u * (unsigned int)rgb[3 * i + 1] + 722u * (unsigned int)rgb[3 * i + 2];
+            gray[i] = (int)(sum / 10000u);
+        }
+    }
+}
+
+//========== YCbCrBT.601 ȫΧ JPEG ͬ8 λ ==========
+
+static inline int colorClamp255(int v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+/**
+ * RGB -> YCbCrϵΪ Q16 㲢룬 0~255 ڣ0.5 ȡ 32767  32768ͬ libjpeg
+ * / Cb/Cr 뵽 256
+ * @param ycc Y Cb Cr У rgb ͬԭת
+ */
+static inline void rgbToYCbCr(const int* rgb, int* ycc, size_t count) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++) {
+        int r = rgb[3 * i];
+        int g = rgb[3 * i + 1];
+        int b = rgb[3 * i + 2];
+        ycc[3 * i] = (19595 * r + 38470 * g + 7471 * b + 32768) >> 16;
+        ycc[3 * i + 1] = (-11059 * r - 21709 * g + 32767 * b + (128 << 16) + 32768) >> 16;
+        ycc[3 * i + 2] = (32767 * r - 27439 * g - 5329 * b + (128 << 16) + 32768) >> 16;
+    }
+}
+
+/**
+ * YCbCr -> RGBQ16 㣻ȼ 256 ƫƱ֤ƵĶǷǸص 0~255
+ * @param rgb ycc ͬԭת
+ */
+static inline void yCbCrToRgb(const int* ycc, int* rgb, size_t count) {
+    const int bias = (256 << 16) + 32768;
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++) {
+        int y = ycc[3 * i] << 16;
+        int cb = ycc[3 * i + 1] - 128;
+        int cr = ycc[3 * i + 2] - 128;
+        rgb[3 * i] = colorClamp255(((y + 91881 * cr + bias) >> 16) - 256);
+        rgb[3 * i + 1] = colorClamp255(((y - 22554 * cb - 46802 * cr + bias) >> 16) - 256);
+        rgb[3 * i + 2] = colorClamp255(((y + 116130 * cb + bias) >> 16) - 256);
+    }
+}
+
+//========== HSVH Ϊ 0~359 ȣSV Ϊ 0~2558 λ ==========
+
+/**
+ * RGB -> HSV㲢
+ * @param hsv H S V У rgb ͬԭת
+ */
+static inline void rgbToHsv(const int* rgb, int* hsv, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int r = rgb[3 * i];
+        int g = rgb[3 * i + 1];
+        int b = rgb[3 * i + 2];
+        int max = r > g ? (r > b ? r : b) : (g > b ? g : b);
+        int min = r < g ? (r < b ? r : b) : (g < b ? g : b);
+        int delta = max - min;
+        int h = 0;
+        if (delta > 0) {
+            // ƫ 60*diff/delta 룻diff С -deltaȼ 60*delta ʹǸ
+            int sector, diff;
+            if (max == r) {
+                sector = 0;
+                diff = g - b;
+            }
+            else if (max == g) {
+                sector = 120;
+                diff = b - r;
+            }
+            else {
+                sector = 240;
+                diff = r - g;
+            }
+            h = sector + (60 * diff + 60 * delta + delta / 2) / delta - 60;
+            if (h < 0) {
+                h += 360;
+            }
+            if (h >= 360) {
+                h -= 360;
+            }
+        }
+        hsv[3 * i] = h;
+        hsv[3 * i + 1] = max == 0 ? 0 : (255 * delta + max / 2) / max;
+        hsv[3 * i + 2] = max;
+    }
+}
+
+/**
+ * HSV -> RGB㲢
+ * @param rgb hsv ͬԭת
+ */
+static inline void hsvToRgb(const int* hsv, int* rgb, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int h = hsv[3 * i];
+        int s = hsv[3 * i + 1];
+        int v = hsv[3 * i + 2];
+        int region = h / 60;
+        int f = h % 60;  // ڵλã0~59
+        int p = (v * (255 - s) + 127) / 255;
+        int q = (v * (255 * 60 - s * f) + 255 * 30) / (255 * 60);
+        int t = (v * (255 * 60 - s * (60 - f)) + 255 * 30) / (255 * 60);
+        int r, g, b;
+        switch (region) {
+        case 0:  r = v; g = t; b = p; break;
+        case 1:  r = q; g = v; b = p; break;
+        case 2:  r = p; g = v; b = t; break;
+        case 3:  r = p; g = q; b = v; break;
+        case 4:  r = t; g = p; b = v; break;
+        default: r = v; g = p; b = q; break;
+        }
+        rgb[3 * i] = r;
+        rgb[3 * i + 1] = g;
+        rgb[3 * i + 2] = b;
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,324 @@
+/**
+ * ͨǣг̣run鼯ݹ
+ *
+ * 1. ÿеǰг [x0, x1)ȸвٲһ
+ * 2. ͼгдкϲдÿһег˫ָɨһ飬ص8 ͨʱбҲ㣩ͺϲ
+ *    鼯ܰѸҵ±СһߣдֻԼг̣
+ * 3. дֻʣһҪ˳ϲ
+ * 4. ±˳ɨһг̼ɰÿѹƽţ±Ǹͨڹդ˳еĵһг̣
+ *    Ա 1..count ͨһγֵ˳Уд޹
+ * 5. ͳƱӾΡģгۼӣÿг O(1)
+ * ÷
+ *   Components cc;
+ *   ccLabelPlane(&cc, plane, width, height, 1, 8);   // plane  0 Ϊǰ
+ *   ccLabelImage(&cc, labels);                        // ѡչ width*height ıͼΪ 0
+ *   ... cc.stats[label - 1] ...
+ *   ccFree(&cc);
+ */
+#ifndef CONNECTED_COMPONENTS_H
+#define CONNECTED_COMPONENTS_H
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+typedef struct {
+    int x0;     // 
+    int x1;     // յ㣨
+    int label;  // ϲʱΪ鼯ڵ±꣬ɺΪͨţ1 ʼ
+} CCRun;
+
+typedef struct {
+    long long area;          // 
+    int x0, y0, x1, y1;      // ӾΣˣ
+    long long sum_x, sum_y;  // ͣ = sum / area
+} CCStats;
+
+typedef struct {
+    int width;
+    int height;
+    int count;       // ͨ
+    int run_count;   // г̸
+    int* row_start;  //  y егΪ runs[row_start[y]] ~ runs[row_start[y+1]-1]
+    CCRun* runs;
+    CCStats* stats;  // count stats[label-1]
+} Components;
+
+static inline void ccFree(Components* cc) {
+    free(cc->row_start);
+    free(cc->runs);
+    free(cc->stats);
+    memset(cc, 0, sizeof(Components));
+}
+
+/**
+ * һвг̣runs Ϊ NULL ʱֻ
+ * @return г̸
+ */
+static inline int ccRowRunsPlane(const int* row, int width, int channels, CCRun* runs) {
+    int n = 0;
+    int x = 0;
+    while (x < width) {
+        while (x < width && row[(size_t)x * channels] == 0) {
+            x++;
+        }
+        if (x == width) {
+            break;
+        }
+        int x0 = x;
+        while (x < width && row[(size_t)x * channels] != 0) {
+            x++;
+        }
+        if (runs != NULL) {
+            runs[n].x0 = x0;
+            runs[n].x1 = x;
+        }
+        n++;
+    }
+    return n;
+}
+
+static inline int ccBit(const unsigned char* row, int x) {
+    return (row[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+/**
+ * λһвгֽ̣ȫ 0 / ȫ 1 ʱһ 8 
+ * @return г̸
+ */
+static inline int ccRowRunsBits(const unsigned char* row, int width, CCRun* runs) {
+    int n = 0;
+    int x = 0;
+    while (x < width) {
+        while (x < width && !ccBit(row, x)) {
+            x = ((x & 7) == 0 && row[x >> 3] == 0) ? x + 8 : x + 1;
+        }
+        if (x >= width) {
+            break;
+        }
+        int x0 = x;
+        while (x < width && ccBit(row, x)) {
+            x = ((x & 7) == 0 && row[x >> 3] == 0xFF) ? x + 8 : x + 1;
+        }
+        x = x < width ? x : width;
+        if (runs != NULL) {
+            runs[n].x0 = x0;
+            runs[n].x1 = x;
+        }
+        n++;
+    }
+    return n;
+}
+
+static inline int ccFind(CCRun* runs, int i) {
+    while (runs[i].label != i) {
+        runs[i].label = runs[runs[i].label].label;  // ·
+        i = runs[i].label;
+    }
+    return i;
+}
+
+static inline void ccUnite(CCRun* runs, int a, int b) {
+    a = ccFind(runs, a);
+    b = ccFind(runs, b);
+    if (a < b) {
+        runs[b].label = a;
+    }
+    else if (b < a) {
+        runs[a].label = b;
+    }
+}
+
+/**
+ *  y  y-1 ег̰صϲ
+ * @param touch4 ͨΪ 08 ͨΪ 1бҲص
+ */
+static inline void ccMergeRows(Components* cc, int y, int touch) {
+    int i = cc->row_start[y];
+    int i_end = cc->row_start[y + 1];
+    int j = cc->row_start[y - 1];
+    int j_end = cc->row_start[y];
+    while (i < i_end && j < j_end) {
+        const CCRun* a = &cc->runs[i];
+        const CCRun* b = &cc->runs[j];
+        if (a->x0 < b->x1 + touch && b->x0 < a->x1 + touch) {
+            ccUnite(cc->runs, i, j);
+        }
+        if (a->x1 < b->x1) {
+            i++;
+        }
+        else {
+            j++;
+        }
+    }
+}
+
+/**
+ * гú󣺺ϲѹƽšͳ
+ * @return 0=ɹ-1=ڴ治
+ */
+static inline int ccResolve(Components* cc, int connectivity) {
+    int touch = connectivity == 8 ? 1 : 0;
+    int height = cc->height;
+    for (int i = 0; i < cc->run_count; i++) {
+        cc->runs[i].label = i;
+    }
+
+    // 1. дڲкϲд˳ϲ
+    int bands = 1;
+#ifdef _OPENMP
+    bands = omp_get_max_threads();
+#endif
+    bands = bands < height ? bands : height;
+    #pragma omp parallel for schedule(static)
+    for (int b = 0; b < bands; b++) {
+        int y0 = (int)((long long)height * b / bands);
+        int y1 = (int)((long long)height * (b + 1) / bands);
+        for (int y = y0 + 1; y < y1; y++) {
+            ccMergeRows(cc, y, touch);
+        }
+    }
+    for (int b = 1; b < bands; b++) {
+        ccMergeRows(cc, (int)((long long)height * b / bands), touch);
+    }
+
+    // 2. ѹƽڵ±ܱԼС˳ɨʱڵѾ˸ı
+    int count = 0;
+    for (int i = 0; i < cc->run_count; i++) {
+        CCRun* r = &cc->runs[i];
+        r->label = r->label == i ? -(++count) : cc->runs[r->label].label;  // ݴΪıţ±
+    }
+    for (int i = 0; i < cc->run_count; i++) {
+        cc->runs[i].label = -cc->runs[i].label;
+    }
+
+    // 3. ͳ
+    cc->count = count;
+    cc->stats = (CCStats*)malloc(sizeof(CCStats) * (count > 0 ? count : 1));
+    if (cc->stats == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        CCStats* s = &cc->stats[i];
+        memset(s, 0, sizeof(CCStats));
+        s->x0 = cc->width;
+        s->y0 = height;
+        s->x1 = -1;
+        s->y1 = -1;
+    }
+    for (int y = 0; y < height; y++) {
+        for (int i = cc->row_start[y]; i < cc->row_start[y + 1]; i++) {
+            const CCRun* r = &cc->runs[i];
+            CCStats* s = &cc->stats[r->label - 1];
+            long long len = r->x1 - r->x0;
+            s->area += len;
+            s->sum_x += (long long)(r->x0 + r->x1 - 1) * len / 2;
+            s->sum_y += (long long)y * len;
+            s->x0 = r->x0 < s->x0 ? r->x0 : s->x0;
+            s->x1 = r->x1 - 1 > s->x1 ? r->x1 - 1 : s->x1;
+            s->y0 = y < s->y0 ? y : s->y0;
+            s->y1 = y;
+        }
+    }
+    return 0;
+}
+
+/**
+ * г̣planebits ѡһ
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int ccLabel(Components* cc, const int* plane, int channels, const unsigned char* bits, int stride, int width, int height, int connectivity) {
+    memset(cc, 0, sizeof(Components));
+    if (width <= 0 || height <= 0 || (connectivity != 4 && connectivity != 8)) {
+        return -1;
+    }
+    cc->width = width;
+    cc->height = height;
+    cc->row_start = (int*)malloc(sizeof(int) * (height + 1));
+    if (cc->row_start == NULL) {
+        return -1;
+    }
+
+    // 1. вг̣ǰ׺͵õ
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        cc->row_start[y + 1] = plane != NULL
+            ? ccRowRunsPlane(plane + (size_t)y * width * channels, width, channels, NULL)
+            : ccRowRunsBits(bits + (size_t)y * stride, width, NULL);
+    }
+    cc->row_start[0] = 0;
+    for (int y = 0; y < height; y++) {
+        cc->row_start[y + 1] += cc->row_start[y];
+    }
+    cc->run_count = cc->row_start[height];
+
+    // 2. в
+    cc->runs = (CCRun*)malloc(sizeof(CCRun) * (cc->run_count > 0 ? cc->run_count : 1));
+    if (cc->runs == NULL) {
+        ccFree(cc);
+        return -1;
+    }
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        CCRun* runs = cc->runs + cc->row_start[y];
+        if (plane != NULL) {
+            ccRowRunsPlane(plane + (size_t)y * width * channels, width, channels, runs);
+        }
+        else {
+            ccRowRunsBits(bits + (size_t)y * stride, width, runs);
+        }
+    }
+
+    if (ccResolve(cc, connectivity) != 0) {
+        ccFree(cc);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * ƽϵͨ
+ * @param planewidth*height أÿ channels ֻһ 0 Ϊǰ
+ * @param connectivity4  8
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int ccLabelPlane(Components* cc, const int* plane, int width, int height, int channels, int connectivity) {
+    if (plane == NULL || channels < 1) {
+        memset(cc, 0, sizeof(Components));
+        return -1;
+    }
+    return ccLabel(cc, plane, channels, NULL, 0, width, height, connectivity);
+}
+
+/**
+ * ǰλֵͼPBM P4 λͼ1 Ϊǰϵͨ
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int ccLabelBits(Components* cc, const unsigned char* bits, int stride, int width, int height, int connectivity) {
+    if (bits == NULL || stride < (width + 7) / 8) {
+        memset(cc, 0, sizeof(Components));
+        return -1;
+    }
+    return ccLabel(cc, NULL, 1, bits, stride, width, height, connectivity);
+}
+
+/**
+ * չɱͼwidth*heightΪ 0ͨΪ 1..countв
+ */
+static inline void ccLabelImage(const Components* cc, int* labels) {
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < cc->height; y++) {
+        int* row = labels + (size_t)y * cc->width;
+        memset(row, 0, sizeof(int) * cc->width);
+        for (int i = cc->row_start[y]; i < cc->row_start[y + 1]; i++) {
+            const CCRun* r = &cc->runs[i];
+            for (int x = r->x0; x < r->x1; x++) {
+                row[x] = r->label;
+            }
+        }
+    }
+}
+
+#endif
\ No newline at end of file
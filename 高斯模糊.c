@@ -3,6 +3,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include "ͳ.h"
+#include ".h"
+#include "˹ģ.h"
 
 //TYPE BEGIN
 typedef struct {
@@ -22,6 +25,7 @@ typedef struct {
 //VAR BEGIN
 const char* READ_PATH = "C:\\code\\001 ͼѧϰ\\man.ppm";
 const char* WRITE_PATH = "C:\\code\\001 ͼѧϰ\\man-blur-eye.ppm";
+const int BLUR_RADIUS = 3;  // ģ뾶 (2R+1)x(2R+1)
 int ERR_STATE = 0;
 
 enum {
@@ -34,6 +38,7 @@ enum {
 
 PPM inPPM;
 PPM outPPM;
+PPM padPPM;  // ģ뾶 inPPM ͼΪɫϽ inPPM Ϊ (x1-radius, y1-radius)
 //VAR END
 
 //FCUNTION BEGIN
@@ -66,6 +71,7 @@ void read() {
 	inPPM.height = height;
 	inPPM.colorset = colorset;
 	inPPM.data = malloc(sizeof(Pixel) * width * height);
+	STATS_ALLOC(sizeof(Pixel) * width * height);
 	int r, g, b;
 	for (int y = 0; y < height; y++) {
 		for (int x = 0; x < width; x++) {
@@ -80,6 +86,7 @@ void read() {
 			}
 		}
 	}
+	STATS_BYTES_READ(ftell(stdin));
 	fclose(stdin);
 }
 
@@ -107,54 +114,36 @@ void write() {
 		return;
 	}
 	fflush(file);
+	STATS_BYTES_WRITTEN(ftell(file));
 	fclose(file);
 	/*
 	After this function is called once, the program still has other tasks to complete and will not terminate,
 	so remember to free the memory
 	(it's just a good habit??this small memory leak won't matter much on modern PCs).
 	*/
+	STATS_FREE(sizeof(Pixel) * outPPM.width * outPPM.height);
 	free(outPPM.data);
 }
 
 
-Pixel BLACK = { 0, 0, 0 };
-
-Pixel* getPixel(PPM* source, int x, int y) {
-	if (x < 0 || y < 0 || x >= source->width || y >= source->height) {
-		return &BLACK;
-	}
-	return source->data + x + y * source->width;
-}
-double weight(double a, int x, int y, double* sum_weight) {
-	double pi = 3.14;
-	*sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
-	return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
-}
-
-Pixel blur(PPM* source, int x, int y, int radius) {
-	Pixel p;
-	p.r = 0;
-	p.g = 0;
-	p.b = 0;
-	Pixel* temp;
-	double sum_weight = 0.0;
-	for (int i = x - radius; i <= x + radius; i++) {
-		for (int j = y - radius; j <= y + radius; j++) {
-			double WEIGHT = weight(5.0, i - x, j - y, &sum_weight);
-			//printf("%lf\n ", WEIGHT);
-			temp = getPixel(source, i, j);
-			p.r += WEIGHT*temp->r;
-			p.g += WEIGHT*temp->g;
-			p.b += WEIGHT*temp->b;
-		}
+/*
+ inPPM Ĵ [x1-radius, x2+radius] x [y1-radius, y2+radius]  padPPM
+ڳͼĲɫģʱȡÿ㶼жԽ磨 ˹ģ.h
+*/
+void pad(int x1, int y1, int x2, int y2, int radius) {
+	if (checkError()) {
+		return;
 	}
-	p.r /= sum_weight;
-	p.g /= sum_weight;
-	p.b /= sum_weight;
-	return p;
+	padPPM.width = x2 - x1 + 1 + 2 * radius;
+	padPPM.height = y2 - y1 + 1 + 2 * radius;
+	padPPM.colorset = inPPM.colorset;
+	padPPM.data = malloc(sizeof(Pixel) * padPPM.width * padPPM.height);
+	STATS_ALLOC(sizeof(Pixel) * padPPM.width * padPPM.height);
+	blurPadWindow((const int*)inPPM.data, inPPM.width, inPPM.height, x1 - radius, y1 - radius,
+		padPPM.width, padPPM.height, (int*)padPPM.data);
 }
 
-void handle(int x1, int y1, int x2, int y2) {
+void handle(int x1, int y1, int x2, int y2, int radius) {
 	if (checkError()) {
 		return;
 	}
@@ -164,22 +153,45 @@ void handle(int x1, int y1, int x2, int y2) {
 	outPPM.height = height;
 	outPPM.colorset = inPPM.colorset;
 	outPPM.data = malloc(sizeof(Pixel) * width * height);
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			if (x1 <= x && x <= x2 && y1 <= y && y <= y2) {
-				outPPM.data[x + y * width] = blur(&inPPM, x, y, 3);
-			}
-			else {
-				outPPM.data[x + y * width] = inPPM.data[x + y * width];
-			}
-		}
-	}
+	STATS_ALLOC(sizeof(Pixel) * width * height);
+	STATS_BEGIN(kernel_span, "blur");
+	// ڰߴģԭ
+	blurPadded((const int*)inPPM.data, width, height, (const int*)padPPM.data, x1, y1, x2, y2, radius, (int*)outPPM.data);
+	STATS_END(kernel_span, width * height);
+	STATS_FREE(sizeof(Pixel) * padPPM.width * padPPM.height);
+	free(padPPM.data);
 }
 //FUNCTION END
 
-int main() {
+int main(int argc, char* argv[]) {
+	STATS_INIT(argc, argv);
+	RESULT_CACHE_INIT(argc, argv);
+	// ݡ뾶ģûʱֱȡĽ --cache DIR 
+	ResultKey cache_key;
+	resultKeyInit(&cache_key, "blur");
+	resultKeyAddFile(&cache_key, READ_PATH);
+	resultKeyAddInt(&cache_key, "radius", BLUR_RADIUS);
+	resultKeyAddInt(&cache_key, "x1", 214);
+	resultKeyAddInt(&cache_key, "y1", 339);
+	resultKeyAddInt(&cache_key, "x2", 690);
+	resultKeyAddInt(&cache_key, "y2", 417);
+	if (resultCacheFetch(&cache_key, WRITE_PATH)) {
+		STATS_FINISH();
+		return 0;
+	}
+	STATS_BEGIN(read_span, "read");
 	read();
-	handle(214, 339, 690, 417);
+	STATS_END(read_span, inPPM.width * inPPM.height);
+	STATS_BEGIN(handle_span, "handle");
+	pad(214, 339, 690, 417, BLUR_RADIUS);
+	handle(214, 339, 690, 417, BLUR_RADIUS);
+	STATS_END(handle_span, outPPM.width * outPPM.height);
+	STATS_BEGIN(write_span, "write");
 	write();
+	STATS_END(write_span, outPPM.width * outPPM.height);
+	if (!checkError()) {
+		resultCacheStore(&cache_key, WRITE_PATH);
+	}
+	STATS_FINISH();
 	return ERR_STATE;
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+/**
+ * ˹ģ˹ģ.c ģΪ RGB е int Pixel 鰴 int 鴫뼴ɣ
+ *
+ * Ȱģܸ radius Ĵڿ߻壨ͼΪɫȡʱжԽ磻
+ * ÿ (2r+1)x(2r+1) ϰ weight ȨȨ㣨=5 ȡ 3.14
+ * ˼ӽÿνضΪ intȨغٽضϣԭ blur() ļ˳ȫͬ
+ * ԭợ߳-fopenmpʱвУÿصļ߳޹ء
+ * ÷
+ *   blurRegion((const int*)in.data, width, height, x1, y1, x2, y2, radius, (int*)out.data);
+ */
+#ifndef GAUSSIAN_BLUR_H
+#define GAUSSIAN_BLUR_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define BLUR_SIGMA 5.0
+
+/**
+ * ƫ (x, y) Ȩأͬʱۼӵ sum_weight
+ */
+static inline double blurWeight(double a, int x, int y, double* sum_weight) {
+    double pi = 3.14;
+    *sum_weight += 1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+    return  1 / (2 * pi * a * a) * exp(-(x * x + y * y) / (2 * a * a));
+}
+
+/**
+ * ͼϽΪ (x0, y0)win_w x win_h Ĵڿ windowڳͼĲ 0ɫ
+ * @param windowwin_w*win_h أÿ 3 
+ */
+static inline void blurPadWindow(const int* rgb, int width, int height, int x0, int y0, int win_w, int win_h, int* window) {
+    // ÿе [left, right) ͼ
+    int left = x0 < 0 ? -x0 : 0;
+    int right = width - x0 < win_w ? width - x0 : win_w;
+    for (int y = 0; y < win_h; y++) {
+        int* row = window + (size_t)y * win_w * 3;
+        int sy = y0 + y;
+        if (sy < 0 || sy >= height || left >= right) {
+            memset(row, 0, sizeof(int) * win_w * 3);
+            continue;
+        }
+        memset(row, 0, sizeof(int) * left * 3);
+        memcpy(row + left * 3, rgb + ((size_t)sy * width + x0 + left) * 3, sizeof(int) * (right - left) * 3);
+        if (right < win_w) {
+            memset(row + right * 3, 0, sizeof(int) * (win_w - right) * 3);
+        }
+    }
+}
+
+/**
+ *  (cx, cy) ģ踲 [cx-radius, cx+radius] x [cy-radius, cy+radius]
+ * @param out3 
+ */
+static inline void blurWindowPixel(const int* window, int win_w, int cx, int cy, int radius, int* out) {
+    int r = 0, g = 0, b = 0;
+    double sum_weight = 0.0;
+    for (int i = cx - radius; i <= cx + radius; i++) {
+        for (int j = cy - radius; j <= cy + radius; j++) {
+            double w = blurWeight(BLUR_SIGMA, i - cx, j - cy, &sum_weight);
+            const int* s = window + ((size_t)j * win_w + i) * 3;
+            r += w * s[0];
+            g += w * s[1];
+            b += w * s[2];
+        }
+    }
+    out[0] = r / sum_weight;
+    out[1] = g / sum_weight;
+    out[2] = b / sum_weight;
+}
+
+/**
+ * ģ [x1, x2] x [y1, y2]ɲֻȫͼ񣩣⸴ rgb
+ * @param windowblurPadWindow õĴڣϽͼΪ (x1-radius, y1-radius)
+ * @param outwidth*height أ rgb ͬ
+ */
+static inline void blurPadded(const int* rgb, int width, int height, const int* window, int x1, int y1, int x2, int y2, int radius, int* out) {
+    int win_w = x2 - x1 + 1 + 2 * radius;
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            size_t i = ((size_t)y * width + x) * 3;
+            if (x1 <= x && x <= x2 && y1 <= y && y <= y2) {
+                blurWindowPixel(window, win_w, x - x1 + radius, y - y1 + radius, radius, out + i);
+            }
+            else {
+                out[i] = rgb[i];
+                out[i + 1] = rgb[i + 1];
+                out[i + 2] = rgb[i + 2];
+            }
+        }
+    }
+}
+
+/**
+ * ߲ģ [x1, x2] x [y1, y2]⸴ rgb
+ * @param outwidth*height أ rgb ͬ
+ * @return 0=ɹ-1=Ϸڴ治
+ */
+static inline int blurRegion(const int* rgb, int width, int height, int x1, int y1, int x2, int y2, int radius, int* out) {
+    if (radius < 0 || x2 < x1 || y2 < y1) {
+        return -1;
+    }
+    int win_w = x2 - x1 + 1 + 2 * radius;
+    int win_h = y2 - y1 + 1 + 2 * radius;
+    int* window = (int*)malloc(sizeof(int) * win_w * win_h * 3);
+    if (window == NULL) {
+        return -1;
+    }
+    blurPadWindow(rgb, width, height, x1 - radius, y1 - radius, win_w, win_h, window);
+    blurPadded(rgb, width, height, window, x1, y1, x2, y2, radius, out);
+    free(window);
+    return 0;
+}
+
+#endif
\ No newline at end of file